@@ -0,0 +1,15 @@
+#pragma once
+#include <Arduino.h>
+
+/// === hours of the day in the activity histogram ===
+const int ACTIVITY_HOURS = 24;
+
+void rebaseActivity(time_t from, time_t to);
+
+void recordActivity();
+
+float activityLevel();
+
+bool activityAlert(int multiple);
+
+void publishActivity();
\ No newline at end of file
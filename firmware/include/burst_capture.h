@@ -0,0 +1,18 @@
+#pragma once
+#include <Arduino.h>
+#include "frame_pool.h"
+
+/// === largest burst, bounded by the frame pool ===
+const int BURST_MAX_FRAMES = 6;
+
+/// === frames of one burst & their sharpness scores ===
+struct Burst {
+    PooledFrame* frames[BURST_MAX_FRAMES];
+    uint32_t     scores[BURST_MAX_FRAMES];
+    int          count;
+    int          best;
+};
+
+bool captureBurst(Burst& burst, int frames, unsigned long intervalMs);
+
+void releaseBurst(Burst& burst, const String& archivePrefix);
\ No newline at end of file
@@ -1,4 +1,27 @@
 #pragma once
 #include <Arduino.h>
 
-void initCamera();
\ No newline at end of file
+/// === camera frame buffers, frames are copied into the frame pool so two keep capture running ===
+const int CAMERA_FB_COUNT = 2;
+
+/// === named sensor settings, switched at runtime without re-initialising the driver ===
+enum CameraProfile : uint8_t {
+    /// --- cameraFrameSize & cameraJpegQuality: small frames at a high frame rate, also streamed ---
+    CAMERA_PROFILE_SURVEILLANCE = 0,
+    /// --- ringFrameSize & ringJpegQuality: large, high quality frames of the visitor ---
+    CAMERA_PROFILE_RING         = 1,
+};
+
+void initCamera();
+
+bool applyCameraSettings();
+
+bool setCameraProfile(CameraProfile profile);
+
+CameraProfile cameraProfile();
+
+int cameraProfileFrameSize(CameraProfile profile);
+
+int cameraProfileQuality(CameraProfile profile);
+
+int cameraBufferFrameSize();
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 #include <Arduino.h>
 #include "time_util.h"
+#include "frame_pool.h"
 
-void captureAndSaveImage(String filename);
\ No newline at end of file
+bool saveFrame(const PooledFrame* frame, const String& filename, const char* snapshotKind = nullptr);
+
+bool captureAndSaveImage(String filename, const char* snapshotKind = nullptr, int* personScore = nullptr, int* motionScore = nullptr);
\ No newline at end of file
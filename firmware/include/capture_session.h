@@ -0,0 +1,27 @@
+#pragma once
+#include <Arduino.h>
+
+// === capture layout on the SD card ===
+/// --- one directory of captures per wake or surveillance burst ---
+const char* const SESSIONS_ROOT = "/sessions";
+
+/// --- retired sessions & wiped roots, deleted lazily by reclaimTrash() ---
+const char* const TRASH_ROOT = "/trash";
+
+void initSessions();
+
+void beginSession();
+
+String capturePath(const String& filename);
+
+void retireSession(const String& sessionDir);
+
+void wipeSessions();
+
+bool reclaimTrash(unsigned long budgetMs);
+
+uint32_t pendingCaptures();
+
+void captureSaved(const String& filename);
+
+void capturesUploaded(uint32_t count);
\ No newline at end of file
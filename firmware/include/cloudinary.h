@@ -1,5 +1,8 @@
 #pragma once
 #include <Arduino.h>
 #include <SD_MMC.h>
+#include <WiFiClientSecure.h>
+
+int postImageToCloudinary(WiFiClientSecure& client, File& file, const String& filename, uint8_t* buf, size_t bufLen);
 
 bool uploadImageToCloudinary(File &file, String filename);
\ No newline at end of file
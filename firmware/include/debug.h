@@ -1,17 +1,21 @@
 #pragma once
 
 // === debug macros ===
-/// --- 1 or 0 to turn serial debugging ON or OFF respectively ---
-#define SERIAL_DEBUG 0
+/// --- 1 or 0 to turn serial debugging ON or OFF respectively, a build profile may set -DSERIAL_DEBUG ---
+#ifndef SERIAL_DEBUG
+  #define SERIAL_DEBUG 0
+#endif
 
 #if SERIAL_DEBUG
   #define DBG_SERIAL_BEGIN(x)   Serial.begin(x)
   #define DBG_PRINT(x)          Serial.print(x)
   #define DBG_PRINTLN(x)        Serial.println(x)
+  #define DBG_PRINTF(...)       Serial.printf(__VA_ARGS__)
   #define DBG_DELAY(X)          delay(X)
 #else
   #define DBG_SERIAL_BEGIN(x)
   #define DBG_PRINT(x)
   #define DBG_PRINTLN(x)
+  #define DBG_PRINTF(...)
   #define DBG_DELAY(X)
 #endif
\ No newline at end of file
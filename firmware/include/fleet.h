@@ -0,0 +1,29 @@
+#pragma once
+#include <Arduino.h>
+
+// === fleet coordination over MQTT ===
+/// --- topics shared by every unit on the broker, routed to handleFleetMessage() ---
+const char* const FLEET_TOPIC_PREFIX = "doorbell/fleet/";
+
+/// --- retained claim of the latest suspicious-activity alert ---
+const char* const FLEET_ALERT_TOPIC = "doorbell/fleet/alert";
+
+/// --- upload slots tracked per window, slots past this are never leased ---
+const int FLEET_MAX_SLOTS = 24;
+
+/// --- peers whose backlog counts toward a lease ---
+const int FLEET_MAX_PEERS = 8;
+
+const char* fleetUnitId();
+
+void fleetSubscribed();
+
+void handleFleetMessage(const char* subtopic, const String& value);
+
+void announceFleetState();
+
+bool fleetMayUpload();
+
+bool scheduleFleetUploadWake();
+
+bool fleetShouldAlert(uint8_t level);
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include <Arduino.h>
+
+// === frame pool configuration ===
+/// --- size classes: the expected JPEG of the smaller & of the larger camera profile, & the largest JPEG the driver can produce ---
+const int FRAME_POOL_BUCKETS = 3;
+
+/// --- slots per size class, allocated once in PSRAM ---
+const int FRAME_POOL_SLOTS[FRAME_POOL_BUCKETS] = { 2, 4, 2 };
+
+/// === JPEG frame held in a pool slot, shared by reference count ===
+struct PooledFrame {
+    uint8_t*      buf;
+    size_t        len;
+    size_t        capacity;
+    uint16_t      width;
+    uint16_t      height;
+    uint32_t      seq;
+    unsigned long capturedAt;
+
+    /// --- owned by the pool ---
+    int           refs;
+    int8_t        bucket;
+    int16_t       nextFree;
+    void*         borrowedFb;
+};
+
+/// === usage of one size class ===
+struct FramePoolStats {
+    size_t   capacity;
+    uint8_t  slots;
+    uint8_t  inUse;
+    uint8_t  highWater;
+    /// --- requests sized for this class ---
+    uint32_t acquired;
+    /// --- requests of a smaller, full class served from this one ---
+    uint32_t spilled;
+    /// --- requests of this class that found no free slot ---
+    uint32_t exhausted;
+};
+
+bool initFramePool();
+
+PooledFrame* acquireFrame(size_t len);
+
+PooledFrame* captureFrame();
+
+void retainFrame(PooledFrame* frame);
+
+void releaseFrame(PooledFrame* frame);
+
+bool getFramePoolStats(int bucket, FramePoolStats& stats);
+
+void publishFramePoolStats();
\ No newline at end of file
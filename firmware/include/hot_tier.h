@@ -0,0 +1,16 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+
+/// === LittleFS mount point of the spiffs partition ===
+const char* const HOT_TIER_MOUNT = "/littlefs";
+
+void initHotTier();
+
+bool hotTierMounted();
+
+fs::FS& hotFS();
+
+fs::FS& storageFor(const String& filename);
+
+void benchmarkStorageTiers(const uint8_t* buf, size_t len, int rounds);
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+#include <Arduino.h>
+
+void initIdle();
+
+bool idleUntilEvent(unsigned long maxMs);
+
+int64_t idleSleptUs();
+
+void publishIdleStats();
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+#include <Arduino.h>
+#include <SD_MMC.h>
+#include <WiFi.h>
+
+/// === binary upload protocol of the LAN ingest gateway (tools/ingest_gateway), little endian ===
+///
+/// every frame is  u32 length | u8 type | body[length - 1]
+///   HELLO    device -> gateway  "GBIG" | u8 version | char unit[6] | u8 token length | token
+///   WELCOME  gateway -> device  u8 version | u16 window | u32 largest file
+///   FILE     device -> gateway  u32 seq | u16 name length | name | data | u32 crc32 of data
+///   ACK      gateway -> device  u32 seq | u8 status, in FILE order once the file is on disk
+///
+/// up to window FILE frames are sent before the first ACK is awaited,
+/// a HELLO without the gateway's shared token is closed without a WELCOME
+const uint8_t INGEST_VERSION = 2;
+
+enum IngestFrame : uint8_t {
+    INGEST_HELLO   = 0x01,
+    INGEST_FILE    = 0x02,
+    INGEST_WELCOME = 0x81,
+    INGEST_ACK     = 0x82,
+};
+
+enum IngestStatus : uint8_t {
+    INGEST_STORED       = 0,
+    INGEST_BAD_CRC      = 1,
+    INGEST_REJECTED     = 2,
+    INGEST_SPOOL_FAILED = 3,
+};
+
+/// === files in flight per connection, whatever window the gateway offers ===
+const uint16_t INGEST_MAX_WINDOW = 8;
+
+/// === longest file name sent, names are the SD file name like Cloudinary public ids ===
+const size_t INGEST_NAME_LEN = 64;
+
+/// === longest shared token ===
+const size_t INGEST_TOKEN_LEN = 32;
+
+bool ingestConfigured();
+
+bool ingestConnect(WiFiClient& client, uint16_t& window, uint32_t& maxBytes);
+
+bool ingestSendFile(WiFiClient& client, uint32_t seq, File& file, const char* name, uint8_t* buf, size_t bufLen);
+
+int ingestReadAck(WiFiClient& client, uint32_t& seq, uint8_t& status);
\ No newline at end of file
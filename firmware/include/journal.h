@@ -0,0 +1,67 @@
+#pragma once
+#include <Arduino.h>
+
+/// === journalled events, ids are part of the on-disk format ===
+///
+/// code, arg & value per event:
+///   boot    wake cause          -                     boot ms
+///   ring    burst frames        -                     -
+///   motion  person seen (0/1/2 = no model)  best score (0xFFFF none)  burst ms
+///   alert   multiple            sent by another unit (0/1)   activity level x100
+///   upload  images left (0/1)   files uploaded        bytes uploaded
+///   ota     result (0 up to date, 1 updated, 2 failed)   -   -
+///   error   fatal (0/1)         -                     FNV-1a hash of the message
+///   sleep   timer wake (0/1)    -                     awake ms
+enum JournalEvent : uint8_t {
+    JOURNAL_BOOT   = 0,
+    JOURNAL_RING   = 1,
+    JOURNAL_MOTION = 2,
+    JOURNAL_ALERT  = 3,
+    JOURNAL_UPLOAD = 4,
+    JOURNAL_OTA    = 5,
+    JOURNAL_ERROR  = 6,
+    JOURNAL_SLEEP  = 7,
+};
+
+/// === one fixed-size record, little endian, CRC-32 over the first 16 bytes ===
+struct __attribute__((packed)) JournalRecord {
+    uint32_t seq;
+    uint32_t time;
+    uint8_t  event;
+    uint8_t  code;
+    uint16_t arg;
+    uint32_t value;
+    uint32_t crc;
+};
+
+/// === records batched in RTC memory before one SD write ===
+const int JOURNAL_BUFFER_SIZE = 32;
+
+/// === records per journal file before it is rotated to JOURNAL_OLD_PATH ===
+const uint32_t JOURNAL_FILE_RECORDS = 50000;
+
+const char* const JOURNAL_PATH     = "/journal.bin";
+const char* const JOURNAL_OLD_PATH = "/journal.old";
+
+/// === sequence number the next export starts at, kept across power loss ===
+const char* const JOURNAL_EXPORTED_PATH = "/journal.exp";
+
+/// === "<from seq>[,<count>]" published here asks for a range to be exported again ===
+const char* const JOURNAL_GET_TOPIC = "doorbell/journal/get";
+
+/// === most records a range request may ask for ===
+const uint32_t JOURNAL_REQUEST_MAX = 2048;
+
+void initJournal();
+
+void journal(JournalEvent event, uint8_t code = 0, uint16_t arg = 0, uint32_t value = 0);
+
+uint32_t journalHash(const String& message);
+
+bool flushJournal();
+
+int exportJournal(int maxRecords);
+
+void requestJournalRange(uint32_t from, uint32_t count);
+
+void serviceJournal();
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+#include <Arduino.h>
+
+/// === luma thumbnail consecutive surveillance frames are compared on ===
+const int MOTION_THUMB_W = 32;
+const int MOTION_THUMB_H = 24;
+
+void resetFrameMotion();
+
+int frameMotionScore(const uint8_t* jpeg, size_t len);
\ No newline at end of file
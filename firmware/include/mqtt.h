@@ -3,8 +3,33 @@
 #include <HTTPClient.h>
 #include <PubSubClient.h>
 
+/// === PubSubClient packet buffer size, bounds the size of a snapshot chunk ===
+const int MQTT_BUFFER_SIZE = 4096;
+
+// === MQTT outbox configuration ===
+/// --- number of events held while the broker is unreachable ---
+const int MQTT_OUTBOX_SIZE = 16;
+
+/// --- maximum topic length of an outbox event (including terminator) ---
+const int MQTT_TOPIC_LEN = 32;
+
+/// --- maximum payload length of an outbox event (including terminator) ---
+const int MQTT_PAYLOAD_LEN = 96;
+
 extern WiFiClient wifiClient;
 
 extern PubSubClient mqtt;
 
-void ensureMQTT();
\ No newline at end of file
+extern SemaphoreHandle_t mqttLock;
+
+void initMQTT();
+
+bool publishMQTT(const char* topic, const String& payload, bool retained = false);
+
+bool flushMQTT(unsigned long timeoutMs);
+
+bool mqttConnected();
+
+int mqttOutboxDepth();
+
+unsigned long mqttPublishLatency();
\ No newline at end of file
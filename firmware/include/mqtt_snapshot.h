@@ -0,0 +1,7 @@
+#pragma once
+#include <Arduino.h>
+
+/// === size of the binary header prefixed to each snapshot chunk ===
+const int SNAPSHOT_CHUNK_HEADER_LEN = 8;
+
+bool publishSnapshotToMQTT(const uint8_t* jpeg, size_t len, const char* kind);
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+
+// === notification coalescing ===
+/// --- distinct messages held between digests ---
+const int NOTIFY_SLOTS = 8;
+
+/// --- maximum length of one message (including terminator) ---
+const int NOTIFY_TEXT_LEN = 96;
+
+void initNotify();
+
+void notify(const String& message);
+
+bool flushNotify(bool force);
+
+int notifyPending();
+
+bool notifySending();
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+#include <Arduino.h>
+
+// === person classifier architecture, fixed by the model file format ===
+/// --- luma thumbnail the classifier runs on, 4:3 like the camera frame sizes ---
+const int PERSON_INPUT_W = 32;
+const int PERSON_INPUT_H = 24;
+
+/// --- output channels of the 3x3 stride-2 convolutions, followed by global average pooling & one logit ---
+const int PERSON_LAYERS = 3;
+const int PERSON_CHANNELS[PERSON_LAYERS] = { 8, 16, 32 };
+
+/// --- model file on the hot tier or SD card root, written by tools/person_model.py ---
+const char* const PERSON_MODEL_PATH = "/person_model.bin";
+
+bool initPersonDetect();
+
+bool loadPersonModel(const uint8_t* blob, size_t len);
+
+bool personModelLoaded();
+
+int personScore(const uint8_t* thumbnail);
+
+int personScoreJpeg(const uint8_t* jpeg, size_t len);
\ No newline at end of file
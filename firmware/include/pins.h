@@ -11,6 +11,9 @@ const int FLASH_LED_PIN = 4;
 /// --- source pin to wake ESP32-CAM from deep-sleep ---
 const int WAKE_PIN = 4;
 
+/// --- MCP23017 INTA, wakes light sleep on button & PIR changes, -1 if not wired ---
+const int MCP_INT_PIN = -1;
+
 /// --- I2C SCL to MCP23X17 ---
 const int SCL_PIN = 12;
 /// --- I2C SDA to MCP23X17 ---         
@@ -0,0 +1,29 @@
+#pragma once
+#include <Arduino.h>
+
+/// === main phases of a wake, each with its own CPU frequency & WiFi power settings ===
+enum PowerPhase : uint8_t {
+    /// --- boot, standby & light sleep between events: 80 MHz, modem sleep ---
+    POWER_ARM          = 0,
+    /// --- capture, JPEG save & person classifier: 240 MHz, modem sleep ---
+    POWER_SURVEILLANCE = 1,
+    /// --- ring captures, albums, Telegram sends & the broker traffic before deep sleep: 240 MHz, radio always on ---
+    POWER_NOTIFY       = 2,
+    /// --- SD drains & the firmware update check: 240 MHz, radio always on at full TX power ---
+    POWER_UPLOAD       = 3,
+    /// --- housekeeping & reports queued before deep sleep: 80 MHz, modem sleep ---
+    POWER_SLEEP        = 4,
+    POWER_PHASE_COUNT  = 5,
+};
+
+void initPowerProfiles();
+
+PowerPhase enterPowerPhase(PowerPhase phase);
+
+PowerPhase powerPhase();
+
+void holdPowerPhase(PowerPhase phase);
+
+void releasePowerPhase(PowerPhase phase);
+
+void publishPowerStats();
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+
+/// === MQTT topic prefix of configuration commands, the rest of the topic is the key ===
+const char* const CONFIG_TOPIC_PREFIX = "doorbell/config/";
+
+/// === topic acknowledging every configuration command ===
+const char* const CONFIG_ACK_TOPIC = "doorbell/config_ack";
+
+void initRuntimeConfig();
+
+void handleConfigCommand(const char* key, const String& value);
+
+void applyRuntimeConfig();
\ No newline at end of file
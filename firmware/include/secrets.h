@@ -26,4 +26,12 @@ extern const char* CLOUDINARY_CLOUD_NAME;
 
 extern const char* CLOUDINARY_UPLOAD_PRESET;
 
+extern const char* INGEST_HOST;
+
+extern const int   INGEST_PORT;
+
+extern const char* INGEST_TOKEN;
+
+extern const char* STREAM_TOKEN;
+
 
@@ -1,38 +1,296 @@
 #pragma once
 #include <Arduino.h>
 
+// === feature profile, chosen per PlatformIO environment ===
+/// --- every feature is on unless a profile turns it off with -DFEATURE_<NAME>=0 ---
+#ifndef FEATURE_TELEGRAM
+  #define FEATURE_TELEGRAM    1
+#endif
+#ifndef FEATURE_CLOUDINARY
+  #define FEATURE_CLOUDINARY  1
+#endif
+#ifndef FEATURE_OTA
+  #define FEATURE_OTA         1
+#endif
+#ifndef FEATURE_STREAM
+  #define FEATURE_STREAM      1
+#endif
+#ifndef FEATURE_PROFILE
+  #define FEATURE_PROFILE     "full"
+#endif
+
+/// --- ring photos, suspicious-activity albums & error digests on Telegram ---
+constexpr bool featureTelegram   = FEATURE_TELEGRAM;
+
+/// --- upload of SD card captures to Cloudinary during the upload window ---
+constexpr bool featureCloudinary = FEATURE_CLOUDINARY;
+
+/// --- firmware update check on cold boot, reports to Telegram when available ---
+constexpr bool featureOta        = FEATURE_OTA;
+
+/// --- MJPEG live stream server ---
+constexpr bool featureStream     = FEATURE_STREAM;
+
+/// --- profile name, reported at boot ---
+constexpr const char* featureProfile = FEATURE_PROFILE;
+
+
+/// === firmware version ===
 extern const String FW_VERSION;
 
-extern const int acceptableDetections;
 
-extern const char* ntpServer;
+// === suspicious activity ===
+/// --- acceptable number of recent motion detections, tunable over MQTT ---
+extern int acceptableDetections;
+
+/// --- seconds for a motion detection to count half, decay continues through deep sleep ---
+constexpr unsigned long activityHalfLife = 1800;
+
+
+// === time settings ===
+/// --- ntp server url ---
+constexpr const char* ntpServer = "uk.pool.ntp.org";
+
+/// --- offset from gmt in hours ---
+constexpr long gmtOffset_sec = 0;
 
-extern const long  gmtOffset_sec;
+/// --- offset for daylight saving in seconds ---
+constexpr int  daylightOffset_sec = 3600;
 
-extern const int   daylightOffset_sec;
 
+// === camera profiles, tunable over MQTT ===
+/// --- surveillance & stream frame size (framesize_t), larger sizes than at boot apply from the next wake ---
+extern int cameraFrameSize;
+
+/// --- surveillance & stream JPEG quality, 0-63 & lower is better ---
+extern int cameraJpegQuality;
+
+/// --- ring frame size, large enough to identify a face at the door ---
+extern int ringFrameSize;
+
+/// --- ring JPEG quality ---
+extern int ringJpegQuality;
+
+
+/// === filename of image captured at latest doorbell ring ===
 extern const String lastRingCaptureFilename;
 
-extern const char* telegramHost;
 
+// === ring burst ===
+/// --- frames captured on a ring, the sharpest is sent ---
+constexpr int ringBurstFrames = 4;
+
+/// --- delay between burst frames ---
+constexpr unsigned long ringBurstInterval = 40;
+
+/// --- keep the frames that were not sent on the SD card for upload ---
+constexpr bool ringBurstArchive = true;
+
+/// --- wait before retrying a capture the frame pool had no room for ---
+constexpr unsigned long captureRetryDelay = 100;
+
+
+// === suspicious activity album ===
+/// --- frames sent to telegram as one album ---
+constexpr int suspiciousAlbumFrames = 4;
+
+/// --- delay between album frames ---
+constexpr unsigned long suspiciousAlbumInterval = 400;
+
+
+// === telegram ===
+/// --- telegram host url ---
+constexpr const char* telegramHost = "api.telegram.org";
+
+/// --- caption sent to telegram with latest ring capture ---
 extern String captionText;
 
-extern const char* cloudinaryHost;
 
-extern const int UPLOAD_START_HOUR;
+// === notifications ===
+/// --- digests that may be sent back to back ---
+constexpr int notifyBucketSize = 3;
+
+/// --- time to earn back one digest ---
+constexpr unsigned long notifyRefillPeriod = 60000;
+
+/// --- interval at which pending messages are coalesced into a digest ---
+constexpr unsigned long notifyFlushPeriod = 5000;
+
+
+// === MQTT ===
+/// --- initial delay before retrying a failed broker connection ---
+constexpr unsigned long mqttBackoffMin   = 500;
+
+/// --- longest delay between broker connection attempts ---
+constexpr unsigned long mqttBackoffMax   = 60000;
+
+/// --- interval at which the MQTT task services the client ---
+constexpr unsigned long mqttTaskPeriod   = 20;
+
+/// --- time allowed to drain the outbox before deep sleep ---
+constexpr unsigned long mqttFlushTimeout = 2000;
+
+
+// === MJPEG stream ===
+/// --- TCP port of the MJPEG stream server ---
+constexpr uint16_t streamPort = 81;
+
+/// --- interval over which per-client fps is measured & reported ---
+constexpr unsigned long streamStatsPeriod = 10000;
+
+
+/// === cloudinary host url ===
+constexpr const char* cloudinaryHost = "api.cloudinary.com";
+
+/// === time allowed for cloudinary to answer an upload ===
+constexpr unsigned long cloudinaryResponseTimeout = 10000;
+
+
+// === parallel uploads ===
+/// --- uploads per throughput sample, each sample moves the number of connections one step ---
+constexpr int uploadTuneWindow = 8;
+
+/// --- gain over the previous sample needed to keep moving in the same direction ---
+constexpr float uploadTuneGain = 0.05f;
+
+/// --- uploads remembered for the directory being drained, later ones may be uploaded again after an interruption ---
+constexpr int uploadManifestMax = 512;
 
-extern const int UPLOAD_END_HOUR;
+/// --- manifest entries written to the hot tier at once, & whenever a drain stops ---
+constexpr int uploadManifestBatch = 8;
 
+
+// === LAN ingest gateway, used instead of Cloudinary when INGEST_HOST is set ===
+/// --- time allowed to connect & be welcomed, the drain falls back to Cloudinary after it ---
+constexpr unsigned long ingestConnectTimeout = 2000;
+
+/// --- time allowed for the oldest file in flight to be acknowledged ---
+constexpr unsigned long ingestAckTimeout = 10000;
+
+
+// === person classifier ===
+/// --- minimum person score (0-100) that keeps a surveillance burst going, tunable over MQTT ---
+extern int personThreshold;
+
+/// --- opening part of a burst in which someone must be seen, otherwise it ends early ---
+constexpr unsigned long personGatePeriod = 3000;
+
+
+// === motion-extended surveillance ===
+/// --- quiet time after the last motion that ends surveillance once surveillancePeriod has passed ---
+constexpr unsigned long surveillanceHoldOff = 5000;
+
+/// --- luma change (0-255) of a thumbnail pixel that counts as changed between frames ---
+constexpr int motionPixelDelta = 16;
+
+/// --- changed share of the scene in % from which frames count as motion, & below which they count as quiet ---
+constexpr int motionOnScore  = 6;
+constexpr int motionOffScore = 2;
+
+
+/// === write & read rounds per storage tier benchmarked on cold boot, 0 disables ===
+constexpr int storageBenchRounds = 0;
+
+
+// === light sleep between events ===
+/// --- longest light sleep, MQTT traffic buffered by the access point waits at most this long ---
+constexpr unsigned long idleSleepPeriod = 1000;
+
+/// --- awake time after a timer wake, for WiFi to fetch buffered frames & the MQTT task to run ---
+constexpr unsigned long idleAwakeWindow = 100;
+
+/// --- shorter sleeps aren't worth the exit latency ---
+constexpr unsigned long idleMinSleep = 20;
+
+/// --- board current awake & in light sleep in mA for the published estimate, replace with meter readings of the board ---
+constexpr float idleActiveCurrent = 120.0f;
+constexpr float idleSleepCurrent  = 6.0f;
+
+
+// === fleet coordination over MQTT ===
+/// --- length of an upload slot, the upload window is split into slots leased by one unit each ---
+constexpr unsigned long fleetSlotMinutes = 20;
+
+/// --- most slots one unit leases at a time, the fleet's free slots are shared out by backlog ---
+constexpr int fleetMaxLease = 3;
+
+/// --- slots tried before falling back to the unit's own upload wake plan ---
+constexpr int fleetClaimAttempts = 3;
+
+/// --- wait after a claim, longer than any claim takes to reach the broker, so every unit sees the same last write ---
+constexpr unsigned long fleetSettleTime = 1500;
+
+/// --- seconds before a lease ends that the next slot is claimed, longer than a claim takes to settle ---
+constexpr uint32_t fleetRenewLead = 10;
+
+/// --- retained fleet state arrives after subscribing, decisions wait this long after each connect ---
+constexpr unsigned long fleetSyncTime = 1000;
+
+/// --- without the broker a unit uploads on its own once this long awake ---
+constexpr unsigned long fleetBrokerWait = 15000;
+
+/// --- suspicious-activity alerts of the fleet within this many seconds count as one ---
+constexpr uint32_t fleetAlertWindow = 300;
+
+/// --- peers not announced for this many seconds are left out of the backlog share ---
+constexpr uint32_t fleetPeerExpiry = 2 * 86400;
+
+
+// === upload wake planning without the fleet ===
+/// --- longest drain of one wake in seconds, a larger backlog is split over several wakes ---
+constexpr unsigned long uploadWakeBudget = 900;
+
+/// --- earliest next wake after sleeping inside the window, in seconds ---
+constexpr unsigned long uploadRetryDelay = 60;
+
+/// --- estimates before the first drain: throughput in bytes/s, bytes per capture & ms from timer wake to drain ---
+constexpr float    uploadDefaultRate     = 20000.0f;
+constexpr uint32_t uploadDefaultFileSize = 40000;
+constexpr uint32_t uploadDefaultOverhead = 8000;
+
+/// --- weight of each new drain or night in the running estimates ---
+constexpr float uploadEstimateGain = 0.3f;
+
+
+/// === time spent deleting trashed sessions before each deep sleep ===
+constexpr unsigned long trashReclaimBudget = 3000;
+
+
+/// === most journal records exported over MQTT before each deep sleep ===
+constexpr int journalExportBudget = 256;
+
+
+// === time window to commence upload, tunable over MQTT ===
+/// --- start hour of upload window ---
+extern int UPLOAD_START_HOUR;
+/// --- end hour of upload window ---
+extern int UPLOAD_END_HOUR;
+
+
+/// === to check if any images left to upload on SD card ===
 extern bool imagesLeftToUpload;
 
+
+// === runtime state ===
+/// --- end of the last action, standby is measured from here ---
 extern unsigned long lastActionTime;
 
+/// --- time of the last ring ---
 extern unsigned long lastRingTime;
 
-extern const unsigned long surveillancePeriod;
 
-extern const unsigned long warmUpPeriod;
+// === time variables ===
+/// --- shortest surveillance, extended while motion continues, tunable over MQTT ---
+extern unsigned long surveillancePeriod;
+
+/// --- longest surveillance however long motion continues, tunable over MQTT ---
+extern unsigned long surveillanceMaxPeriod;
+
+/// --- time allowed to warm up PIR sensor ---
+constexpr unsigned long warmUpPeriod = 20000;
 
-extern const unsigned long allowedStandbyDuration;
+/// --- allowed standby duration, tunable over MQTT ---
+extern unsigned long allowedStandbyDuration;
 
-extern const unsigned long timeSinceLastRing; 
\ No newline at end of file
+/// --- minimum time to pass since last ring ---
+constexpr unsigned long timeSinceLastRing = 2000;
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+#include <Arduino.h>
+
+/// === mean luma AC magnitude per 8x8 block (x16) of a baseline JPEG, 0 if it cannot be parsed ===
+uint32_t jpegSharpness(const uint8_t* jpeg, size_t len);
+
+/// === largest thumbnail jpegLumaThumbnail can produce, in pixels ===
+const int JPEG_THUMBNAIL_MAX = 64 * 48;
+
+/// === 8-bit luma thumbnail of a baseline JPEG from its DC coefficients, false if it cannot be parsed or is smaller ===
+bool jpegLumaThumbnail(const uint8_t* jpeg, size_t len, uint8_t* out, int outW, int outH);
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+
+/// === maximum number of simultaneous MJPEG clients ===
+const int STREAM_MAX_CLIENTS = 3;
+
+/// === per-client streaming statistics ===
+struct StreamClientStats {
+    bool     active;
+    float    fps;
+    uint32_t framesSent;
+    uint32_t framesDropped;
+};
+
+void initStreamServer();
+
+int streamClientCount();
+
+bool getStreamClientStats(int slot, StreamClientStats& stats);
\ No newline at end of file
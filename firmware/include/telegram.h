@@ -1,6 +1,20 @@
 #pragma once
 #include <Arduino.h>
 
+void initTelegram();
+
 void sendMsgToTelegram(const String& msg);
 
-void sendImageToTelegram(String caption);
\ No newline at end of file
+void sendImageToTelegram(String caption);
+
+/// === Telegram accepts between 2 & 10 photos per media group ===
+const int TELEGRAM_MEDIA_GROUP_MAX = 10;
+
+/// === one photo of an album, streamed from memory when buf is set, else from the SD card ===
+struct TelegramMedia {
+    String         path;
+    const uint8_t* buf;
+    size_t         len;
+};
+
+bool sendMediaGroupToTelegram(const TelegramMedia* media, int count, const String& caption);
\ No newline at end of file
@@ -5,6 +5,6 @@ void initTime();
 
 String getCurrentDateTime();
 
-void scheduleRandomTimerWake();
+bool nextUploadWindow(time_t& uploadStartTs, time_t& uploadEndTs);
 
 bool timeToUpload();
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include <Arduino.h>
+
+/// === traced hot-path phases, ids are part of the export format ===
+enum TracePhase : uint8_t {
+    TRACE_BOOT          = 0,
+    TRACE_INIT_MCP      = 1,
+    TRACE_INIT_CAMERA   = 2,
+    TRACE_INIT_SD       = 3,
+    TRACE_INIT_WIFI     = 4,
+    TRACE_CAMERA_FB_GET = 5,
+    TRACE_SD_OPEN       = 6,
+    TRACE_SD_WRITE      = 7,
+    TRACE_SD_CLOSE      = 8,
+    TRACE_TLS_CONNECT   = 9,
+    TRACE_UPLOAD        = 10,
+    TRACE_TELEGRAM_SEND = 11,
+    TRACE_SHARPNESS     = 12,
+    TRACE_FLASH_OPEN    = 13,
+    TRACE_FLASH_WRITE   = 14,
+    TRACE_FLASH_CLOSE   = 15,
+    TRACE_PERSON        = 16,
+    TRACE_CAMERA_SWITCH = 17,
+    TRACE_INGEST_OPEN   = 18,
+};
+
+/// === number of records kept in the RTC memory ring buffer ===
+const int TRACE_BUFFER_SIZE = 96;
+
+/// === one completed span, timestamps in esp_timer microseconds ===
+struct __attribute__((packed)) TraceRecord {
+    uint8_t  phase;
+    uint8_t  wake;
+    uint16_t reserved;
+    uint32_t beginUs;
+    uint32_t endUs;
+};
+
+void initTrace();
+
+uint32_t traceBegin();
+
+void traceEnd(TracePhase phase, uint32_t beginUs);
+
+bool flushTraceToMQTT();
\ No newline at end of file
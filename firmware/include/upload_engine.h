@@ -0,0 +1,41 @@
+#pragma once
+#include <Arduino.h>
+
+/// === TLS connections kept in flight by a drain, the engine tunes between the two ===
+const int UPLOAD_MIN_CONNECTIONS = 2;
+const int UPLOAD_MAX_CONNECTIONS = 4;
+
+/// === file bytes read from SD per TLS write, one PSRAM buffer per connection ===
+const size_t UPLOAD_CHUNK_SIZE = 16384;
+
+/// === files queued ahead of the connections ===
+const int UPLOAD_QUEUE_LEN = 8;
+
+const int UPLOAD_PATH_LEN = 96;
+
+/// === outcome of submitting a file ===
+enum UploadSubmit {
+    UPLOAD_QUEUED,
+    UPLOAD_QUEUE_FULL,
+    UPLOAD_REJECTED,
+};
+
+/// === outcome of one queued file ===
+struct UploadResult {
+    char     path[UPLOAD_PATH_LEN];
+    bool     ok;
+    uint32_t bytes;
+    uint32_t ms;
+};
+
+bool startUploads();
+
+UploadSubmit submitUpload(const String& path);
+
+bool nextUploadResult(UploadResult& result, unsigned long waitMs);
+
+int cancelUploads();
+
+void stopUploads();
+
+int uploadConnections();
\ No newline at end of file
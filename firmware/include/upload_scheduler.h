@@ -0,0 +1,12 @@
+#pragma once
+#include <Arduino.h>
+
+void beginUploadDrain();
+
+void endUploadDrain(uint32_t files, uint32_t bytes, bool imagesLeft);
+
+bool uploadBudgetLeft();
+
+uint32_t uploadSecondsNeeded();
+
+bool scheduleUploadWake();
\ No newline at end of file
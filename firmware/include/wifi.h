@@ -1,4 +1,7 @@
 #pragma once
 #include <Arduino.h>
 
-void initWifi();
\ No newline at end of file
+void initWifi();
+
+/// === stack of a task making TLS connections, a handshake needs most of it ===
+const uint32_t TLS_TASK_STACK = 8192;
\ No newline at end of file
@@ -0,0 +1,88 @@
+// === native microbenchmark helpers ===
+#include "bench.h"
+
+#include <SD_MMC.h>
+#include <LittleFS.h>
+#include <chrono>
+#include <filesystem>
+
+#include "settings.h"
+#include "capture_session.h"
+
+
+// === runtime state normally defined in main.cpp ===
+unsigned long lastActionTime = 0;
+unsigned long lastRingTime   = 0;
+
+
+void benchOp(BenchResult& result, const std::function<size_t()>& op) {
+    uint64_t      allocs      = fakeAllocCount;
+    uint64_t      allocBytes  = fakeAllocBytes;
+    unsigned long virtualMs   = millis();
+    auto          start       = std::chrono::steady_clock::now();
+
+    size_t bytes = op();
+
+    auto end = std::chrono::steady_clock::now();
+    result.latencyUs.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    result.virtualMs  += millis() - virtualMs;
+    result.allocs     += fakeAllocCount - allocs;
+    result.allocBytes += fakeAllocBytes - allocBytes;
+    result.bytes      += bytes;
+    result.ops++;
+}
+
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(values.size() * p / 100))];
+}
+
+
+void benchReport(const BenchOptions& options, BenchResult& result) {
+    double totalUs = 0;
+    for (double us : result.latencyUs) totalUs += us;
+
+    double ops        = result.ops ? result.ops : 1;
+    double throughput = totalUs > 0 ? result.bytes / totalUs : 0;
+    double p50        = percentile(result.latencyUs, 50);
+    double p99        = percentile(result.latencyUs, 99);
+
+    printf("%-28s %6u ops  %8.1f MB/s  p50 %9.1f us  p99 %9.1f us  %7.1f allocs/op  %9.0f B/op  %8.1f ms/op on device clock\n",
+           result.name.c_str(), result.ops, throughput, p50, p99,
+           result.allocs / ops, result.allocBytes / ops, result.virtualMs / ops);
+
+    if (options.jsonPath.isEmpty()) return;
+
+    FILE* json = fopen(options.jsonPath.c_str(), "a");
+    if (!json) return;
+    fprintf(json,
+            "{\"label\":\"%s\",\"bench\":\"%s\",\"ops\":%u,\"mb_per_s\":%.3f,\"p50_us\":%.1f,\"p99_us\":%.1f,"
+            "\"allocs_per_op\":%.2f,\"alloc_bytes_per_op\":%.0f,\"device_ms_per_op\":%.2f}\n",
+            options.label.c_str(), result.name.c_str(), result.ops, throughput, p50, p99,
+            result.allocs / ops, result.allocBytes / ops, result.virtualMs / ops);
+    fclose(json);
+}
+
+
+bool benchSelected(const BenchOptions& options, const char* name) {
+    return options.filter.isEmpty() || String(name).indexOf(options.filter) >= 0;
+}
+
+
+void benchResetSD() {
+    std::error_code ec;
+    std::filesystem::remove_all(SD_MMC.hostRoot().c_str(), ec);
+    std::filesystem::remove_all(LittleFS.hostRoot().c_str(), ec);
+    SD_MMC.begin("/sdcard", true);
+    LittleFS.begin(true);
+    initSessions();
+}
+
+
+void benchSkipBrokerWait() {
+    if (millis() < fleetBrokerWait) {
+        delay(fleetBrokerWait - millis());
+    }
+}
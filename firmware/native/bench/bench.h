@@ -0,0 +1,59 @@
+#pragma once
+// === native microbenchmark helpers ===
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+/// === command line options shared by every benchmark ===
+struct BenchOptions {
+    String   corpus;
+    String   label;
+    String   jsonPath;
+    String   filter;
+    uint32_t iterations = 200;
+    /// --- host running tools/net_harness.py, network benchmarks are skipped without it ---
+    String   netTarget;
+    /// --- device port to stand-in port, e.g. "443:8443,1883:18830" ---
+    String   netPorts;
+    /// --- person model from tools/person_model.py, random weights without it ---
+    String   personModel;
+    /// --- directory with person/ & empty/ captures for the classifier accuracy ---
+    String   labeled;
+};
+
+/// === measurements of one benchmarked path ===
+struct BenchResult {
+    String                name;
+    uint32_t              ops        = 0;
+    uint64_t              bytes      = 0;
+    uint64_t              allocs     = 0;
+    uint64_t              allocBytes = 0;
+    uint64_t              virtualMs  = 0;
+    std::vector<double>   latencyUs;
+};
+
+/// --- time one operation, the callback returns the payload bytes it moved ---
+void benchOp(BenchResult& result, const std::function<size_t()>& op);
+
+/// --- print a result & append it to the JSON report if requested ---
+void benchReport(const BenchOptions& options, BenchResult& result);
+
+/// --- skip benchmarks not matching --filter ---
+bool benchSelected(const BenchOptions& options, const char* name);
+
+/// --- fresh, empty SD card & LittleFS roots on the host ---
+void benchResetSD();
+
+/// --- advance the clock past fleetBrokerWait, before it a drain without the broker stops at once ---
+void benchSkipBrokerWait();
+
+
+// === benchmark suites ===
+void benchCaptureAndUpload(const BenchOptions& options);
+void benchSharpness(const BenchOptions& options);
+void benchStorageTiers(const BenchOptions& options);
+void benchConfig(const BenchOptions& options);
+void benchPerson(const BenchOptions& options);
+void benchActivity(const BenchOptions& options);
+void benchJournal(const BenchOptions& options);
+void benchNetwork(const BenchOptions& options);
@@ -0,0 +1,29 @@
+// === suspicious activity tracker, updated on every confirmed motion ===
+#include "bench.h"
+
+#include "settings.h"
+#include "activity.h"
+
+
+/// === record a detection & check both alert levels, as the main loop does ===
+static void benchActivityRecord(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "activity_record";
+
+    uint32_t alerts = 0;
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() {
+            recordActivity();
+            alerts += activityAlert(1);
+            alerts += activityAlert(2);
+            return 0;
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+void benchActivity(const BenchOptions& options) {
+    if (benchSelected(options, "activity_record"))  benchActivityRecord(options);
+}
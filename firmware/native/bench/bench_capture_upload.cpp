@@ -0,0 +1,205 @@
+// === capture, storage & upload paths through the real firmware code ===
+#include "bench.h"
+
+#include <SD_MMC.h>
+#include <WiFi.h>
+
+#include "settings.h"
+#include "pins.h"
+#include "camera.h"
+#include "frame_pool.h"
+#include "microSD_card.h"
+#include "hot_tier.h"
+#include "mcp23017.h"
+#include "cloudinary.h"
+#include "telegram.h"
+#include "capture_save_image.h"
+#include "upload_sd_card.h"
+#include "capture_session.h"
+
+
+/// === capture a frame & write it to the SD card ===
+static void benchCapture(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "capture_and_save_image";
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        String name = "bench_" + String(i);
+        benchOp(result, [&]() {
+            captureAndSaveImage(name);
+            return SD_MMC.open(capturePath(name)).size();
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === take & return frames of every size class, as consumers holding frames do ===
+static void benchFramePool(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "frame_pool_acquire_release";
+
+    FramePoolStats stats[FRAME_POOL_BUCKETS];
+    for (int bucket = 0; bucket < FRAME_POOL_BUCKETS; bucket++) {
+        getFramePoolStats(bucket, stats[bucket]);
+    }
+
+    PooledFrame* held[FRAME_POOL_BUCKETS];
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() {
+            size_t bytes = 0;
+            for (int bucket = 0; bucket < FRAME_POOL_BUCKETS; bucket++) {
+                held[bucket] = acquireFrame(stats[bucket].capacity);
+                bytes += held[bucket] ? held[bucket]->capacity : 0;
+            }
+            for (int bucket = 0; bucket < FRAME_POOL_BUCKETS; bucket++) {
+                releaseFrame(held[bucket]);
+            }
+            return bytes;
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === build & stream one Cloudinary multipart request per file ===
+static void benchCloudinaryMultipart(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "cloudinary_multipart";
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        String name = "IMG_bench_" + String(i) + ".jpg";
+        if (!SD_MMC.exists(capturePath("bench_" + String(i)))) {
+            captureAndSaveImage("bench_" + String(i));
+        }
+        File file = SD_MMC.open(capturePath("bench_" + String(i)));
+        size_t size = file.size();
+        benchOp(result, [&]() {
+            uploadImageToCloudinary(file, name);
+            return size;
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === build & stream the Telegram sendPhoto request for the latest ring capture ===
+static void benchTelegramMultipart(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "telegram_multipart";
+
+    captureAndSaveImage(lastRingCaptureFilename);
+    size_t size = storageFor(lastRingCaptureFilename).open("/IMG_" + lastRingCaptureFilename + ".jpg").size();
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() {
+            sendImageToTelegram(captionText);
+            return size;
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === stream an album of pooled frames in one sendMediaGroup request ===
+static void benchTelegramMediaGroup(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "telegram_media_group";
+
+    PooledFrame* frames[4];
+    TelegramMedia media[4];
+    size_t size = 0;
+    int count = 0;
+    while (count < 4 && (frames[count] = captureFrame()) != nullptr) {
+        media[count] = { String(), frames[count]->buf, frames[count]->len };
+        size += frames[count++]->len;
+    }
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() {
+            sendMediaGroupToTelegram(media, count, captionText);
+            return size;
+        });
+    }
+
+    for (int i = 0; i < count; i++) {
+        releaseFrame(frames[i]);
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === drain a backlog of captures with uploadAndDeleteAll() ===
+static void benchUploadAndDeleteAll(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "upload_and_delete_all";
+
+    benchResetSD();
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        captureAndSaveImage("backlog_" + String(i));
+    }
+
+    benchSkipBrokerWait();
+
+    uint64_t sentBefore = fakeNetwork.bytesSent;
+    benchOp(result, [&]() {
+        uploadAndDeleteAll();
+        return (size_t)(fakeNetwork.bytesSent - sentBefore);
+    });
+
+    /// --- report per uploaded file rather than per drain ---
+    result.ops = options.iterations;
+    result.latencyUs.assign(options.iterations, result.latencyUs[0] / options.iterations);
+
+    benchReport(options, result);
+}
+
+
+/// === wipe a backlog of captures, then reclaim their space ===
+static void benchWipeSessions(const BenchOptions& options) {
+    BenchResult wipe;
+    BenchResult reclaim;
+    wipe.name    = "wipe_sessions";
+    reclaim.name = "reclaim_trash";
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchResetSD();
+        for (int f = 0; f < 50; f++) {
+            if (f % 10 == 0) beginSession();
+            captureAndSaveImage("backlog_" + String(f));
+        }
+
+        benchOp(wipe,    []() { wipeSessions(); return (size_t)0; });
+        benchOp(reclaim, []() { while (!reclaimTrash(1000)) {} return (size_t)0; });
+    }
+
+    benchReport(options, wipe);
+    benchReport(options, reclaim);
+}
+
+
+void benchCaptureAndUpload(const BenchOptions& options) {
+    benchResetSD();
+    initCamera();
+    initFramePool();
+    initMicroSD();
+    initHotTier();
+    initMCP();
+
+    /// --- no motion, so uploads are never interrupted ---
+    mcp.fakeSetInput(PIR_PIN, LOW);
+
+    if (benchSelected(options, "capture_and_save_image"))   benchCapture(options);
+    if (benchSelected(options, "frame_pool"))               benchFramePool(options);
+    if (benchSelected(options, "cloudinary_multipart"))     benchCloudinaryMultipart(options);
+    if (benchSelected(options, "telegram_multipart"))       benchTelegramMultipart(options);
+    if (benchSelected(options, "telegram_media_group"))     benchTelegramMediaGroup(options);
+    if (benchSelected(options, "upload_and_delete_all"))    benchUploadAndDeleteAll(options);
+    if (benchSelected(options, "wipe_sessions") ||
+        benchSelected(options, "reclaim_trash"))            benchWipeSessions(options);
+}
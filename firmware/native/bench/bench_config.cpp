@@ -0,0 +1,67 @@
+// === runtime configuration commands, as delivered on doorbell/config/# ===
+#include "bench.h"
+
+#include "settings.h"
+#include "camera.h"
+#include "runtime_config.h"
+
+
+/// === stage & apply one command per tunable, plus a rejected one ===
+static void benchConfigCommand(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "config_command";
+
+    /// --- two sets of values in turn, repeats are skipped like retained commands after a reconnect ---
+    static const char* commands[2][8][2] = {
+        {
+            { "surveillance_ms", "20000" },
+            { "standby_ms",      "45000" },
+            { "detections",      "25"    },
+            { "upload_start",    "2"     },
+            { "upload_end",      "5"     },
+            { "frame_size",      "QVGA"  },
+            { "jpeg_quality",    "12"    },
+            { "jpeg_quality",    "200"   },
+        },
+        {
+            { "surveillance_ms", "30000" },
+            { "standby_ms",      "60000" },
+            { "detections",      "30"    },
+            { "upload_start",    "3"     },
+            { "upload_end",      "6"     },
+            { "frame_size",      "CIF"   },
+            { "jpeg_quality",    "14"    },
+            { "jpeg_quality",    "300"   },
+        },
+    };
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        handleConfigCommand("reset", "");
+
+        benchOp(result, [&]() {
+            size_t bytes = 0;
+            for (const auto& command : commands[i % 2]) {
+                handleConfigCommand(command[0], command[1]);
+                bytes += strlen(command[1]);
+            }
+            applyRuntimeConfig();
+            return bytes;
+        });
+    }
+
+    benchReport(options, result);
+
+    /// --- leave the defaults for the benchmarks that follow ---
+    handleConfigCommand("reset", "");
+    handleConfigCommand("frame_size", "VGA");
+    handleConfigCommand("jpeg_quality", "10");
+    applyRuntimeConfig();
+}
+
+
+void benchConfig(const BenchOptions& options) {
+    initRuntimeConfig();
+    initCamera();
+
+    if (benchSelected(options, "config_command"))  benchConfigCommand(options);
+}
@@ -0,0 +1,50 @@
+// === event journal: append, batched SD flush & range reads for export ===
+#include "bench.h"
+
+#include <SD_MMC.h>
+
+#include "journal.h"
+
+
+/// === journal one event, every JOURNAL_BUFFER_SIZE-th append writes the batch to the SD card ===
+static void benchJournalAppend(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "journal_append";
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() {
+            journal(JOURNAL_MOTION, 1, (uint16_t)(i % 100), i);
+            return sizeof(JournalRecord);
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === write a part-filled batch, as an error or OTA restart does ===
+static void benchJournalFlush(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "journal_flush";
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        for (int j = 0; j < JOURNAL_BUFFER_SIZE / 4; j++) {
+            journal(JOURNAL_RING, 1);
+        }
+        benchOp(result, [&]() {
+            flushJournal();
+            return JOURNAL_BUFFER_SIZE / 4 * sizeof(JournalRecord);
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+void benchJournal(const BenchOptions& options) {
+    benchResetSD();
+    initJournal();
+
+    if (benchSelected(options, "journal_append"))  benchJournalAppend(options);
+    if (benchSelected(options, "journal_flush"))   benchJournalFlush(options);
+}
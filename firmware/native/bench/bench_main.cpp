@@ -0,0 +1,56 @@
+// === native benchmark entry point ===
+//
+// Usage: program [--corpus DIR] [--iterations N] [--filter NAME] [--json FILE] [--label COMMIT]
+//              [--net-target HOST] [--net-ports MAP] [--person-model FILE] [--labeled DIR]
+#include "bench.h"
+
+#include <SD_MMC.h>
+#include <LittleFS.h>
+#include <esp_camera.h>
+#include <filesystem>
+
+
+/// --- pio test -e native links the suites in test/ with their own main ---
+#ifndef PIO_UNIT_TESTING
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        String flag = argv[i];
+        if      (flag == "--corpus")     options.corpus     = argv[i + 1];
+        else if (flag == "--iterations") options.iterations = atoi(argv[i + 1]);
+        else if (flag == "--filter")     options.filter     = argv[i + 1];
+        else if (flag == "--json")       options.jsonPath   = argv[i + 1];
+        else if (flag == "--label")      options.label      = argv[i + 1];
+        else if (flag == "--net-target") options.netTarget  = argv[i + 1];
+        else if (flag == "--net-ports")  options.netPorts   = argv[i + 1];
+        else if (flag == "--person-model") options.personModel = argv[i + 1];
+        else if (flag == "--labeled")    options.labeled    = argv[i + 1];
+    }
+
+    /// --- SD card & LittleFS partition live in scratch directories ---
+    String sdRoot    = (std::filesystem::temp_directory_path() / "guardianbell_native_sd").string().c_str();
+    String flashRoot = (std::filesystem::temp_directory_path() / "guardianbell_native_littlefs").string().c_str();
+    SD_MMC.setHostRoot(sdRoot);
+    LittleFS.setHostRoot(flashRoot);
+
+    size_t frames = fakeCameraLoadCorpus(options.corpus.isEmpty() ? nullptr : options.corpus.c_str());
+    printf("GuardianBell native benchmarks: %u corpus frames, %u iterations\n\n",
+           (unsigned)frames, options.iterations);
+
+    benchCaptureAndUpload(options);
+    benchSharpness(options);
+    benchStorageTiers(options);
+    benchConfig(options);
+    benchPerson(options);
+    benchActivity(options);
+    benchJournal(options);
+    benchNetwork(options);
+
+    std::error_code ec;
+    std::filesystem::remove_all(sdRoot.c_str(), ec);
+    std::filesystem::remove_all(flashRoot.c_str(), ec);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,292 @@
+// === end-to-end network paths against local stand-ins (tools/net_harness.py) ===
+//
+// Only runs when --net-target is given; every device connection is then opened
+// as a real TCP/TLS socket to that host, device ports remapped by --net-ports.
+#include "bench.h"
+
+#include <SD_MMC.h>
+#include <WiFi.h>
+#include <Update.h>
+#include <esp_camera.h>
+#include <chrono>
+#include <thread>
+
+#include "settings.h"
+#include "pins.h"
+#include "camera.h"
+#include "frame_pool.h"
+#include "microSD_card.h"
+#include "mcp23017.h"
+#include "mqtt.h"
+#include "mqtt_snapshot.h"
+#include "ota.h"
+#include "telegram.h"
+#include "notify.h"
+#include "error.h"
+#include "capture_save_image.h"
+#include "upload_sd_card.h"
+#include "upload_engine.h"
+#include "capture_session.h"
+#include "cloudinary.h"
+#include "ingest_client.h"
+#include "secrets.h"
+
+
+/// === wait in real time, the MQTT task runs on its own thread ===
+static bool waitFor(const std::function<bool()>& done, unsigned long timeoutMs) {
+    auto start = std::chrono::steady_clock::now();
+    while (!done()) {
+        if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(timeoutMs)) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+
+/// === bytes written to the network by one operation ===
+static size_t sentBy(const std::function<void()>& op) {
+    uint64_t before = fakeNetwork.bytesSent;
+    op();
+    return (size_t)(fakeNetwork.bytesSent - before);
+}
+
+
+/// === ring notification: sendPhoto with the latest capture ===
+static void benchRingToTelegram(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "net_ring_to_telegram";
+
+    captureAndSaveImage(lastRingCaptureFilename);
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() { return sentBy([]() { sendImageToTelegram(captionText); }); });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === suspicious activity album: four frames in one sendMediaGroup request ===
+static void benchTelegramAlbum(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "net_telegram_album";
+
+    PooledFrame* frames[4];
+    TelegramMedia media[4];
+    int count = 0;
+    while (count < 4 && (frames[count] = captureFrame()) != nullptr) {
+        media[count] = { String(), frames[count]->buf, frames[count]->len };
+        count++;
+    }
+
+    uint32_t failed = 0;
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() {
+            return sentBy([&]() { failed += !sendMediaGroupToTelegram(media, count, captionText); });
+        });
+    }
+
+    for (int i = 0; i < count; i++) {
+        releaseFrame(frames[i]);
+    }
+
+    benchReport(options, result);
+    if (failed) {
+        printf("net_telegram_album: %u requests rejected\n", failed);
+    }
+}
+
+
+/// === plain Telegram message ===
+static void benchTelegramMessage(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "net_telegram_message";
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() { return sentBy([]() { sendMsgToTelegram("Motion detected"); }); });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === burst of repeated errors coalesced into one digest ===
+static void benchErrorStorm(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "net_error_storm";
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() {
+            return sentBy([]() {
+                for (int e = 0; e < 50; e++) {
+                    error("Failed to save image " + String(e % 5), false);
+                }
+                flushNotify(true);
+            });
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === drain a backlog of captures to Cloudinary ===
+static void benchCloudinaryUpload(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "net_cloudinary_upload";
+
+    benchResetSD();
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        captureAndSaveImage("backlog_" + String(i));
+    }
+
+    benchSkipBrokerWait();
+    benchOp(result, [&]() { return sentBy([]() { uploadAndDeleteAll(); }); });
+
+    /// --- report per uploaded file rather than per drain ---
+    result.ops = options.iterations;
+    result.latencyUs.assign(options.iterations, result.latencyUs[0] / options.iterations);
+
+    benchReport(options, result);
+    printf("net_cloudinary_upload: tuned to %d connections\n", uploadConnections());
+}
+
+
+/// === the same backlog one uploadImageToCloudinary() per file, a TLS session each ===
+static void benchCloudinarySingle(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "net_cloudinary_single";
+
+    benchResetSD();
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        String name = "single_" + String(i);
+        captureAndSaveImage(name);
+        File file = SD_MMC.open(capturePath(name));
+        benchOp(result, [&]() { return sentBy([&]() { uploadImageToCloudinary(file, "IMG_" + name + ".jpg"); }); });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === the same backlog streamed to the LAN ingest gateway (net_harness.py --gateway) ===
+static void benchIngestUpload(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "net_ingest_upload";
+
+    /// --- any host reaches the stand-in, the device port is remapped to the gateway ---
+    const char* configured = INGEST_HOST;
+    INGEST_HOST = "ingest.local";
+
+    WiFiClient probe;
+    uint16_t   window;
+    uint32_t   maxBytes;
+    if (!ingestConnect(probe, window, maxBytes)) {
+        printf("net_ingest_upload: gateway unreachable, run net_harness.py with --gateway, skipped\n");
+        INGEST_HOST = configured;
+        return;
+    }
+    probe.stop();
+
+    benchResetSD();
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        captureAndSaveImage("backlog_" + String(i));
+    }
+
+    benchSkipBrokerWait();
+    benchOp(result, [&]() { return sentBy([]() { uploadAndDeleteAll(); }); });
+
+    /// --- report per uploaded file rather than per drain ---
+    result.ops = options.iterations;
+    result.latencyUs.assign(options.iterations, result.latencyUs[0] / options.iterations);
+
+    benchReport(options, result);
+    printf("net_ingest_upload: window %u\n", window);
+
+    INGEST_HOST = configured;
+}
+
+
+/// === version check, notes & firmware download ===
+static void benchOtaCheck(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "net_ota_check";
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() {
+            /// --- a completed update ends in a restart ---
+            uint32_t restarts = ESP.fakeRestarts;
+            checkForFirmwareUpdate();
+            return ESP.fakeRestarts != restarts ? Update.fakeWritten() : 0;
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === outbox events & snapshot chunks through the MQTT task ===
+static void benchMqtt(const BenchOptions& options) {
+    initMQTT();
+    if (!waitFor(mqttConnected, 5000)) {
+        printf("net_mqtt: broker unreachable, skipped\n");
+        return;
+    }
+
+    if (benchSelected(options, "net_mqtt_event")) {
+        BenchResult result;
+        result.name = "net_mqtt_event";
+
+        for (uint32_t i = 0; i < options.iterations; i++) {
+            String payload = "{\"event\":\"ring\",\"n\":" + String(i) + "}";
+            benchOp(result, [&]() {
+                publishMQTT("doorbell/bench", payload);
+                waitFor([]() { return mqttOutboxDepth() == 0; }, 5000);
+                return (size_t)payload.length();
+            });
+        }
+
+        benchReport(options, result);
+    }
+
+    if (benchSelected(options, "net_mqtt_snapshot")) {
+        BenchResult result;
+        result.name = "net_mqtt_snapshot";
+
+        for (uint32_t i = 0; i < options.iterations; i++) {
+            camera_fb_t* fb = esp_camera_fb_get();
+            benchOp(result, [&]() {
+                return publishSnapshotToMQTT(fb->buf, fb->len, "bench") ? fb->len : 0;
+            });
+            esp_camera_fb_return(fb);
+        }
+
+        benchReport(options, result);
+    }
+}
+
+
+void benchNetwork(const BenchOptions& options) {
+    if (options.netTarget.isEmpty()) return;
+
+    fakeNetwork.target  = options.netTarget;
+    fakeNetwork.portMap = options.netPorts;
+
+    benchResetSD();
+    initCamera();
+    initFramePool();
+    initMicroSD();
+    initMCP();
+    mcp.fakeSetInput(PIR_PIN, LOW);
+
+    if (benchSelected(options, "net_ring_to_telegram"))   benchRingToTelegram(options);
+    if (benchSelected(options, "net_telegram_album"))     benchTelegramAlbum(options);
+    if (benchSelected(options, "net_telegram_message"))   benchTelegramMessage(options);
+    if (benchSelected(options, "net_error_storm"))        benchErrorStorm(options);
+    if (benchSelected(options, "net_cloudinary_upload"))  benchCloudinaryUpload(options);
+    if (benchSelected(options, "net_cloudinary_single"))  benchCloudinarySingle(options);
+    if (benchSelected(options, "net_ingest_upload"))      benchIngestUpload(options);
+    if (benchSelected(options, "net_ota_check"))          benchOtaCheck(options);
+    if (benchSelected(options, "net_mqtt"))               benchMqtt(options);
+
+    fakeNetwork.target = "";
+}
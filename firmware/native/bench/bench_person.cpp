@@ -0,0 +1,172 @@
+// === person classifier: thumbnail, inference & accuracy on labelled captures ===
+#include "bench.h"
+
+#include <esp_camera.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "settings.h"
+#include "camera.h"
+#include "person_detect.h"
+#include "sharpness.h"
+
+
+/// === model of the right shape with random weights, inference time doesn't depend on them ===
+static std::vector<uint8_t> randomModel() {
+    std::mt19937 rng(1);
+    std::vector<uint8_t> blob = { 'G', 'B', 'P', 'M', 1, PERSON_INPUT_W, PERSON_INPUT_H, PERSON_LAYERS };
+    for (int c : PERSON_CHANNELS) blob.push_back((uint8_t)c);
+    blob.push_back(0);
+
+    auto put = [&](const void* p, size_t n) { blob.insert(blob.end(), (const uint8_t*)p, (const uint8_t*)p + n); };
+    float scale = 0.01f;
+    put(&scale, sizeof(scale));
+
+    int inC = 1;
+    for (int outC : PERSON_CHANNELS) {
+        for (int i = 0; i < 9 * inC * outC; i++) blob.push_back((uint8_t)(int8_t)(rng() % 255 - 127));
+        int32_t bias = 0, multiplier = 1 << 30;
+        int8_t  shift = 8;
+        for (int c = 0; c < outC; c++) put(&bias, sizeof(bias));
+        for (int c = 0; c < outC; c++) put(&multiplier, sizeof(multiplier));
+        for (int c = 0; c < outC; c++) put(&shift, sizeof(shift));
+        inC = outC;
+    }
+    for (int c = 0; c < inC; c++) blob.push_back((uint8_t)(int8_t)(rng() % 255 - 127));
+    int32_t logitBias = 0;
+    put(&logitBias, sizeof(logitBias));
+
+    return blob;
+}
+
+
+/// === whole file as bytes, empty if it can't be read ===
+static std::vector<uint8_t> readFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+
+/// === luma thumbnail of every corpus frame ===
+static void benchPersonThumbnail(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "person_thumbnail";
+
+    uint8_t  thumbnail[PERSON_INPUT_W * PERSON_INPUT_H];
+    uint32_t decoded = 0;
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        benchOp(result, [&]() {
+            decoded += jpegLumaThumbnail(fb->buf, fb->len, thumbnail, PERSON_INPUT_W, PERSON_INPUT_H);
+            return fb->len;
+        });
+        esp_camera_fb_return(fb);
+    }
+
+    if (decoded == 0) {
+        printf("person_thumbnail: no decodable frames, pass --corpus with baseline JPEG captures\n");
+        return;
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === classify one thumbnail ===
+static void benchPersonClassify(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "person_classify";
+
+    /// --- a gradient stands in when the corpus has no decodable frame ---
+    uint8_t thumbnail[PERSON_INPUT_W * PERSON_INPUT_H];
+    for (int i = 0; i < PERSON_INPUT_W * PERSON_INPUT_H; i++) thumbnail[i] = (uint8_t)(i * 255 / (PERSON_INPUT_W * PERSON_INPUT_H));
+    camera_fb_t* fb = esp_camera_fb_get();
+    jpegLumaThumbnail(fb->buf, fb->len, thumbnail, PERSON_INPUT_W, PERSON_INPUT_H);
+    esp_camera_fb_return(fb);
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(result, [&]() {
+            personScore(thumbnail);
+            return sizeof(thumbnail);
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === score labelled captures in <dir>/person & <dir>/empty at personThreshold ===
+static void benchPersonAccuracy(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "person_accuracy";
+
+    uint32_t truePos = 0, falsePos = 0, trueNeg = 0, falseNeg = 0, undecodable = 0;
+
+    for (const char* label : { "person", "empty" }) {
+        std::error_code ec;
+        std::filesystem::path dir = std::filesystem::path(options.labeled.c_str()) / label;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            String ext = entry.path().extension().string().c_str();
+            if (!ext.equalsIgnoreCase(".jpg") && !ext.equalsIgnoreCase(".jpeg")) continue;
+
+            std::vector<uint8_t> jpeg = readFile(entry.path());
+            int score = -1;
+            benchOp(result, [&]() {
+                score = personScoreJpeg(jpeg.data(), jpeg.size());
+                return jpeg.size();
+            });
+
+            bool isPerson = strcmp(label, "person") == 0;
+            if (score < 0)                         undecodable++;
+            else if (score >= personThreshold)     (isPerson ? truePos : falsePos)++;
+            else                                   (isPerson ? falseNeg : trueNeg)++;
+        }
+    }
+
+    benchReport(options, result);
+
+    uint32_t scored = truePos + falsePos + trueNeg + falseNeg;
+    if (scored == 0) {
+        printf("person_accuracy: no labelled captures in %s/{person,empty}\n", options.labeled.c_str());
+        return;
+    }
+
+    double accuracy  = 100.0 * (truePos + trueNeg) / scored;
+    double precision = truePos + falsePos ? 100.0 * truePos / (truePos + falsePos) : 0;
+    double recall    = truePos + falseNeg ? 100.0 * truePos / (truePos + falseNeg) : 0;
+    double gated     = trueNeg + falsePos ? 100.0 * trueNeg / (trueNeg + falsePos) : 0;
+
+    printf("%-28s %6u frames  accuracy %.1f%%  precision %.1f%%  recall %.1f%%  empty frames gated %.1f%%  undecodable %u\n",
+           "person_accuracy", scored, accuracy, precision, recall, gated, undecodable);
+
+    if (options.jsonPath.isEmpty()) return;
+
+    FILE* json = fopen(options.jsonPath.c_str(), "a");
+    if (!json) return;
+    fprintf(json,
+            "{\"label\":\"%s\",\"bench\":\"person_accuracy\",\"frames\":%u,\"threshold\":%d,\"accuracy\":%.2f,"
+            "\"precision\":%.2f,\"recall\":%.2f,\"empty_gated\":%.2f,\"undecodable\":%u}\n",
+            options.label.c_str(), scored, personThreshold, accuracy, precision, recall, gated, undecodable);
+    fclose(json);
+}
+
+
+void benchPerson(const BenchOptions& options) {
+    initCamera();
+
+    /// --- accuracy needs a trained model, speed is measured with random weights otherwise ---
+    std::vector<uint8_t> blob = options.personModel.isEmpty() ? std::vector<uint8_t>() : readFile(options.personModel.c_str());
+    bool trained = !blob.empty() && loadPersonModel(blob.data(), blob.size());
+    if (!options.personModel.isEmpty() && !trained) {
+        printf("person: %s is not a valid model, using random weights\n", options.personModel.c_str());
+    }
+    if (!trained) {
+        blob = randomModel();
+        loadPersonModel(blob.data(), blob.size());
+    }
+
+    if (benchSelected(options, "person_thumbnail"))  benchPersonThumbnail(options);
+    if (benchSelected(options, "person_classify"))   benchPersonClassify(options);
+    if (benchSelected(options, "person_accuracy") && trained && !options.labeled.isEmpty()) benchPersonAccuracy(options);
+}
@@ -0,0 +1,92 @@
+// === sharpness kernel, frame motion score & ring burst against the corpus ===
+#include "bench.h"
+
+#include <esp_camera.h>
+
+#include "settings.h"
+#include "camera.h"
+#include "frame_pool.h"
+#include "burst_capture.h"
+#include "sharpness.h"
+#include "motion_detect.h"
+
+
+/// === score every corpus frame ===
+static void benchJpegSharpness(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "jpeg_sharpness";
+
+    uint32_t scored = 0;
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        benchOp(result, [&]() {
+            scored += jpegSharpness(fb->buf, fb->len) > 0;
+            return fb->len;
+        });
+        esp_camera_fb_return(fb);
+    }
+
+    /// --- synthetic frames are not real JPEGs & only time the header check, so only a --corpus of captures is reported ---
+    if (scored == 0) {
+        printf("jpeg_sharpness: no decodable frames, pass --corpus with baseline JPEG captures\n");
+        return;
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === compare every corpus frame with the one before, as each surveillance frame is ===
+static void benchFrameMotion(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "frame_motion";
+
+    uint32_t scored = 0;
+    resetFrameMotion();
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        benchOp(result, [&]() {
+            scored += frameMotionScore(fb->buf, fb->len) >= 0;
+            return fb->len;
+        });
+        esp_camera_fb_return(fb);
+    }
+
+    if (scored == 0) {
+        printf("frame_motion: no decodable frames, pass --corpus with baseline JPEG captures\n");
+        return;
+    }
+
+    benchReport(options, result);
+}
+
+
+/// === capture, score & release a ring burst ===
+static void benchRingBurst(const BenchOptions& options) {
+    BenchResult result;
+    result.name = "ring_burst";
+
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        Burst burst;
+        benchOp(result, [&]() {
+            size_t bytes = 0;
+            if (captureBurst(burst, ringBurstFrames, ringBurstInterval)) {
+                for (int f = 0; f < burst.count; f++) bytes += burst.frames[f]->len;
+            }
+            releaseBurst(burst, String());
+            return bytes;
+        });
+    }
+
+    benchReport(options, result);
+}
+
+
+void benchSharpness(const BenchOptions& options) {
+    initCamera();
+    initFramePool();
+
+    if (benchSelected(options, "jpeg_sharpness"))   benchJpegSharpness(options);
+    if (benchSelected(options, "frame_motion"))     benchFrameMotion(options);
+    if (benchSelected(options, "ring_burst"))       benchRingBurst(options);
+}
@@ -0,0 +1,62 @@
+// === SD card vs LittleFS hot tier, ring capture & state file sized writes and reads ===
+//
+// Both fakes are host directories, so these track the code path; device latency
+// comes from storageBenchRounds (doorbell/storage/bench) & the flash_* trace spans.
+#include "bench.h"
+
+#include <SD_MMC.h>
+#include <LittleFS.h>
+#include <esp_camera.h>
+
+#include "camera.h"
+#include "hot_tier.h"
+
+
+/// === write then read back buf on one tier ===
+static void benchTier(const BenchOptions& options, fs::FS& fs, const char* name,
+                      const uint8_t* buf, size_t len) {
+    BenchResult write;
+    BenchResult read;
+    write.name = String("storage_") + name + "_write";
+    read.name  = String("storage_") + name + "_read";
+
+    static uint8_t chunk[1024];
+    for (uint32_t i = 0; i < options.iterations; i++) {
+        benchOp(write, [&]() {
+            File file = fs.open("/tier_bench.bin", FILE_WRITE);
+            size_t written = file.write(buf, len);
+            file.close();
+            return written;
+        });
+        benchOp(read, [&]() {
+            File file = fs.open("/tier_bench.bin", FILE_READ);
+            size_t total = 0;
+            size_t n;
+            while ((n = file.read(chunk, sizeof(chunk))) > 0) total += n;
+            file.close();
+            return total;
+        });
+    }
+    fs.remove("/tier_bench.bin");
+
+    benchReport(options, write);
+    benchReport(options, read);
+}
+
+
+void benchStorageTiers(const BenchOptions& options) {
+    benchResetSD();
+    initCamera();
+    initHotTier();
+
+    /// --- a ring capture & an upload-manifest sized state file ---
+    camera_fb_t* fb = esp_camera_fb_get();
+    static const uint8_t state[64] = {};
+
+    if (benchSelected(options, "storage_sd_frame"))     benchTier(options, SD_MMC,   "sd_frame",    fb->buf, fb->len);
+    if (benchSelected(options, "storage_flash_frame"))  benchTier(options, LittleFS, "flash_frame", fb->buf, fb->len);
+    if (benchSelected(options, "storage_sd_state"))     benchTier(options, SD_MMC,   "sd_state",    state, sizeof(state));
+    if (benchSelected(options, "storage_flash_state"))  benchTier(options, LittleFS, "flash_state", state, sizeof(state));
+
+    esp_camera_fb_return(fb);
+}
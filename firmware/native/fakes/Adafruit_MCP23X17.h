@@ -0,0 +1,23 @@
+#pragma once
+// === host fake of the MCP23017 expander, pin levels are plain memory ===
+#include <Wire.h>
+
+class Adafruit_MCP23X17 {
+public:
+    bool    begin_I2C(uint8_t addr = 0x20, TwoWire* wire = &Wire) { return true; }
+    void    pinMode(uint8_t pin, uint8_t mode) {}
+    uint8_t digitalRead(uint8_t pin)                { return pin < 16 ? levels_[pin] : LOW; }
+    void    digitalWrite(uint8_t pin, uint8_t value) { if (pin < 16) levels_[pin] = value; }
+    uint16_t readGPIOAB();
+    void    setupInterrupts(bool mirroring, bool openDrain, uint8_t polarity) {}
+    void    setupInterruptPin(uint8_t pin, uint8_t mode = CHANGE) {}
+    void    disableInterruptPin(uint8_t pin) {}
+    void    clearInterrupts() {}
+    uint8_t getLastInterruptPin()                   { return 255; }
+
+    /// --- drive an input from the host side ---
+    void    fakeSetInput(uint8_t pin, uint8_t value) { digitalWrite(pin, value); }
+
+private:
+    uint8_t levels_[16] = {};
+};
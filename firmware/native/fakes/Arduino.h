@@ -0,0 +1,236 @@
+#pragma once
+// === host fake of the Arduino-ESP32 core, just enough for the firmware modules ===
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+
+using std::min;
+using std::max;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// === attributes ===
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define EXT_RAM_ATTR
+
+// === pin constants ===
+#define HIGH            0x1
+#define LOW             0x0
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+#define INPUT_PULLDOWN  0x09
+#define RISING          0x01
+#define FALLING         0x02
+#define CHANGE          0x03
+
+#define WRITE_PERI_REG(addr, val) ((void)(addr), (void)(val))
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+
+// === String ===
+class String {
+public:
+    String(const char* s = "")              : s_(s ? s : "") {}
+    String(const std::string& s)            : s_(s) {}
+    String(char c)                          : s_(1, c) {}
+    String(int v, unsigned char base = 10);
+    String(unsigned int v, unsigned char base = 10);
+    String(long v, unsigned char base = 10);
+    String(unsigned long v, unsigned char base = 10);
+    String(long long v, unsigned char base = 10);
+    String(unsigned long long v, unsigned char base = 10);
+    String(float v, unsigned int decimals = 2);
+    String(double v, unsigned int decimals = 2);
+
+    unsigned int length() const             { return s_.length(); }
+    const char*  c_str() const              { return s_.c_str(); }
+    bool         isEmpty() const            { return s_.empty(); }
+    void         reserve(unsigned int n)    { s_.reserve(n); }
+
+    char operator[](unsigned int i) const   { return i < s_.size() ? s_[i] : 0; }
+    char charAt(unsigned int i) const       { return (*this)[i]; }
+
+    String& operator+=(const String& o)     { s_ += o.s_; return *this; }
+    String& operator+=(const char* o)       { s_ += o; return *this; }
+    String& operator+=(char c)              { s_ += c; return *this; }
+    bool concat(const String& o)            { s_ += o.s_; return true; }
+    bool concat(const char* o, unsigned n)  { s_.append(o, n); return true; }
+
+    bool operator==(const String& o) const  { return s_ == o.s_; }
+    bool operator==(const char* o) const    { return s_ == o; }
+    bool operator!=(const String& o) const  { return s_ != o.s_; }
+    bool operator!=(const char* o) const    { return s_ != o; }
+    bool operator<(const String& o) const   { return s_ < o.s_; }
+    bool equals(const String& o) const      { return s_ == o.s_; }
+    bool equalsIgnoreCase(const String& o) const {
+        return s_.size() == o.s_.size() &&
+               std::equal(s_.begin(), s_.end(), o.s_.begin(), [](char a, char b) { return tolower(a) == tolower(b); });
+    }
+
+    bool startsWith(const String& p) const  { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+    bool endsWith(const String& p) const;
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& p, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    void replace(const String& from, const String& to);
+
+    long   toInt() const                    { return strtol(s_.c_str(), nullptr, 10); }
+    float  toFloat() const                  { return strtof(s_.c_str(), nullptr); }
+
+    friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+    friend String operator+(const String& a, const char* b)   { return String(a.s_ + b); }
+    friend String operator+(const char* a, const String& b)   { return String(a + b.s_); }
+    friend String operator+(const String& a, char b)          { return String(a.s_ + b); }
+
+private:
+    std::string s_;
+};
+
+
+// === Print & Stream ===
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t len);
+    size_t write(const char* s)             { return write((const uint8_t*)s, strlen(s)); }
+
+    size_t print(const String& s)           { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(const char* s)             { return write(s); }
+    size_t print(char c)                    { return write((uint8_t)c); }
+    size_t print(int v)                     { return print(String(v)); }
+    size_t print(unsigned int v)            { return print(String(v)); }
+    size_t print(long v)                    { return print(String(v)); }
+    size_t print(unsigned long v)           { return print(String(v)); }
+    size_t print(long long v)               { return print(String(v)); }
+    size_t print(unsigned long long v)      { return print(String(v)); }
+    size_t print(double v)                  { return print(String(v)); }
+
+    template <typename T>
+    size_t println(const T& v)              { size_t n = print(v); return n + println(); }
+    size_t println()                        { return write("\r\n"); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+
+    void   setTimeout(unsigned long ms)     { timeout_ = ms; }
+    size_t readBytes(uint8_t* buf, size_t len);
+    String readString();
+    String readStringUntil(char terminator);
+
+protected:
+    /// --- like Stream::timedRead(), waits only while the source can still produce data ---
+    int  timedRead();
+    virtual bool moreExpected()             { return false; }
+
+    unsigned long timeout_ = 1000;
+};
+
+
+// === Serial, discarded unless GB_SERIAL is set in the environment ===
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t len) override;
+    using Print::write;
+    int available() override                { return 0; }
+    int read() override                     { return -1; }
+    int peek() override                     { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+
+// === IPAddress ===
+class IPAddress {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : a_{a, b, c, d} {}
+    String toString() const;
+    operator String() const                 { return toString(); }
+private:
+    uint8_t a_[4];
+};
+
+
+// === ESP ===
+class EspClass {
+public:
+    void     restart();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap()               { return getFreeHeap(); }
+    uint32_t getFreePsram();
+    uint32_t getPsramSize();
+    uint32_t getCpuFreqMHz()                { return 240; }
+    uint64_t getEfuseMac()                  { return 0x5634120D8E24ULL; }
+
+    /// --- restart() is recorded instead of ending the host process ---
+    uint32_t fakeRestarts = 0;
+};
+
+extern EspClass ESP;
+
+
+// === CPU clock, only recorded ===
+bool     setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+
+
+// === time, fake clock: delay() advances virtual time instead of sleeping ===
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void configTime(long gmtOffset, int daylightOffset, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+
+
+// === GPIO ===
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+int  digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+
+// === memory & random ===
+bool  psramFound();
+void* ps_malloc(size_t size);
+long  random(long max);
+long  random(long min, long max);
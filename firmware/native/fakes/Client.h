@@ -0,0 +1,13 @@
+#pragma once
+#include <Arduino.h>
+
+class Client : public Stream {
+public:
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t len) = 0;
+    using Print::write;
+    virtual uint8_t connected() = 0;
+    virtual void stop() = 0;
+    virtual operator bool() = 0;
+};
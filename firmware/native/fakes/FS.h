@@ -0,0 +1,77 @@
+#pragma once
+// === host fake of the Arduino FS layer, files live in a host directory ===
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+namespace fs {
+
+struct FileImpl;
+
+class File : public Stream {
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : impl_(impl) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t len) override;
+    using Print::write;
+    int    available() override;
+    int    read() override;
+    int    peek() override;
+    size_t read(uint8_t* buf, size_t len);
+    void   flush() override;
+
+    bool   seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void   close();
+    operator bool() const;
+
+    const char* name() const;
+    const char* path() const;
+    bool        isDirectory();
+    File        openNextFile(const char* mode = FILE_READ);
+    void        rewindDirectory();
+
+private:
+    std::shared_ptr<FileImpl> impl_;
+};
+
+class FS {
+public:
+    /// --- host directory standing in for the card's mount point ---
+    explicit FS(const char* hostRoot) : root_(hostRoot) {}
+    void setHostRoot(const String& root)    { root_ = root; }
+    String hostRoot() const                 { return root_; }
+
+    /// --- bytes writes may still store before they come up short, -1 for no limit, set by the host ---
+    static long fakeWriteBudget;
+
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path);
+    bool exists(const String& path)         { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path)         { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+    bool mkdir(const char* path);
+    bool mkdir(const String& path)          { return mkdir(path.c_str()); }
+    bool rmdir(const char* path);
+    bool rmdir(const String& path)          { return rmdir(path.c_str()); }
+
+protected:
+    String hostPath(const char* path) const;
+    String root_;
+};
+
+}
+
+using fs::File;
+using fs::FS;
@@ -0,0 +1,25 @@
+#pragma once
+// === host fake of HTTPClient, a plain HTTP/1.1 GET over the fake WiFiClient ===
+#include <WiFiClientSecure.h>
+
+#define HTTP_CODE_OK 200
+
+typedef enum { HTTPC_DISABLE_FOLLOW_REDIRECTS, HTTPC_STRICT_FOLLOW_REDIRECTS, HTTPC_FORCE_FOLLOW_REDIRECTS } followRedirects_t;
+
+class HTTPClient {
+public:
+    bool        begin(WiFiClient& client, const String& url);
+    void        setFollowRedirects(followRedirects_t follow) {}
+    int         GET();
+    String      getString();
+    int         getSize()                           { return size_; }
+    WiFiClient* getStreamPtr()                      { return client_; }
+    void        end();
+
+private:
+    WiFiClient* client_ = nullptr;
+    String      host_;
+    String      path_;
+    uint16_t    port_   = 80;
+    int         size_   = -1;
+};
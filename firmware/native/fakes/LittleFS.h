@@ -0,0 +1,15 @@
+#pragma once
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+public:
+    LittleFSFS() : fs::FS("native_littlefs") {}
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    void end() {}
+    bool format();
+    size_t totalBytes()                     { return 0x170000; }
+    size_t usedBytes();
+};
+
+extern LittleFSFS LittleFS;
@@ -0,0 +1,19 @@
+#pragma once
+// === host fake of Preferences, NVS namespaces kept in memory for the process ===
+#include <Arduino.h>
+
+class Preferences {
+public:
+    bool    begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void    end()                           { name_ = ""; }
+    bool    clear();
+    bool    remove(const char* key);
+    bool    isKey(const char* key);
+    size_t  putInt(const char* key, int32_t value);
+    int32_t getInt(const char* key, int32_t defaultValue = 0);
+    size_t  putUInt(const char* key, uint32_t value);
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+
+private:
+    String name_;
+};
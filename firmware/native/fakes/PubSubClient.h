@@ -0,0 +1,58 @@
+#pragma once
+// === host fake of PubSubClient ===
+// In memory, publishes are counted & handed to an optional hook. When
+// fakeNetwork.target is set, a minimal MQTT 3.1.1 client (QoS 0) talks to a
+// real broker over the given Client.
+#include <Client.h>
+#include <functional>
+#include <string>
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient {
+public:
+    explicit PubSubClient(Client& client) : client_(client) {}
+
+    PubSubClient& setServer(const char* host, uint16_t port)    { host_ = host; port_ = port; return *this; }
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE)          { callback_ = callback; return *this; }
+    PubSubClient& setKeepAlive(uint16_t seconds)                { keepAlive_ = seconds; return *this; }
+    PubSubClient& setSocketTimeout(uint16_t seconds)            { return *this; }
+    bool          setBufferSize(uint16_t size)                  { bufferSize_ = size; return true; }
+    uint16_t      getBufferSize()                               { return bufferSize_; }
+
+    bool connect(const char* id, const char* user, const char* pass);
+    void disconnect();
+    bool connected();
+    int  state()                                                { return connected() ? 0 : -1; }
+    bool loop();
+
+    bool publish(const char* topic, const char* payload, bool retained = false);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int len, bool retained = false);
+    bool beginPublish(const char* topic, unsigned int len, bool retained);
+    size_t write(const uint8_t* buf, size_t len);
+    int  endPublish();
+
+    bool subscribe(const char* topic, uint8_t qos = 0);
+
+    /// --- in-memory broker availability & received messages, controlled by the host ---
+    static bool fakeBrokerUp;
+    std::function<void(const String& topic, const uint8_t* payload, size_t len)> fakeOnPublish;
+    uint32_t fakePublished = 0;
+
+private:
+    bool usingSocket() const;
+    bool sendPacket(uint8_t type, const std::string& body);
+    bool readPacket(uint8_t& type, std::string& body, unsigned long timeoutMs);
+
+    Client&     client_;
+    std::function<void(char*, uint8_t*, unsigned int)> callback_;
+    String      host_;
+    uint16_t    port_          = 1883;
+    uint16_t    keepAlive_     = 15;
+    bool        connected_     = false;
+    uint16_t    bufferSize_    = 256;
+    unsigned long lastOutbound_ = 0;
+    String      pendingTopic_;
+    std::string pending_;
+    bool        pendingRetain_ = false;
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include "FS.h"
+
+typedef enum { CARD_NONE, CARD_MMC, CARD_SD, CARD_SDHC, CARD_UNKNOWN } sdcard_type_t;
+
+class SDMMCFS : public fs::FS {
+public:
+    SDMMCFS() : fs::FS("native_sd") {}
+    bool begin(const char* mountpoint = "/sdcard", bool mode1bit = false, bool formatIfMountFailed = false,
+               int sdmmcFrequency = 20000, uint8_t maxOpenFiles = 5);
+    void end() {}
+    sdcard_type_t cardType()                { return CARD_SDHC; }
+    uint64_t cardSize()                     { return 16ULL << 30; }
+};
+
+extern SDMMCFS SD_MMC;
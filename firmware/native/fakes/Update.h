@@ -0,0 +1,21 @@
+#pragma once
+// === host fake of the OTA updater, firmware images are counted & discarded ===
+#include <Arduino.h>
+
+class UpdateClass {
+public:
+    bool   begin(size_t size)                       { size_ = size; written_ = 0; return size > 0; }
+    size_t writeStream(Stream& data);
+    bool   end(bool evenIfRemaining = false)        { return evenIfRemaining || written_ == size_; }
+    bool   isFinished()                             { return written_ == size_; }
+    void   abort()                                  { size_ = 0; }
+
+    /// --- bytes flashed by the last update ---
+    size_t fakeWritten() const                      { return written_; }
+
+private:
+    size_t size_    = 0;
+    size_t written_ = 0;
+};
+
+extern UpdateClass Update;
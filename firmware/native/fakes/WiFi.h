@@ -0,0 +1,86 @@
+#pragma once
+// === host fake of the WiFi stack, TCP clients talk to an in-memory fake server ===
+#include <Client.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+typedef enum { WL_IDLE_STATUS = 0, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_DISCONNECTED = 6 } wl_status_t;
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+typedef enum { WIFI_PS_NONE, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM } wifi_ps_type_t;
+typedef enum {
+    WIFI_POWER_19_5dBm = 78, WIFI_POWER_19dBm = 76, WIFI_POWER_18_5dBm = 74, WIFI_POWER_17dBm = 68,
+    WIFI_POWER_15dBm   = 60, WIFI_POWER_13dBm = 52, WIFI_POWER_11dBm   = 44, WIFI_POWER_8_5dBm = 34,
+} wifi_power_t;
+
+class WiFiClass {
+public:
+    wl_status_t status()                            { return WL_CONNECTED; }
+    bool        mode(wifi_mode_t m)                 { return true; }
+    wl_status_t begin(const char* ssid, const char* pass) { return WL_CONNECTED; }
+    bool        disconnect(bool wifiOff = false)    { return true; }
+    IPAddress   localIP()                           { return IPAddress(192, 168, 1, 50); }
+    int32_t     RSSI()                              { return -60; }
+    bool        setSleep(bool enable)               { return true; }
+    bool        setSleep(wifi_ps_type_t mode)       { return true; }
+    bool        setTxPower(wifi_power_t power)      { return true; }
+};
+
+extern WiFiClass WiFi;
+
+/// === what the fake server does with a connection ===
+struct FakeNetwork {
+    /// --- fails connect() when false ---
+    bool   accept        = true;
+    /// --- response played back after the request is written ---
+    String response      = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 2\r\n\r\n{}";
+    /// --- totals across all clients, upload workers write concurrently ---
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint32_t> connections{0};
+    /// --- optional hook seeing every byte written, e.g. to parse requests ---
+    std::function<void(const uint8_t*, size_t)> onWrite;
+
+    /// --- when set, clients open real sockets to this host instead (needs FAKE_NET_SOCKETS) ---
+    String target;
+    /// --- "443:8443,1883:18830" style remapping of device ports to stand-in ports ---
+    String portMap;
+};
+
+extern FakeNetwork fakeNetwork;
+
+/// === real TCP/TLS connection used when fakeNetwork.target is set ===
+struct FakeSocket;
+
+std::shared_ptr<FakeSocket> fakeSocketConnect(const char* host, uint16_t port, bool tls);
+size_t  fakeSocketWrite(FakeSocket& socket, const uint8_t* buf, size_t len);
+int     fakeSocketRead(FakeSocket& socket, uint8_t* buf, size_t len);
+int     fakeSocketAvailable(FakeSocket& socket);
+bool    fakeSocketOpen(FakeSocket& socket);
+
+class WiFiClient : public Client {
+public:
+    int     connect(const char* host, uint16_t port) override;
+    int     connect(const char* host, uint16_t port, int32_t timeoutMs) { return connect(host, port); }
+    size_t  write(uint8_t c) override               { return write(&c, 1); }
+    size_t  write(const uint8_t* buf, size_t len) override;
+    using Print::write;
+    int     available() override;
+    int     read() override;
+    int     read(uint8_t* buf, size_t len);
+    int     peek() override;
+    uint8_t connected() override;
+    void    stop() override;
+    operator bool() override                        { return open_; }
+    void    setNoDelay(bool noDelay) {}
+
+protected:
+    /// --- a socket peer may still send, so timed reads keep waiting ---
+    bool    moreExpected() override                 { return socket_ && fakeSocketOpen(*socket_); }
+    virtual bool useTls() const                     { return false; }
+
+    bool   open_ = false;
+    String response_;
+    size_t responsePos_ = 0;
+    int    peeked_ = -1;
+    std::shared_ptr<FakeSocket> socket_;
+};
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+#include <WiFi.h>
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setInsecure() {}
+    void setCACert(const char* rootCA) {}
+    void setHandshakeTimeout(unsigned long seconds) {}
+
+protected:
+    bool useTls() const override { return true; }
+};
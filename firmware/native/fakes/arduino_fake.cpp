@@ -0,0 +1,255 @@
+// === host fake of the Arduino-ESP32 core ===
+#include <Arduino.h>
+#include <stdarg.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <random>
+#include <thread>
+
+
+// === allocation accounting ===
+uint64_t fakeAllocCount = 0;
+uint64_t fakeAllocBytes = 0;
+
+static void* countedMalloc(size_t size) {
+    __atomic_add_fetch(&fakeAllocCount, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&fakeAllocBytes, size, __ATOMIC_RELAXED);
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size)                     { void* p = countedMalloc(size); if (!p) throw std::bad_alloc(); return p; }
+void* operator new[](size_t size)                   { void* p = countedMalloc(size); if (!p) throw std::bad_alloc(); return p; }
+void  operator delete(void* p) noexcept             { free(p); }
+void  operator delete[](void* p) noexcept           { free(p); }
+void  operator delete(void* p, size_t) noexcept     { free(p); }
+void  operator delete[](void* p, size_t) noexcept   { free(p); }
+
+void*  ps_malloc(size_t size)                       { return countedMalloc(size); }
+void*  heap_caps_malloc(size_t size, uint32_t caps) { return countedMalloc(size); }
+void*  heap_caps_calloc(size_t n, size_t size, uint32_t caps) { void* p = countedMalloc(n * size); memset(p, 0, n * size); return p; }
+void   heap_caps_free(void* ptr)                    { free(ptr); }
+size_t heap_caps_get_free_size(uint32_t caps)       { return 4u << 20; }
+size_t heap_caps_get_largest_free_block(uint32_t caps) { return 4u << 20; }
+bool   psramFound()                                 { return true; }
+
+
+// === String ===
+static std::string formatInteger(unsigned long long v, bool negative, unsigned char base) {
+    char buf[72];
+    int i = sizeof(buf) - 1;
+    buf[i] = 0;
+    do {
+        int d = v % base;
+        buf[--i] = d < 10 ? '0' + d : 'a' + d - 10;
+        v /= base;
+    } while (v);
+    if (negative) buf[--i] = '-';
+    return std::string(buf + i);
+}
+
+String::String(int v, unsigned char base)                : s_(formatInteger(v < 0 && base == 10 ? -(long long)v : (unsigned)v, v < 0 && base == 10, base)) {}
+String::String(unsigned int v, unsigned char base)       : s_(formatInteger(v, false, base)) {}
+String::String(long v, unsigned char base)               : s_(formatInteger(v < 0 && base == 10 ? -(long long)v : (unsigned long)v, v < 0 && base == 10, base)) {}
+String::String(unsigned long v, unsigned char base)      : s_(formatInteger(v, false, base)) {}
+String::String(long long v, unsigned char base)          : s_(formatInteger(v < 0 && base == 10 ? -(unsigned long long)v : (unsigned long long)v, v < 0 && base == 10, base)) {}
+String::String(unsigned long long v, unsigned char base) : s_(formatInteger(v, false, base)) {}
+
+String::String(float v, unsigned int decimals) : String((double)v, decimals) {}
+
+String::String(double v, unsigned int decimals) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    s_ = buf;
+}
+
+bool String::endsWith(const String& p) const {
+    return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t i = s_.find(c, from);
+    return i == std::string::npos ? -1 : (int)i;
+}
+
+int String::indexOf(const String& p, unsigned int from) const {
+    size_t i = s_.find(p.s_, from);
+    return i == std::string::npos ? -1 : (int)i;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t i = s_.rfind(c);
+    return i == std::string::npos ? -1 : (int)i;
+}
+
+String String::substring(unsigned int from) const {
+    return from >= s_.size() ? String() : String(s_.substr(from));
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s_.size()) return String();
+    return String(s_.substr(from, std::min<size_t>(to, s_.size()) - from));
+}
+
+void String::trim() {
+    size_t b = s_.find_first_not_of(" \t\r\n");
+    size_t e = s_.find_last_not_of(" \t\r\n");
+    s_ = (b == std::string::npos) ? std::string() : s_.substr(b, e - b + 1);
+}
+
+void String::toLowerCase() { for (auto& c : s_) c = tolower(c); }
+void String::toUpperCase() { for (auto& c : s_) c = toupper(c); }
+
+void String::replace(const String& from, const String& to) {
+    if (from.s_.empty()) return;
+    size_t i = 0;
+    while ((i = s_.find(from.s_, i)) != std::string::npos) {
+        s_.replace(i, from.s_.size(), to.s_);
+        i += to.s_.size();
+    }
+}
+
+
+// === Print & Stream ===
+size_t Print::write(const uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (len--) n += write(*buf++);
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(small)) return write((const uint8_t*)small, len);
+
+    std::string big(len + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&big[0], big.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)big.data(), len);
+}
+
+int Stream::timedRead() {
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        int c = read();
+        if (c >= 0 || !moreExpected()) return c;
+        if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(timeout_)) return -1;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+size_t Stream::readBytes(uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (n < len) {
+        int c = timedRead();
+        if (c < 0) break;
+        buf[n++] = (uint8_t)c;
+    }
+    return n;
+}
+
+String Stream::readString() {
+    std::string s;
+    int c;
+    while ((c = timedRead()) >= 0) s += (char)c;
+    return String(s);
+}
+
+String Stream::readStringUntil(char terminator) {
+    std::string s;
+    int c;
+    while ((c = timedRead()) >= 0 && c != terminator) s += (char)c;
+    return String(s);
+}
+
+
+// === Serial ===
+HardwareSerial Serial;
+
+static bool serialEcho() {
+    static int echo = -1;
+    if (echo < 0) echo = getenv("GB_SERIAL") != nullptr;
+    return echo;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (serialEcho()) fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t len) {
+    if (serialEcho()) fwrite(buf, 1, len, stdout);
+    return len;
+}
+
+
+// === IPAddress & ESP ===
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", a_[0], a_[1], a_[2], a_[3]);
+    return String(buf);
+}
+
+EspClass ESP;
+
+void     EspClass::restart()            { fakeRestarts++; }
+uint32_t EspClass::getFreeHeap()        { return 200 * 1024; }
+uint32_t EspClass::getFreePsram()       { return 4 * 1024 * 1024; }
+uint32_t EspClass::getPsramSize()       { return 4 * 1024 * 1024; }
+
+
+// === CPU clock ===
+static uint32_t cpuMhz = 240;
+
+bool     setCpuFrequencyMhz(uint32_t mhz)   { cpuMhz = mhz; return true; }
+uint32_t getCpuFrequencyMhz()               { return cpuMhz; }
+
+
+// === fake clock ===
+/// --- time skipped by delay(), so waits cost nothing on the host ---
+static std::atomic<int64_t> virtualOffsetUs(0);
+
+static int64_t realMicros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+int64_t       esp_timer_get_time()          { return realMicros() + virtualOffsetUs.load(); }
+unsigned long micros()                      { return (unsigned long)esp_timer_get_time(); }
+unsigned long millis()                      { return (unsigned long)(esp_timer_get_time() / 1000); }
+void          delay(unsigned long ms)       { virtualOffsetUs += (int64_t)ms * 1000; }
+void          delayMicroseconds(unsigned int us) { virtualOffsetUs += us; }
+void          yield() {}
+
+void configTime(long gmtOffset, int daylightOffset, const char* server1, const char* server2, const char* server3) {}
+
+bool getLocalTime(struct tm* info, uint32_t ms) {
+    time_t now = time(nullptr) + virtualOffsetUs.load() / 1000000;
+    localtime_r(&now, info);
+    return true;
+}
+
+
+// === GPIO ===
+static uint8_t gpioLevels[40];
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t val)         { if (pin < 40) gpioLevels[pin] = val; }
+int  digitalRead(uint8_t pin)                       { return pin < 40 ? gpioLevels[pin] : LOW; }
+int  digitalPinToInterrupt(uint8_t pin)             { return pin; }
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {}
+void detachInterrupt(uint8_t pin) {}
+
+
+// === random ===
+static std::mt19937 rng(12345);
+
+uint32_t esp_random()                               { return rng(); }
+long     random(long max)                           { return max > 0 ? rng() % max : 0; }
+long     random(long min, long max)                 { return min >= max ? min : min + (long)(rng() % (max - min)); }
@@ -0,0 +1,109 @@
+// === host fake of esp32-camera ===
+#include <Arduino.h>
+#include <esp_camera.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace stdfs = std::filesystem;
+
+
+/// === frame sizes, same table as the driver ===
+const resolution_info_t resolution[] = {
+    {   96,   96 }, {  160,  120 }, {  176,  144 }, {  240,  176 }, {  240,  240 },
+    {  320,  240 }, {  400,  296 }, {  480,  320 }, {  640,  480 }, {  800,  600 },
+    { 1024,  768 }, { 1280,  720 }, { 1280, 1024 }, { 1600, 1200 },
+};
+
+static std::vector<std::vector<uint8_t>> corpus;
+static size_t                            nextFrame = 0;
+static sensor_t                          sensor;
+
+
+/// === synthetic JPEG: SOI, a high-entropy body & EOI, sized like VGA frames at quality 10 ===
+static std::vector<uint8_t> syntheticJpeg(size_t len) {
+    std::vector<uint8_t> jpeg(len);
+    for (size_t i = 0; i < len; i++) {
+        jpeg[i] = (uint8_t)(esp_random() & 0xFF);
+    }
+    jpeg[0] = 0xFF; jpeg[1] = 0xD8;
+    jpeg[len - 2] = 0xFF; jpeg[len - 1] = 0xD9;
+    return jpeg;
+}
+
+
+size_t fakeCameraLoadCorpus(const char* dir) {
+    corpus.clear();
+    nextFrame = 0;
+
+    std::error_code ec;
+    if (dir != nullptr && stdfs::is_directory(dir, ec)) {
+        std::vector<stdfs::path> files;
+        for (const auto& entry : stdfs::directory_iterator(dir, ec)) {
+            if (entry.path().extension() == ".jpg" || entry.path().extension() == ".jpeg") {
+                files.push_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        for (const auto& file : files) {
+            std::ifstream in(file, std::ios::binary);
+            corpus.emplace_back(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+    }
+
+    if (corpus.empty()) {
+        for (size_t len : { 28000, 31000, 35000, 26000, 40000, 33000, 30000, 37000 }) {
+            corpus.push_back(syntheticJpeg(len));
+        }
+    }
+
+    return corpus.size();
+}
+
+
+static int setFramesize(sensor_t* s, framesize_t framesize) { s->status.framesize = framesize; return 0; }
+static int setQuality(sensor_t* s, int quality)             { s->status.quality = quality; return 0; }
+
+esp_err_t esp_camera_init(const camera_config_t* config) {
+    if (corpus.empty()) {
+        fakeCameraLoadCorpus(getenv("GB_CORPUS"));
+    }
+    sensor.status.framesize = config->frame_size;
+    sensor.status.quality   = config->jpeg_quality;
+    sensor.set_framesize    = setFramesize;
+    sensor.set_quality      = setQuality;
+    return ESP_OK;
+}
+
+esp_err_t esp_camera_deinit() {
+    return ESP_OK;
+}
+
+sensor_t* esp_camera_sensor_get() {
+    return &sensor;
+}
+
+/// === hand out the next corpus frame in a fresh buffer, like the driver's DMA copy ===
+camera_fb_t* esp_camera_fb_get() {
+    if (corpus.empty()) {
+        fakeCameraLoadCorpus(getenv("GB_CORPUS"));
+    }
+    const std::vector<uint8_t>& jpeg = corpus[nextFrame++ % corpus.size()];
+
+    camera_fb_t* fb = new camera_fb_t();
+    fb->buf    = new uint8_t[jpeg.size()];
+    fb->len    = jpeg.size();
+    fb->width  = resolution[sensor.status.framesize < FRAMESIZE_INVALID ? sensor.status.framesize : FRAMESIZE_VGA].width;
+    fb->height = resolution[sensor.status.framesize < FRAMESIZE_INVALID ? sensor.status.framesize : FRAMESIZE_VGA].height;
+    fb->format = PIXFORMAT_JPEG;
+    memcpy(fb->buf, jpeg.data(), jpeg.size());
+    return fb;
+}
+
+void esp_camera_fb_return(camera_fb_t* fb) {
+    if (fb) {
+        delete[] fb->buf;
+        delete fb;
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+// === GPIO wake sources of light sleep, which the host never enters ===
+
+typedef int gpio_num_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL,
+} gpio_int_type_t;
+
+inline int gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) { return 0; }
+inline int gpio_wakeup_disable(gpio_num_t pin)                     { return 0; }
+inline int gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) { return 0; }
@@ -0,0 +1,5 @@
+#pragma once
+#include <stdint.h>
+
+/// --- microseconds on the fake clock ---
+int64_t esp_timer_get_time();
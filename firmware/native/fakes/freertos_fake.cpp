@@ -0,0 +1,179 @@
+// === host fake of FreeRTOS ===
+#include <Arduino.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// === critical sections ===
+static std::recursive_mutex criticalMutex;
+
+void portENTER_CRITICAL(portMUX_TYPE* mux)  { criticalMutex.lock(); }
+void portEXIT_CRITICAL(portMUX_TYPE* mux)   { criticalMutex.unlock(); }
+
+
+// === tasks ===
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    std::thread(fn, param).detach();
+    if (handle) *handle = nullptr;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack,
+                       void* param, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack, param, priority, handle, tskNO_AFFINITY);
+}
+
+/// --- a task deleting itself simply parks its thread ---
+void vTaskDelete(TaskHandle_t handle) {
+    if (handle == nullptr) {
+        while (true) std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+}
+
+/// --- tasks really sleep, otherwise service loops would spin the host CPU ---
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)millis();
+}
+
+/// --- host threads have no fixed stack to measure ---
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t handle) {
+    return 0;
+}
+
+
+// === semaphores ===
+struct FakeSemaphore {
+    std::mutex              m;
+    std::condition_variable cv;
+    UBaseType_t             count;
+    UBaseType_t             max;
+    /// --- recursive mutexes only ---
+    std::thread::id         owner;
+    UBaseType_t             depth = 0;
+};
+
+static bool waitFor(std::unique_lock<std::mutex>& lock, std::condition_variable& cv,
+                    TickType_t ticks, const std::function<bool()>& ready) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    FakeSemaphore* sem = new FakeSemaphore();
+    sem->count = initial;
+    sem->max   = max;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()   { return xSemaphoreCreateCounting(1, 1); }
+SemaphoreHandle_t xSemaphoreCreateBinary()  { return xSemaphoreCreateCounting(1, 0); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(sem->m);
+    if (!waitFor(lock, sem->cv, ticks, [sem] { return sem->count > 0; })) {
+        return pdFALSE;
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    std::lock_guard<std::mutex> lock(sem->m);
+    if (sem->count >= sem->max) {
+        return pdFALSE;
+    }
+    sem->count++;
+    sem->cv.notify_one();
+    return pdTRUE;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return xSemaphoreCreateCounting(1, 1); }
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+    if (sem->depth > 0 && sem->owner == std::this_thread::get_id()) {
+        sem->depth++;
+        return pdTRUE;
+    }
+    if (xSemaphoreTake(sem, ticks) != pdTRUE) {
+        return pdFALSE;
+    }
+    sem->owner = std::this_thread::get_id();
+    sem->depth = 1;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+    if (sem->depth == 0 || sem->owner != std::this_thread::get_id()) {
+        return pdFALSE;
+    }
+    if (--sem->depth > 0) {
+        return pdTRUE;
+    }
+    sem->owner = std::thread::id();
+    return xSemaphoreGive(sem);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    delete sem;
+}
+
+
+// === queues ===
+struct FakeQueue {
+    std::mutex                        m;
+    std::condition_variable           cv;
+    std::deque<std::vector<uint8_t>>  items;
+    UBaseType_t                       length;
+    UBaseType_t                       itemSize;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    FakeQueue* queue = new FakeQueue();
+    queue->length   = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(queue->m);
+    if (!waitFor(lock, queue->cv, ticks, [queue] { return queue->items.size() < queue->length; })) {
+        return pdFALSE;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    queue->cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(queue->m);
+    if (!waitFor(lock, queue->cv, ticks, [queue] { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    queue->cv.notify_all();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->m);
+    return queue->items.size();
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
@@ -0,0 +1,212 @@
+// === host fake of the Arduino FS layer, SD_MMC & LittleFS ===
+#include <SD_MMC.h>
+#include <LittleFS.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace stdfs = std::filesystem;
+
+
+namespace fs {
+
+long FS::fakeWriteBudget = -1;
+
+
+/// === open file or directory on the host ===
+struct FileImpl {
+    std::string              devicePath;
+    std::string              hostPath;
+    std::string              name;
+    FILE*                    fp = nullptr;
+    bool                     isDir = false;
+    std::vector<std::string> entries;
+    size_t                   nextEntry = 0;
+    const FS*                owner = nullptr;
+
+    ~FileImpl() { if (fp) fclose(fp); }
+};
+
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t len) {
+    if (!impl_ || !impl_->fp) return 0;
+
+    /// --- a card failing mid-write stores only part of it ---
+    if (FS::fakeWriteBudget >= 0) {
+        len = std::min(len, (size_t)FS::fakeWriteBudget);
+        FS::fakeWriteBudget -= len;
+    }
+    return fwrite(buf, 1, len, impl_->fp);
+}
+
+int File::available() {
+    if (!impl_ || !impl_->fp) return 0;
+    long remaining = (long)size() - (long)position();
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+int File::read() {
+    return (impl_ && impl_->fp) ? fgetc(impl_->fp) : -1;
+}
+
+int File::peek() {
+    if (!impl_ || !impl_->fp) return -1;
+    int c = fgetc(impl_->fp);
+    if (c >= 0) ungetc(c, impl_->fp);
+    return c;
+}
+
+size_t File::read(uint8_t* buf, size_t len) {
+    return (impl_ && impl_->fp) ? fread(buf, 1, len, impl_->fp) : 0;
+}
+
+void File::flush() {
+    if (impl_ && impl_->fp) fflush(impl_->fp);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    return impl_ && impl_->fp && fseek(impl_->fp, pos, mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END) == 0;
+}
+
+size_t File::position() const {
+    return (impl_ && impl_->fp) ? ftell(impl_->fp) : 0;
+}
+
+size_t File::size() const {
+    if (!impl_ || impl_->isDir) return 0;
+    if (impl_->fp) fflush(impl_->fp);
+    std::error_code ec;
+    auto n = stdfs::file_size(impl_->hostPath, ec);
+    return ec ? 0 : (size_t)n;
+}
+
+void File::close() {
+    impl_.reset();
+}
+
+File::operator bool() const {
+    return impl_ != nullptr;
+}
+
+const char* File::name() const {
+    return impl_ ? impl_->name.c_str() : "";
+}
+
+const char* File::path() const {
+    return impl_ ? impl_->devicePath.c_str() : "";
+}
+
+bool File::isDirectory() {
+    return impl_ && impl_->isDir;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!impl_ || !impl_->isDir) return File();
+    while (impl_->nextEntry < impl_->entries.size()) {
+        std::string child = impl_->devicePath;
+        if (child.empty() || child.back() != '/') child += '/';
+        child += impl_->entries[impl_->nextEntry++];
+        File f = const_cast<FS*>(impl_->owner)->open(child.c_str(), mode);
+        if (f) return f;
+    }
+    return File();
+}
+
+void File::rewindDirectory() {
+    if (impl_) impl_->nextEntry = 0;
+}
+
+
+String FS::hostPath(const char* path) const {
+    return root_ + (path[0] == '/' ? "" : "/") + path;
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+    auto impl = std::make_shared<FileImpl>();
+    impl->devicePath = path;
+    impl->hostPath   = hostPath(path).c_str();
+    impl->name       = stdfs::path(impl->devicePath).filename().string();
+    impl->owner      = this;
+
+    std::error_code ec;
+    if (stdfs::is_directory(impl->hostPath, ec)) {
+        impl->isDir = true;
+        for (const auto& entry : stdfs::directory_iterator(impl->hostPath, ec)) {
+            impl->entries.push_back(entry.path().filename().string());
+        }
+        return File(impl);
+    }
+
+    const char* hostMode = strcmp(mode, FILE_WRITE) == 0 ? "wb" : strcmp(mode, FILE_APPEND) == 0 ? "ab" : "rb";
+    impl->fp = fopen(impl->hostPath.c_str(), hostMode);
+    return impl->fp ? File(impl) : File();
+}
+
+bool FS::exists(const char* path) {
+    std::error_code ec;
+    return stdfs::exists(hostPath(path).c_str(), ec);
+}
+
+bool FS::remove(const char* path) {
+    std::error_code ec;
+    return stdfs::is_regular_file(hostPath(path).c_str(), ec) && stdfs::remove(hostPath(path).c_str(), ec);
+}
+
+bool FS::rename(const char* from, const char* to) {
+    std::error_code ec;
+    stdfs::rename(hostPath(from).c_str(), hostPath(to).c_str(), ec);
+    return !ec;
+}
+
+bool FS::mkdir(const char* path) {
+    std::error_code ec;
+    stdfs::create_directory(hostPath(path).c_str(), ec);
+    return !ec;
+}
+
+bool FS::rmdir(const char* path) {
+    std::error_code ec;
+    return stdfs::is_directory(hostPath(path).c_str(), ec) && stdfs::remove(hostPath(path).c_str(), ec);
+}
+
+}
+
+
+// === SD_MMC ===
+SDMMCFS SD_MMC;
+
+bool SDMMCFS::begin(const char* mountpoint, bool mode1bit, bool formatIfMountFailed, int sdmmcFrequency, uint8_t maxOpenFiles) {
+    std::error_code ec;
+    stdfs::create_directories(root_.c_str(), ec);
+    return !ec;
+}
+
+
+
+// === LittleFS ===
+LittleFSFS LittleFS;
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    std::error_code ec;
+    stdfs::create_directories(root_.c_str(), ec);
+    return !ec;
+}
+
+bool LittleFSFS::format() {
+    std::error_code ec;
+    stdfs::remove_all(root_.c_str(), ec);
+    return begin();
+}
+
+size_t LittleFSFS::usedBytes() {
+    std::error_code ec;
+    size_t used = 0;
+    for (const auto& entry : stdfs::recursive_directory_iterator(root_.c_str(), ec)) {
+        if (entry.is_regular_file(ec)) used += entry.file_size(ec);
+    }
+    return used;
+}
@@ -0,0 +1,84 @@
+// === host fake of HTTPClient & Update ===
+#include <HTTPClient.h>
+#include <Update.h>
+
+
+UpdateClass Update;
+
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+    client_ = &client;
+    size_   = -1;
+
+    int schemeEnd = url.indexOf("://");
+    String rest   = schemeEnd >= 0 ? url.substring(schemeEnd + 3) : url;
+    port_         = url.startsWith("https") ? 443 : 80;
+
+    int slash = rest.indexOf('/');
+    host_     = slash >= 0 ? rest.substring(0, slash) : rest;
+    path_     = slash >= 0 ? rest.substring(slash) : String("/");
+
+    int colon = host_.indexOf(':');
+    if (colon >= 0) {
+        port_ = host_.substring(colon + 1).toInt();
+        host_ = host_.substring(0, colon);
+    }
+    return true;
+}
+
+
+int HTTPClient::GET() {
+    if (!client_->connect(host_.c_str(), port_)) {
+        return -1;
+    }
+
+    client_->print("GET " + path_ + " HTTP/1.1\r\n"
+                   "Host: " + host_ + "\r\n"
+                   "User-Agent: ESP32HTTPClient\r\n"
+                   "Connection: close\r\n\r\n");
+
+    /// --- status line & headers ---
+    String status = client_->readStringUntil('\n');
+    int code = status.substring(status.indexOf(' ') + 1).toInt();
+
+    while (true) {
+        String line = client_->readStringUntil('\n');
+        line.trim();
+        if (line.isEmpty()) break;
+        String lower = line;
+        lower.toLowerCase();
+        if (lower.startsWith("content-length:")) {
+            size_ = line.substring(15).toInt();
+        }
+    }
+
+    return code > 0 ? code : -1;
+}
+
+
+String HTTPClient::getString() {
+    if (size_ < 0) {
+        return client_->readString();
+    }
+
+    std::string body(size_, '\0');
+    size_t n = client_->readBytes((uint8_t*)&body[0], size_);
+    body.resize(n);
+    return String(body);
+}
+
+
+void HTTPClient::end() {
+    if (client_) client_->stop();
+}
+
+
+size_t UpdateClass::writeStream(Stream& data) {
+    uint8_t buf[4096];
+    while (written_ < size_) {
+        size_t n = data.readBytes(buf, std::min(sizeof(buf), size_ - written_));
+        if (n == 0) break;
+        written_ += n;
+    }
+    return written_;
+}
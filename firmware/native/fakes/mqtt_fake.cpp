@@ -0,0 +1,161 @@
+// === host fake of PubSubClient ===
+#include <PubSubClient.h>
+#include <WiFi.h>
+
+
+bool PubSubClient::fakeBrokerUp = false;
+
+
+bool PubSubClient::usingSocket() const {
+    return !fakeNetwork.target.isEmpty();
+}
+
+
+// === MQTT framing ===
+static std::string encodeString(const char* s) {
+    size_t len = strlen(s);
+    return std::string{ (char)(len >> 8), (char)(len & 0xFF) } + s;
+}
+
+static std::string encodeLength(size_t len) {
+    std::string out;
+    do {
+        uint8_t digit = len % 128;
+        len /= 128;
+        out += (char)(len > 0 ? digit | 0x80 : digit);
+    } while (len > 0);
+    return out;
+}
+
+bool PubSubClient::sendPacket(uint8_t type, const std::string& body) {
+    std::string packet = (char)type + encodeLength(body.size()) + body;
+    lastOutbound_ = millis();
+    return client_.write((const uint8_t*)packet.data(), packet.size()) == packet.size();
+}
+
+bool PubSubClient::readPacket(uint8_t& type, std::string& body, unsigned long timeoutMs) {
+    client_.setTimeout(timeoutMs);
+
+    uint8_t header;
+    if (client_.readBytes(&header, 1) != 1) return false;
+    type = header;
+
+    size_t len = 0, shift = 0;
+    uint8_t digit;
+    do {
+        if (client_.readBytes(&digit, 1) != 1) return false;
+        len |= (size_t)(digit & 0x7F) << shift;
+        shift += 7;
+    } while (digit & 0x80);
+
+    body.assign(len, '\0');
+    return len == 0 || client_.readBytes((uint8_t*)&body[0], len) == len;
+}
+
+
+// === session ===
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+    if (!usingSocket()) {
+        connected_ = fakeBrokerUp;
+        return connected_;
+    }
+
+    connected_ = false;
+    if (!client_.connect(host_.c_str(), port_)) return false;
+
+    uint8_t flags = 0x02 | (user ? 0x80 : 0) | (pass ? 0x40 : 0);
+    std::string body = encodeString("MQTT") + (char)4 + (char)flags +
+                       (char)(keepAlive_ >> 8) + (char)(keepAlive_ & 0xFF) + encodeString(id);
+    if (user) body += encodeString(user);
+    if (pass) body += encodeString(pass);
+
+    uint8_t type;
+    std::string ack;
+    connected_ = sendPacket(0x10, body) && readPacket(type, ack, 3000) &&
+                 type == 0x20 && ack.size() == 2 && ack[1] == 0;
+    if (!connected_) client_.stop();
+    return connected_;
+}
+
+void PubSubClient::disconnect() {
+    if (usingSocket() && connected_) {
+        sendPacket(0xE0, "");
+        client_.stop();
+    }
+    connected_ = false;
+}
+
+bool PubSubClient::connected() {
+    if (!usingSocket()) return connected_ && fakeBrokerUp;
+    if (connected_ && !client_.connected()) connected_ = false;
+    return connected_;
+}
+
+bool PubSubClient::loop() {
+    if (!connected()) return false;
+    if (!usingSocket()) return true;
+
+    /// --- keep alive ---
+    if (millis() - lastOutbound_ > keepAlive_ * 1000UL / 2) {
+        sendPacket(0xC0, "");
+    }
+
+    /// --- deliver incoming publishes, drop acks & ping responses ---
+    while (client_.available() > 0) {
+        uint8_t type;
+        std::string body;
+        if (!readPacket(type, body, 1000)) break;
+        if ((type & 0xF0) == 0x30 && callback_ && body.size() >= 2) {
+            size_t topicLen = ((uint8_t)body[0] << 8) | (uint8_t)body[1];
+            std::string topic = body.substr(2, topicLen);
+            std::string payload = body.substr(2 + topicLen);
+            callback_(&topic[0], (uint8_t*)&payload[0], payload.size());
+        }
+    }
+    return connected();
+}
+
+bool PubSubClient::subscribe(const char* topic, uint8_t qos) {
+    if (!connected()) return false;
+    if (!usingSocket()) return true;
+
+    static uint16_t packetId = 1;
+    packetId++;
+    std::string body = std::string{ (char)(packetId >> 8), (char)(packetId & 0xFF) } + encodeString(topic) + (char)0;
+    return sendPacket(0x82, body);
+}
+
+
+// === publishing ===
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+    return publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int len, bool retained) {
+    if (!connected() || strlen(topic) + len + 7 > bufferSize_) return false;
+    return beginPublish(topic, len, retained) && write(payload, len) == len && endPublish();
+}
+
+bool PubSubClient::beginPublish(const char* topic, unsigned int len, bool retained) {
+    if (!connected()) return false;
+    pendingTopic_  = topic;
+    pendingRetain_ = retained;
+    pending_.clear();
+    pending_.reserve(len);
+    return true;
+}
+
+size_t PubSubClient::write(const uint8_t* buf, size_t len) {
+    pending_.append((const char*)buf, len);
+    return len;
+}
+
+int PubSubClient::endPublish() {
+    fakePublished++;
+    if (fakeOnPublish) {
+        fakeOnPublish(pendingTopic_, (const uint8_t*)pending_.data(), pending_.size());
+    }
+    if (!usingSocket()) return 1;
+
+    return sendPacket(pendingRetain_ ? 0x31 : 0x30, encodeString(pendingTopic_.c_str()) + pending_) ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+// === host fake of WiFi, TCP clients, sleep & the MCP23017 ===
+#include <WiFi.h>
+#include <Wire.h>
+#include <Adafruit_MCP23X17.h>
+#include <esp_sleep.h>
+
+
+WiFiClass   WiFi;
+TwoWire     Wire;
+FakeNetwork fakeNetwork;
+
+
+// === WiFiClient, connections reach one in-memory server or a real stand-in ===
+/// --- apply fakeNetwork.portMap to a device port ---
+static uint16_t mapPort(uint16_t port) {
+    String map = fakeNetwork.portMap + ",";
+    int from = 0, comma;
+    while ((comma = map.indexOf(',', from)) >= 0) {
+        String pair = map.substring(from, comma);
+        int colon = pair.indexOf(':');
+        if (colon > 0 && pair.substring(0, colon).toInt() == port) {
+            return pair.substring(colon + 1).toInt();
+        }
+        from = comma + 1;
+    }
+    return port;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    stop();
+    peeked_ = -1;
+
+    if (!fakeNetwork.target.isEmpty()) {
+        socket_ = fakeSocketConnect(fakeNetwork.target.c_str(), mapPort(port), useTls());
+        open_   = socket_ != nullptr;
+    }
+    else {
+        open_        = fakeNetwork.accept;
+        response_    = fakeNetwork.response;
+        responsePos_ = 0;
+    }
+
+    if (open_) fakeNetwork.connections++;
+    return open_;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t len) {
+    if (!open_) return 0;
+    if (socket_) len = fakeSocketWrite(*socket_, buf, len);
+    fakeNetwork.bytesSent += len;
+    if (fakeNetwork.onWrite) fakeNetwork.onWrite(buf, len);
+    return len;
+}
+
+int WiFiClient::available() {
+    if (!open_) return 0;
+    if (socket_) return fakeSocketAvailable(*socket_) + (peeked_ >= 0 ? 1 : 0);
+    return (int)(response_.length() - responsePos_);
+}
+
+int WiFiClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t len) {
+    if (!open_ || len == 0) return -1;
+
+    size_t n = 0;
+    if (peeked_ >= 0) {
+        buf[n++] = (uint8_t)peeked_;
+        peeked_ = -1;
+    }
+
+    if (socket_) {
+        int got = fakeSocketRead(*socket_, buf + n, len - n);
+        if (got > 0) n += got;
+    }
+    else {
+        size_t m = std::min(len - n, response_.length() - responsePos_);
+        memcpy(buf + n, response_.c_str() + responsePos_, m);
+        responsePos_ += m;
+        n += m;
+    }
+
+    return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::peek() {
+    if (peeked_ < 0) peeked_ = read();
+    return peeked_;
+}
+
+/// --- an in-memory server closes once its response has been read ---
+uint8_t WiFiClient::connected() {
+    if (!open_) return false;
+    if (socket_) return fakeSocketOpen(*socket_) || available() > 0;
+    return available() > 0;
+}
+
+void WiFiClient::stop() {
+    open_ = false;
+    socket_.reset();
+}
+
+
+// === sleep ===
+int esp_sleep_enable_timer_wakeup(uint64_t us)      { return 0; }
+int esp_sleep_enable_gpio_wakeup()                  { return 0; }
+int esp_sleep_disable_wakeup_source(esp_sleep_source_t source) { return 0; }
+int esp_light_sleep_start()                         { return 0; }
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return ESP_SLEEP_WAKEUP_UNDEFINED; }
+
+
+// === MCP23017 ===
+uint16_t Adafruit_MCP23X17::readGPIOAB() {
+    uint16_t value = 0;
+    for (int pin = 0; pin < 16; pin++) {
+        value |= (levels_[pin] ? 1 : 0) << pin;
+    }
+    return value;
+}
@@ -0,0 +1,49 @@
+// === host fake of Preferences ===
+#include <Preferences.h>
+#include <map>
+#include <string>
+
+
+/// --- namespace -> key -> value, shared by every Preferences instance ---
+static std::map<std::string, std::map<std::string, int64_t>> fakeNvs;
+
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+    name_ = name;
+    return true;
+}
+
+bool Preferences::clear() {
+    fakeNvs[name_.c_str()].clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    return fakeNvs[name_.c_str()].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    return fakeNvs[name_.c_str()].count(key) > 0;
+}
+
+size_t Preferences::putInt(const char* key, int32_t value) {
+    fakeNvs[name_.c_str()][key] = value;
+    return sizeof(value);
+}
+
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+    auto& ns = fakeNvs[name_.c_str()];
+    auto it = ns.find(key);
+    return it == ns.end() ? defaultValue : (int32_t)it->second;
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+    fakeNvs[name_.c_str()][key] = value;
+    return sizeof(value);
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+    auto& ns = fakeNvs[name_.c_str()];
+    auto it = ns.find(key);
+    return it == ns.end() ? defaultValue : (uint32_t)it->second;
+}
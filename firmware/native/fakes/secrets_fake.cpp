@@ -0,0 +1,20 @@
+// === placeholder credentials for the native build ===
+#include "secrets.h"
+
+const char* OTA_VERSION_URL          = "https://localhost/version.txt";
+const char* OTA_UPDATE_NOTES_URL     = "https://localhost/update_notes.txt";
+const char* OTA_FIRMWARE_URL         = "https://localhost/firmware.bin";
+const char* WIFI_SSID                = "native";
+const char* WIFI_PASS                = "native";
+const char* MQTT_HOST                = "127.0.0.1";
+const int   MQTT_PORT                = 1883;
+const char* MQTT_USER                = "native";
+const char* MQTT_PASS                = "native";
+const char* TELEGRAM_BOT_TOKEN       = "000000:NATIVE";
+const char* TELEGRAM_CHAT_ID         = "0";
+const char* CLOUDINARY_CLOUD_NAME    = "native";
+const char* CLOUDINARY_UPLOAD_PRESET = "native";
+const char* INGEST_HOST              = "";
+const int   INGEST_PORT              = 7070;
+const char* INGEST_TOKEN             = "native";
+const char* STREAM_TOKEN             = "native";
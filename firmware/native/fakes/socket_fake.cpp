@@ -0,0 +1,150 @@
+// === real TCP/TLS sockets for the network harness ([env:native_net]) ===
+#include <WiFi.h>
+
+#ifdef FAKE_NET_SOCKETS
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <vector>
+
+
+struct FakeSocket {
+    int                  fd     = -1;
+    SSL*                 ssl    = nullptr;
+    bool                 closed = false;
+    std::vector<uint8_t> rx;
+    size_t               rxPos  = 0;
+
+    ~FakeSocket() {
+        if (ssl) { SSL_shutdown(ssl); SSL_free(ssl); }
+        if (fd >= 0) close(fd);
+    }
+};
+
+
+/// === one TLS context, certificates are not verified just like setInsecure() ===
+static SSL_CTX* tlsContext() {
+    static SSL_CTX* ctx = nullptr;
+    if (ctx == nullptr) {
+        ctx = SSL_CTX_new(TLS_client_method());
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
+    }
+    return ctx;
+}
+
+
+std::shared_ptr<FakeSocket> fakeSocketConnect(const char* host, uint16_t port, bool tls) {
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, String(port).c_str(), &hints, &res) != 0) {
+        return nullptr;
+    }
+
+    auto socket = std::make_shared<FakeSocket>();
+    socket->fd = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    bool ok = socket->fd >= 0 && ::connect(socket->fd, res->ai_addr, res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if (!ok) {
+        return nullptr;
+    }
+
+    int one = 1;
+    setsockopt(socket->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if (tls) {
+        socket->ssl = SSL_new(tlsContext());
+        SSL_set_fd(socket->ssl, socket->fd);
+        SSL_set_tlsext_host_name(socket->ssl, host);
+        if (SSL_connect(socket->ssl) != 1) {
+            return nullptr;
+        }
+    }
+
+    return socket;
+}
+
+
+size_t fakeSocketWrite(FakeSocket& socket, const uint8_t* buf, size_t len) {
+    size_t sent = 0;
+    while (sent < len && !socket.closed) {
+        int n = socket.ssl ? SSL_write(socket.ssl, buf + sent, len - sent)
+                           : (int)send(socket.fd, buf + sent, len - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            socket.closed = true;
+            break;
+        }
+        sent += n;
+    }
+    return sent;
+}
+
+
+/// === pull whatever has arrived into the receive buffer without blocking ===
+static void fill(FakeSocket& socket) {
+    if (socket.closed || socket.rxPos < socket.rx.size()) return;
+
+    socket.rx.clear();
+    socket.rxPos = 0;
+
+    while (true) {
+        bool pending = socket.ssl && SSL_pending(socket.ssl) > 0;
+        pollfd pfd = { socket.fd, POLLIN, 0 };
+        if (!pending && poll(&pfd, 1, 0) <= 0) return;
+
+        uint8_t chunk[4096];
+        int n = socket.ssl ? SSL_read(socket.ssl, chunk, sizeof(chunk))
+                           : (int)recv(socket.fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            if (socket.ssl && SSL_get_error(socket.ssl, n) == SSL_ERROR_WANT_READ) return;
+            socket.closed = true;
+            return;
+        }
+        socket.rx.insert(socket.rx.end(), chunk, chunk + n);
+    }
+}
+
+
+int fakeSocketAvailable(FakeSocket& socket) {
+    fill(socket);
+    return socket.rx.size() - socket.rxPos;
+}
+
+
+int fakeSocketRead(FakeSocket& socket, uint8_t* buf, size_t len) {
+    size_t n = std::min(len, (size_t)fakeSocketAvailable(socket));
+    memcpy(buf, socket.rx.data() + socket.rxPos, n);
+    socket.rxPos += n;
+    return n;
+}
+
+
+bool fakeSocketOpen(FakeSocket& socket) {
+    fill(socket);
+    return !socket.closed;
+}
+
+#else
+
+/// === in-memory only build, real sockets need [env:native_net] ===
+struct FakeSocket {};
+
+std::shared_ptr<FakeSocket> fakeSocketConnect(const char* host, uint16_t port, bool tls) {
+    fprintf(stderr, "fakeNetwork.target needs a build with FAKE_NET_SOCKETS\n");
+    return nullptr;
+}
+
+size_t fakeSocketWrite(FakeSocket& socket, const uint8_t* buf, size_t len)  { return 0; }
+int    fakeSocketRead(FakeSocket& socket, uint8_t* buf, size_t len)         { return 0; }
+int    fakeSocketAvailable(FakeSocket& socket)                             { return 0; }
+bool   fakeSocketOpen(FakeSocket& socket)                                  { return false; }
+
+#endif
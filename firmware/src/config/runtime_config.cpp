@@ -0,0 +1,305 @@
+// === standard headers ===
+// --- NVS key-value storage ---
+#include <Preferences.h>
+
+// --- ESP32-CAM frame sizes ---
+#include <esp_camera.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "runtime_config.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- hardware ---
+#include "camera.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- utilities ---
+#include "debug.h"
+
+
+// === configuration table ===
+/// --- how a value is parsed & which global it lives in ---
+enum ConfigType : uint8_t {
+    CONFIG_INT,
+    CONFIG_ULONG,
+    CONFIG_FRAMESIZE,
+};
+
+/// --- one tunable setting, the key doubles as NVS key (max 15 chars) & topic suffix ---
+struct ConfigEntry {
+    const char* key;
+    ConfigType  type;
+    void*       value;
+    int32_t     min;
+    int32_t     max;
+};
+
+static const ConfigEntry entries[] = {
+    { "surveillance_ms", CONFIG_ULONG,     &surveillancePeriod,     1000,          300000        },
+    { "surveil_max_ms",  CONFIG_ULONG,     &surveillanceMaxPeriod,  1000,          600000        },
+    { "standby_ms",      CONFIG_ULONG,     &allowedStandbyDuration, 5000,          3600000       },
+    { "detections",      CONFIG_INT,       &acceptableDetections,   1,             1000          },
+    { "upload_start",    CONFIG_INT,       &UPLOAD_START_HOUR,      0,             23            },
+    { "upload_end",      CONFIG_INT,       &UPLOAD_END_HOUR,        0,             23            },
+    { "frame_size",      CONFIG_FRAMESIZE, &cameraFrameSize,        FRAMESIZE_QVGA, FRAMESIZE_UXGA },
+    { "jpeg_quality",    CONFIG_INT,       &cameraJpegQuality,      4,             63            },
+    { "ring_frame_size", CONFIG_FRAMESIZE, &ringFrameSize,          FRAMESIZE_QVGA, FRAMESIZE_UXGA },
+    { "ring_quality",    CONFIG_INT,       &ringJpegQuality,        4,             63            },
+    { "person_score",    CONFIG_INT,       &personThreshold,        1,             100           },
+};
+
+const int CONFIG_ENTRIES = sizeof(entries) / sizeof(entries[0]);
+
+/// --- frame size names accepted on the command topic ---
+static const char* frameSizeNames[] = {
+    "96X96", "QQVGA", "QCIF", "HQVGA", "240X240", "QVGA", "CIF", "HVGA",
+    "VGA", "SVGA", "XGA", "HD", "SXGA", "UXGA",
+};
+
+
+// === staged changes ===
+/// --- validated by the MQTT task, applied by the main loop between actions ---
+static int32_t staged[CONFIG_ENTRIES];
+static bool    pending[CONFIG_ENTRIES];
+
+static portMUX_TYPE configMux = portMUX_INITIALIZER_UNLOCKED;
+
+/// --- NVS namespace of persisted overrides ---
+static Preferences prefs;
+
+/// --- NVS namespace of the last reset handled, out of reach of prefs.clear() ---
+static Preferences handled;
+
+/// --- hash of the last command handled per entry, reset last, so retained commands redelivered on every connect are skipped ---
+RTC_DATA_ATTR static uint32_t lastCommand[CONFIG_ENTRIES + 1];
+
+
+/// === FNV-1a hash of a command payload, never 0 so a fresh slot matches nothing ===
+static uint32_t hashCommand(const String& value) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < value.length(); i++) {
+        hash = (hash ^ (uint8_t)value[i]) * 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+
+/// === check a command was handled before & remember it, queries are always answered ===
+static bool repeatedCommand(int slot, const String& value) {
+    if (value.length() == 0) {
+        return false;
+    }
+    uint32_t hash = hashCommand(value);
+    if (lastCommand[slot] == hash) {
+        return true;
+    }
+    lastCommand[slot] = hash;
+    return false;
+}
+
+
+/// === current value of an entry ===
+static int32_t readEntry(const ConfigEntry& entry) {
+    if (entry.type == CONFIG_ULONG) {
+        return (int32_t)*(unsigned long*)entry.value;
+    }
+    return *(int*)entry.value;
+}
+
+
+/// === set the global of an entry ===
+static void writeEntry(const ConfigEntry& entry, int32_t value) {
+    if (entry.type == CONFIG_ULONG) {
+        *(unsigned long*)entry.value = (unsigned long)value;
+    }
+    else {
+        *(int*)entry.value = value;
+    }
+}
+
+
+/// === value as shown in acknowledgements ===
+static String formatEntry(const ConfigEntry& entry, int32_t value) {
+    if (entry.type == CONFIG_FRAMESIZE) {
+        return String("\"") + frameSizeNames[value] + "\"";
+    }
+    return String(value);
+}
+
+
+/// === parse a command payload, false if it isn't a whole number or known frame size ===
+static bool parseEntry(const ConfigEntry& entry, const String& text, int32_t& value) {
+    if (entry.type == CONFIG_FRAMESIZE) {
+        for (int i = 0; i < (int)(sizeof(frameSizeNames) / sizeof(frameSizeNames[0])); i++) {
+            if (text.equalsIgnoreCase(frameSizeNames[i])) {
+                value = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    char* end = nullptr;
+    long parsed = strtol(text.c_str(), &end, 10);
+    if (text.length() == 0 || *end != '\0') {
+        return false;
+    }
+    value = (int32_t)parsed;
+    return true;
+}
+
+
+/// === entry of a key, nullptr if unknown ===
+static int findEntry(const char* key) {
+    for (int i = 0; i < CONFIG_ENTRIES; i++) {
+        if (strcmp(entries[i].key, key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+/// === value an entry will have once staged changes are applied ===
+static int32_t effectiveValue(int index) {
+    return pending[index] ? staged[index] : readEntry(entries[index]);
+}
+
+
+/// === report the outcome of a command ===
+static void acknowledge(const char* key, const String& value, const char* status) {
+    publishMQTT(CONFIG_ACK_TOPIC,
+        String("{\"key\":\"") + key + "\",\"value\":" + value + ",\"status\":\"" + status + "\"}");
+}
+
+
+/// === load overrides persisted in NVS, before anything reads the settings ===
+void initRuntimeConfig() {
+    /// --- a reset survives power loss, so it doesn't wipe the overrides again on every cold boot ---
+    if (handled.begin("config_cmd", false)) {
+        lastCommand[CONFIG_ENTRIES] = handled.getUInt("reset", 0);
+    }
+
+    if (!prefs.begin("config", false)) {
+        DBG_PRINTLN("Failed to open NVS config, using defaults");
+        return;
+    }
+
+    for (int i = 0; i < CONFIG_ENTRIES; i++) {
+        const ConfigEntry& entry = entries[i];
+        if (!prefs.isKey(entry.key)) {
+            continue;
+        }
+
+        /// --- drop overrides outside the current limits, e.g. after a firmware update ---
+        int32_t value = prefs.getInt(entry.key, readEntry(entry));
+        if (value < entry.min || value > entry.max) {
+            prefs.remove(entry.key);
+            continue;
+        }
+
+        writeEntry(entry, value);
+        DBG_PRINTLN("Config " + String(entry.key) + " = " + String(value));
+    }
+}
+
+
+/// === validate, persist & stage one command, an empty value reports the current one ===
+void handleConfigCommand(const char* key, const String& value) {
+    /// --- forget every persisted override, defaults return on the next wake; per-key commands stay handled, so retained ones don't undo it ---
+    if (strcmp(key, "reset") == 0) {
+        if (repeatedCommand(CONFIG_ENTRIES, value)) {
+            return;
+        }
+        handled.putUInt("reset", lastCommand[CONFIG_ENTRIES]);
+        prefs.clear();
+        acknowledge(key, "null", "next_wake");
+        return;
+    }
+
+    int index = findEntry(key);
+    if (index < 0) {
+        acknowledge(key, "null", "unknown");
+        return;
+    }
+    const ConfigEntry& entry = entries[index];
+
+    /// --- the same payload again is a retained command redelivered on connect, it was handled already ---
+    if (repeatedCommand(index, value)) {
+        return;
+    }
+
+    portENTER_CRITICAL(&configMux);
+    int32_t current = effectiveValue(index);
+    portEXIT_CRITICAL(&configMux);
+
+    if (value.length() == 0) {
+        acknowledge(key, formatEntry(entry, current), "current");
+        return;
+    }
+
+    int32_t parsed;
+    if (!parseEntry(entry, value, parsed) || parsed < entry.min || parsed > entry.max) {
+        acknowledge(key, formatEntry(entry, current), "invalid");
+        return;
+    }
+
+    /// --- an empty upload window would never drain the SD card ---
+    int start = findEntry("upload_start");
+    int end   = findEntry("upload_end");
+    if ((index == start && parsed == effectiveValue(end)) ||
+        (index == end && parsed == effectiveValue(start))) {
+        acknowledge(key, formatEntry(entry, current), "invalid");
+        return;
+    }
+
+    /// --- a value already persisted, e.g. a retained command after a power loss, needs no write or acknowledgement ---
+    if (parsed == current && prefs.isKey(entry.key) && prefs.getInt(entry.key) == parsed) {
+        return;
+    }
+
+    prefs.putInt(entry.key, parsed);
+
+    portENTER_CRITICAL(&configMux);
+    staged[index]  = parsed;
+    pending[index] = true;
+    portEXIT_CRITICAL(&configMux);
+
+    acknowledge(key, formatEntry(entry, parsed), "staged");
+}
+
+
+/// === apply staged changes, called by the main loop between actions ===
+void applyRuntimeConfig() {
+    bool camera = false;
+
+    portENTER_CRITICAL(&configMux);
+    bool changed[CONFIG_ENTRIES];
+    for (int i = 0; i < CONFIG_ENTRIES; i++) {
+        changed[i] = pending[i];
+        if (pending[i]) {
+            writeEntry(entries[i], staged[i]);
+            pending[i] = false;
+            camera |= entries[i].value == &cameraFrameSize || entries[i].value == &cameraJpegQuality ||
+                      entries[i].value == &ringFrameSize   || entries[i].value == &ringJpegQuality;
+        }
+    }
+    portEXIT_CRITICAL(&configMux);
+
+    /// --- a larger frame size than at boot needs new frame buffers, so it waits for the next wake ---
+    bool live = !camera || applyCameraSettings();
+
+    for (int i = 0; i < CONFIG_ENTRIES; i++) {
+        if (!changed[i]) {
+            continue;
+        }
+        bool deferred = !live && (entries[i].value == &cameraFrameSize || entries[i].value == &ringFrameSize);
+        acknowledge(entries[i].key, formatEntry(entries[i], readEntry(entries[i])), deferred ? "next_wake" : "applied");
+    }
+}
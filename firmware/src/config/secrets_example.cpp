@@ -51,3 +51,18 @@ const char* TELEGRAM_CHAT_ID_EXAMPLE    = "YOUR_CHAT_ID";
 const char* CLOUDINARY_CLOUD_NAME_EXAMPLE       = "YOUR_CLOUD_NAME";
 const char* CLOUDINARY_UPLOAD_PRESET_EXAMPLE    = "YOUR_UPLOAD_PRESET";
 
+
+// === LAN ingest gateway (tools/ingest_gateway) ===
+/// --- gateway host (home assistant), empty uploads straight to cloudinary ---
+const char* INGEST_HOST_EXAMPLE = "";
+
+/// --- gateway port ---
+const int   INGEST_PORT_EXAMPLE = 7070;
+
+/// --- shared token, the same as the gateway's --token, up to 32 characters ---
+const char* INGEST_TOKEN_EXAMPLE = "YOUR_INGEST_TOKEN";
+
+
+// === MJPEG live stream ===
+/// --- token clients present as ?token= or "Authorization: Bearer", empty disables the stream ---
+const char* STREAM_TOKEN_EXAMPLE = "YOUR_STREAM_TOKEN";
\ No newline at end of file
@@ -1,63 +1,68 @@
+// === standard headers ===
+// --- ESP32-CAM frame sizes ---
+#include <esp_camera.h>
+
+
 // === project headers ===
 // --- corresponding header ---
 #include "settings.h"
 
 
+// Compile-time settings are constexpr in settings.h, only strings & values
+// tunable at runtime are defined here.
+
+
 /// === firmware version ===
 const String FW_VERSION = "v1.0.0-beta.3.2";
 
 
-/// === acceptable number of motion detections in one boot ===
-const int acceptableDetections = 20;
+/// === acceptable number of recent motion detections, tunable over MQTT ===
+int acceptableDetections = 20;
 
 
-// === time settings ===
-/// --- ntp server url ---
-const char* ntpServer = "uk.pool.ntp.org";
+// === camera profiles, tunable over MQTT ===
+/// --- surveillance & stream frame size (framesize_t), larger sizes than at boot apply from the next wake ---
+int cameraFrameSize   = FRAMESIZE_VGA;
 
-/// --- offset from gmt in hours ---
-const long  gmtOffset_sec = 0;
+/// --- surveillance & stream JPEG quality, 0-63 & lower is better ---
+int cameraJpegQuality = 12;
 
-/// --- offset for daylight saving in seconds ---
-const int  daylightOffset_sec = 3600;
+/// --- ring frame size, large enough to identify a face at the door ---
+int ringFrameSize     = FRAMESIZE_SXGA;
 
+/// --- ring JPEG quality ---
+int ringJpegQuality   = 8;
 
-/// === filename of image captured at latest doorbell ring ===
-const String lastRingCaptureFilename = "latest_ring_capture";
 
+/// === minimum person score (0-100) that keeps a surveillance burst going, tunable over MQTT ===
+int personThreshold = 60;
 
-// === telegram ===
-/// --- telegram host url ---
-const char* telegramHost = "api.telegram.org";
 
-/// --- caption sent to telegram with latest ring capture ---
-String captionText = "🔔 Someone's at the door!";
+/// === filename of image captured at latest doorbell ring ===
+const String lastRingCaptureFilename = "latest_ring_capture";
 
 
-/// === cloudinary host url ===
-const char* cloudinaryHost = "api.cloudinary.com";
+/// === caption sent to telegram with latest ring capture ===
+String captionText = "🔔 Someone's at the door!";
 
 
-// === time window to commence upload ===
+// === time window to commence upload, tunable over MQTT ===
 /// --- start hour of upload window ---
-const int UPLOAD_START_HOUR = 1;
+int UPLOAD_START_HOUR = 1;
 /// --- end hour of upload window ---
-const int UPLOAD_END_HOUR   = 4;
+int UPLOAD_END_HOUR   = 4;
 
 
 /// === to check if any images left to upload on SD card ===
 bool imagesLeftToUpload = true;
 
 
-// === time variables ===
-/// --- allowed suveillance duration ---
-const unsigned long surveillancePeriod      = 15000;
+// === time variables, tunable over MQTT ===
+/// --- shortest surveillance, extended while motion continues ---
+unsigned long surveillancePeriod     = 15000;
 
-/// --- time allowed to warm up PIR sensor ---
-const unsigned long warmUpPeriod            = 20000;
+/// --- longest surveillance ---
+unsigned long surveillanceMaxPeriod  = 120000;
 
 /// --- allowed standby duration ---
-const unsigned long allowedStandbyDuration  = 60000;
-
-/// --- minimum time to pass since last ring ---
-const unsigned long timeSinceLastRing       = 2000;
\ No newline at end of file
+unsigned long allowedStandbyDuration = 60000;
\ No newline at end of file
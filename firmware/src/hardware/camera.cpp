@@ -8,11 +8,54 @@
 #include "camera.h"
 
 // --- configuration ---
+#include "settings.h"
 #include "pins.h"
 
 // --- utilities ---
 #include "debug.h"
 #include "error.h"
+#include "trace.h"
+
+
+// Rings & surveillance want different frames: a visitor's face needs a large,
+// high quality frame, surveillance wants small ones at a high frame rate. The
+// driver is initialised once at the larger of the two profiles, so its frame
+// buffers fit either, and a switch only rewrites the sensor's output size &
+// JPEG quality. Frames queued before a switch still have the old size & are
+// skipped; each switch is traced from the first register write to the first
+// frame at the new size.
+
+
+/// === frame size the driver's buffers were allocated for ===
+static framesize_t bootFrameSize = FRAMESIZE_INVALID;
+
+/// === profile the sensor is currently set to ===
+static CameraProfile activeProfile = CAMERA_PROFILE_SURVEILLANCE;
+
+
+/// === frame size of a profile, as tuned ===
+int cameraProfileFrameSize(CameraProfile profile) {
+    return profile == CAMERA_PROFILE_RING ? ringFrameSize : cameraFrameSize;
+}
+
+
+/// === JPEG quality of a profile, as tuned ===
+int cameraProfileQuality(CameraProfile profile) {
+    return profile == CAMERA_PROFILE_RING ? ringJpegQuality : cameraJpegQuality;
+}
+
+
+/// === frame size the driver's buffers hold, the largest profile at boot ===
+int cameraBufferFrameSize() {
+    return bootFrameSize;
+}
+
+
+/// === write a profile to the sensor, sizes above the buffers are clamped until the next wake ===
+static void writeProfile(sensor_t* sensor, CameraProfile profile) {
+    sensor->set_framesize(sensor, (framesize_t)min(cameraProfileFrameSize(profile), (int)bootFrameSize));
+    sensor->set_quality(sensor, cameraProfileQuality(profile));
+}
 
 
 /// === initialise camera ===
@@ -41,14 +84,88 @@ void initCamera() {
     config.pin_reset        = RESET_GPIO_NUM;
     config.xclk_freq_hz     = 20000000;
     config.pixel_format     = PIXFORMAT_JPEG;
-    config.frame_size       = FRAMESIZE_VGA;
-    config.jpeg_quality     = 10;
-    config.fb_count         = 1;
+    /// --- buffers sized for the larger profile, the sensor is switched to surveillance below ---
+    config.frame_size       = (framesize_t)max(cameraFrameSize, ringFrameSize);
+    config.jpeg_quality     = min(cameraJpegQuality, ringJpegQuality);
+
+    /// --- double buffer in PSRAM so the driver fills one frame while the other is copied into the pool ---
+    if (psramFound()) {
+        config.fb_count     = CAMERA_FB_COUNT;
+        config.fb_location  = CAMERA_FB_IN_PSRAM;
+        config.grab_mode    = CAMERA_GRAB_LATEST;
+    }
+    else {
+        config.fb_count     = 1;
+        config.fb_location  = CAMERA_FB_IN_DRAM;
+        config.grab_mode    = CAMERA_GRAB_WHEN_EMPTY;
+    }
 
     if (esp_camera_init(&config) != ESP_OK) {
         error("Failed to initialise camera", true);
     }
     else {
+        bootFrameSize = config.frame_size;
+
+        /// --- SD & WiFi start before the first capture, frames at the boot size are gone by then ---
+        activeProfile = CAMERA_PROFILE_SURVEILLANCE;
+        writeProfile(esp_camera_sensor_get(), activeProfile);
+
         DBG_PRINTLN("Camera initialised");
     }
+}
+
+
+/// === switch the sensor to a profile, returns once frames come at its size ===
+bool setCameraProfile(CameraProfile profile) {
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor == nullptr) {
+        return false;
+    }
+    if (profile == activeProfile) {
+        return true;
+    }
+
+    uint32_t switchTrace = traceBegin();
+
+    writeProfile(sensor, profile);
+    activeProfile = profile;
+
+    /// --- frames queued before the switch have the old size, at most one per buffer plus the one in flight ---
+    const resolution_info_t& size = resolution[sensor->status.framesize];
+    bool settled = false;
+    for (int i = 0; i <= CAMERA_FB_COUNT && !settled; i++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) {
+            break;
+        }
+        settled = fb->width == size.width && fb->height == size.height;
+        esp_camera_fb_return(fb);
+    }
+
+    traceEnd(TRACE_CAMERA_SWITCH, switchTrace);
+
+    if (!settled) {
+        error("Camera profile switch didn't settle", false);
+    }
+    return settled;
+}
+
+
+/// === profile the sensor is currently set to ===
+CameraProfile cameraProfile() {
+    return activeProfile;
+}
+
+
+/// === apply tuned profiles to the running sensor, false if a frame size must wait for the next boot ===
+bool applyCameraSettings() {
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor == nullptr) {
+        return false;
+    }
+
+    writeProfile(sensor, activeProfile);
+
+    /// --- frame buffers & the frame pool are sized at boot, only smaller frames fit ---
+    return max(cameraFrameSize, ringFrameSize) <= bootFrameSize;
 }
\ No newline at end of file
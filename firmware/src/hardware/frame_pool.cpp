@@ -0,0 +1,260 @@
+// === standard headers ===
+// --- ESP32-CAM driver ---
+#include <esp_camera.h>
+
+// --- PSRAM allocation ---
+#include <esp_heap_caps.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "frame_pool.h"
+
+// --- hardware ---
+#include "camera.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "error.h"
+
+
+// === pool storage ===
+/// --- total number of slots across all size classes ---
+const int FRAME_POOL_SIZE = FRAME_POOL_SLOTS[0] + FRAME_POOL_SLOTS[1] + FRAME_POOL_SLOTS[2];
+
+static PooledFrame slots[FRAME_POOL_SIZE];
+
+/// --- head of each size class' free list, -1 when empty ---
+static int16_t freeHead[FRAME_POOL_BUCKETS];
+
+static FramePoolStats bucketStats[FRAME_POOL_BUCKETS];
+
+static bool poolReady = false;
+
+/// --- without PSRAM a frame borrows the single camera buffer instead ---
+static PooledFrame borrowedFrame;
+
+/// --- sequence number of the next captured frame ---
+static uint32_t nextFrameSeq = 1;
+
+/// --- guards free lists, reference counts & statistics ---
+static portMUX_TYPE poolMux = portMUX_INITIALIZER_UNLOCKED;
+
+
+/// === expected JPEG size at a frame size & quality ===
+static size_t expectedJpegSize(size_t pixels, int quality) {
+    /// --- roughly 1.5 bytes per (quality + 2) pixels on typical doorstep scenes ---
+    return pixels * 3 / (2 * (quality + 2));
+}
+
+
+/// === allocate every slot up front so frame memory never fragments PSRAM ===
+bool initFramePool() {
+    if (poolReady) {
+        return true;
+    }
+
+    if (!psramFound()) {
+        error("No PSRAM, frames borrow the camera buffer", false);
+        return false;
+    }
+
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor == nullptr) {
+        error("Frame pool needs an initialised camera", false);
+        return false;
+    }
+
+    /// --- the driver never produces a JPEG larger than its receive buffer, width * height / 5 ---
+    const resolution_info_t& buffer = resolution[cameraBufferFrameSize()];
+    size_t largest = (size_t)buffer.width * buffer.height / 5;
+
+    /// --- expected JPEG of each camera profile, frame sizes above the buffers are clamped ---
+    size_t expected[2];
+    for (CameraProfile profile : { CAMERA_PROFILE_SURVEILLANCE, CAMERA_PROFILE_RING }) {
+        const resolution_info_t& size = resolution[min(cameraProfileFrameSize(profile), cameraBufferFrameSize())];
+        expected[profile] = min(expectedJpegSize((size_t)size.width * size.height, cameraProfileQuality(profile)), largest);
+    }
+    size_t capacity[FRAME_POOL_BUCKETS] = { min(expected[0], expected[1]), max(expected[0], expected[1]), largest };
+
+    int slot = 0;
+    for (int bucket = 0; bucket < FRAME_POOL_BUCKETS; bucket++) {
+        /// --- round to 1 KB so slots stay aligned ---
+        capacity[bucket] = (capacity[bucket] + 1023) & ~(size_t)1023;
+
+        uint8_t* block = (uint8_t*)heap_caps_malloc(capacity[bucket] * FRAME_POOL_SLOTS[bucket], MALLOC_CAP_SPIRAM);
+        if (block == nullptr) {
+            error("Failed to allocate frame pool", false);
+            return false;
+        }
+
+        bucketStats[bucket] = { capacity[bucket], (uint8_t)FRAME_POOL_SLOTS[bucket], 0, 0, 0, 0, 0 };
+        freeHead[bucket] = -1;
+
+        for (int i = 0; i < FRAME_POOL_SLOTS[bucket]; i++, slot++) {
+            slots[slot] = { block + i * capacity[bucket], 0, capacity[bucket], 0, 0, 0, 0, 0, (int8_t)bucket, freeHead[bucket], nullptr };
+            freeHead[bucket] = slot;
+        }
+    }
+
+    poolReady = true;
+
+    DBG_PRINTLN("Frame pool: " + String(capacity[0]) + " / " + String(capacity[1]) + " / " + String(capacity[2]) + " byte slots");
+    return true;
+}
+
+
+/// === take a free slot of the smallest size class that fits, spilling into larger ones ===
+PooledFrame* acquireFrame(size_t len) {
+    if (!poolReady) {
+        return nullptr;
+    }
+
+    /// --- size class the frame belongs to, oversized frames count against the largest ---
+    int home = 0;
+    while (home < FRAME_POOL_BUCKETS - 1 && len > bucketStats[home].capacity) {
+        home++;
+    }
+
+    PooledFrame* frame = nullptr;
+
+    portENTER_CRITICAL(&poolMux);
+    bucketStats[home].acquired++;
+
+    for (int bucket = home; bucket < FRAME_POOL_BUCKETS && len <= bucketStats[home].capacity; bucket++) {
+        if (freeHead[bucket] < 0) {
+            continue;
+        }
+
+        frame = &slots[freeHead[bucket]];
+        freeHead[bucket] = frame->nextFree;
+        frame->refs = 1;
+        frame->len  = 0;
+
+        FramePoolStats& stats = bucketStats[bucket];
+        stats.inUse++;
+        stats.highWater = max(stats.highWater, stats.inUse);
+        if (bucket != home) {
+            stats.spilled++;
+        }
+        break;
+    }
+
+    if (frame == nullptr) {
+        bucketStats[home].exhausted++;
+    }
+    portEXIT_CRITICAL(&poolMux);
+
+    return frame;
+}
+
+
+/// === capture a JPEG into the pool, the camera buffer is handed back immediately ===
+PooledFrame* captureFrame() {
+    camera_fb_t* fb = esp_camera_fb_get();
+    if (!fb) {
+        return nullptr;
+    }
+
+    /// --- without a pool the frame keeps the camera buffer until released ---
+    if (!poolReady) {
+        portENTER_CRITICAL(&poolMux);
+        bool busy = borrowedFrame.refs > 0;
+        if (!busy) {
+            borrowedFrame = { fb->buf, fb->len, fb->len, (uint16_t)fb->width, (uint16_t)fb->height,
+                              nextFrameSeq++, millis(), 1, -1, -1, fb };
+        }
+        portEXIT_CRITICAL(&poolMux);
+
+        if (busy) {
+            esp_camera_fb_return(fb);
+            return nullptr;
+        }
+        return &borrowedFrame;
+    }
+
+    PooledFrame* frame = acquireFrame(fb->len);
+    if (frame != nullptr) {
+        memcpy(frame->buf, fb->buf, fb->len);
+        frame->len        = fb->len;
+        frame->width      = fb->width;
+        frame->height     = fb->height;
+        frame->capturedAt = millis();
+
+        portENTER_CRITICAL(&poolMux);
+        frame->seq = nextFrameSeq++;
+        portEXIT_CRITICAL(&poolMux);
+    }
+
+    esp_camera_fb_return(fb);
+    return frame;
+}
+
+
+/// === add a holder to a frame ===
+void retainFrame(PooledFrame* frame) {
+    portENTER_CRITICAL(&poolMux);
+    frame->refs++;
+    portEXIT_CRITICAL(&poolMux);
+}
+
+
+/// === drop a holder, the last one returns the slot to its free list ===
+void releaseFrame(PooledFrame* frame) {
+    if (frame == nullptr) {
+        return;
+    }
+
+    void* borrowedFb = nullptr;
+
+    portENTER_CRITICAL(&poolMux);
+    if (--frame->refs == 0) {
+        if (frame->bucket < 0) {
+            borrowedFb = frame->borrowedFb;
+            frame->borrowedFb = nullptr;
+        }
+        else {
+            int16_t slot = frame - slots;
+            frame->nextFree = freeHead[frame->bucket];
+            freeHead[frame->bucket] = slot;
+            bucketStats[frame->bucket].inUse--;
+        }
+    }
+    portEXIT_CRITICAL(&poolMux);
+
+    if (borrowedFb != nullptr) {
+        esp_camera_fb_return((camera_fb_t*)borrowedFb);
+    }
+}
+
+
+/// === copy statistics of a size class ===
+bool getFramePoolStats(int bucket, FramePoolStats& stats) {
+    if (!poolReady || bucket < 0 || bucket >= FRAME_POOL_BUCKETS) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&poolMux);
+    stats = bucketStats[bucket];
+    portEXIT_CRITICAL(&poolMux);
+
+    return true;
+}
+
+
+/// === publish per size class high-water marks & misses ===
+void publishFramePoolStats() {
+    FramePoolStats stats;
+    for (int bucket = 0; getFramePoolStats(bucket, stats); bucket++) {
+        publishMQTT("doorbell/framepool/stats",
+            "{\"bucket\":" + String(bucket) +
+            ",\"size\":" + String(stats.capacity) +
+            ",\"slots\":" + String(stats.slots) +
+            ",\"high\":" + String(stats.highWater) +
+            ",\"spilled\":" + String(stats.spilled) +
+            ",\"exhausted\":" + String(stats.exhausted) + "}");
+    }
+}
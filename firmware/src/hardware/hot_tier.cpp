@@ -0,0 +1,122 @@
+// === standard headers ===
+// --- SD card access via SD_MMC interface ---
+#include <SD_MMC.h>
+
+// --- LittleFS on the internal flash ---
+#include <LittleFS.h>
+
+// --- microsecond timer ---
+#include <esp_timer.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "hot_tier.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "error.h"
+
+
+/// === set once the spiffs partition is mounted as LittleFS ===
+static bool hotTierReady = false;
+
+
+/// === mount the spiffs partition as LittleFS, formatting it on first use ===
+void initHotTier() {
+    DBG_PRINTLN("Mounting LittleFS hot tier...");
+
+    /// --- every hot file falls back to the SD card if the partition can't be used ---
+    if (!LittleFS.begin(true, HOT_TIER_MOUNT, 5, "spiffs")) {
+        error("Failed to mount LittleFS, hot files stay on SD card", false);
+        return;
+    }
+
+    hotTierReady = true;
+    DBG_PRINTLN("LittleFS mounted, " + String((uint32_t)LittleFS.usedBytes()) + "/" +
+                String((uint32_t)LittleFS.totalBytes()) + " bytes used");
+}
+
+
+/// === check if the hot tier is on the internal flash ===
+bool hotTierMounted() {
+    return hotTierReady;
+}
+
+
+/// === filesystem for small, frequently rewritten files ===
+fs::FS& hotFS() {
+    if (hotTierReady) {
+        return LittleFS;
+    }
+    return SD_MMC;
+}
+
+
+/// === filesystem holding the capture saved under filename ===
+fs::FS& storageFor(const String& filename) {
+    /// --- only the latest ring capture is hot, bulk surveillance frames go to SD ---
+    if (filename == lastRingCaptureFilename) {
+        return hotFS();
+    }
+    return SD_MMC;
+}
+
+
+/// === time rounds of whole-file writes & reads of buf on one filesystem ===
+static void benchmarkTier(fs::FS& fs, const char* tier, const uint8_t* buf, size_t len, int rounds) {
+    static const char* path = "/tier_bench.bin";
+    static uint8_t chunk[1024];
+
+    int64_t writeUs = 0;
+    int64_t readUs  = 0;
+
+    for (int i = 0; i < rounds; i++) {
+        /// --- open, write & close, as saveFrame() does ---
+        int64_t begin = esp_timer_get_time();
+        File file = fs.open(path, FILE_WRITE);
+        if (!file) {
+            error(String("Storage benchmark failed to open ") + tier, false);
+            return;
+        }
+        file.write(buf, len);
+        file.close();
+        writeUs += esp_timer_get_time() - begin;
+
+        /// --- read back in the chunk size the uploaders use ---
+        begin = esp_timer_get_time();
+        file = fs.open(path, FILE_READ);
+        while (file && file.read(chunk, sizeof(chunk)) > 0) {
+        }
+        file.close();
+        readUs += esp_timer_get_time() - begin;
+    }
+
+    fs.remove(path);
+
+    publishMQTT("doorbell/storage/bench",
+        String("{\"tier\":\"") + tier + "\"" +
+        ",\"bytes\":" + String((uint32_t)len) +
+        ",\"write_us\":" + String((uint32_t)(writeUs / rounds)) +
+        ",\"read_us\":" + String((uint32_t)(readUs / rounds)) + "}");
+}
+
+
+/// === compare SD card & hot tier latency for a file of len bytes ===
+void benchmarkStorageTiers(const uint8_t* buf, size_t len, int rounds) {
+    if (rounds <= 0) {
+        return;
+    }
+
+    benchmarkTier(SD_MMC, "sd", buf, len, rounds);
+
+    if (hotTierReady) {
+        benchmarkTier(LittleFS, "flash", buf, len, rounds);
+    }
+}
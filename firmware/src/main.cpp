@@ -46,30 +46,47 @@
 // --- configuration ---
 #include "settings.h"
 #include "pins.h"
+#include "runtime_config.h"
 
 // --- hardware ---
 #include "camera.h"
+#include "frame_pool.h"
 #include "mcp23017.h"
 #include "microSD_card.h"
+#include "hot_tier.h"
 
 // --- network ---
 #include "wifi.h"
 #include "mqtt.h"
+#include "stream_server.h"
 
 // --- services ---
 #include "telegram.h"
 #include "cloudinary.h"
 #include "ota.h"
+#include "fleet.h"
  
 // --- utilities ---
 #include "debug.h"
 #include "error.h"
+#include "notify.h"
 #include "time_util.h"
 #include "security_alarm.h"
 #include "warmup_pir.h"
+#include "activity.h"
+#include "journal.h"
+#include "idle.h"
+#include "power_profile.h"
 #include "capture_save_image.h"
+#include "burst_capture.h"
 #include "button_interrupt.h"
 #include "wipe_sd_card.h"
+#include "upload_sd_card.h"
+#include "upload_scheduler.h"
+#include "capture_session.h"
+#include "person_detect.h"
+#include "motion_detect.h"
+#include "trace.h"
 
 
 // === global variables with default values set ===
@@ -82,15 +99,6 @@ unsigned long lastActionTime    = 0;
 /// --- time at end of last ring ---
 unsigned long lastRingTime      = 0;
 
-/// --- number of motion detections ---
-int motionDectctionCount = 0;
-
-/// --- to check if warned once ---
-bool warnedOnce = false;
-
-/// --- to check if warned twice ---
-bool warnedTwice = false;
-
 
 /// === ring if doorbell rung ===
 void ringIfRung() {
@@ -125,15 +133,42 @@ void ringIfRung() {
         if (millis() - lastRingTime > timeSinceLastRing) {
             DBG_PRINTLN("Bell rung!");
 
-            /// --- capture & save image as last ring capture ---
-            captureAndSaveImage(lastRingCaptureFilename);
+            /// --- full speed & the radio always on for the ring capture & its Telegram send ---
+            PowerPhase previousPhase = enterPowerPhase(POWER_NOTIFY);
+
+            /// --- large, high quality frames to identify the visitor ---
+            setCameraProfile(CAMERA_PROFILE_RING);
+
+            /// --- capture a burst, the visitor is often still moving toward the camera ---
+            Burst burst;
+            if (captureBurst(burst, ringBurstFrames, ringBurstInterval)) {
+                /// --- save the sharpest frame as last ring capture & publish it to the local broker ---
+                saveFrame(burst.frames[burst.best], lastRingCaptureFilename, "ring");
+            }
+            else {
+                captureAndSaveImage(lastRingCaptureFilename, "ring");
+            }
+
+            /// --- back to fast frames, a ring often comes mid surveillance ---
+            setCameraProfile(CAMERA_PROFILE_SURVEILLANCE);
             
-            /// --- connect to MQTT & notify MQTT that doorbell was rung ---
-            ensureMQTT();
-            mqtt.publish("doorbell/ring", "pressed");
+            /// --- queue ring event for MQTT, delivered by the MQTT task ---
+            publishMQTT("doorbell/ring", "pressed");
+            journal(JOURNAL_RING, burst.count);
 
             /// --- send this image to telegram ---
-            sendImageToTelegram(captionText);
+            if constexpr (featureTelegram) {
+                sendImageToTelegram(captionText);
+            }
+
+            /// --- keep the rest of the burst for upload or drop it ---
+            if (ringBurstArchive && burst.count > 1) {
+                imagesLeftToUpload = true;
+            }
+            releaseBurst(burst, ringBurstArchive ? getCurrentDateTime() : String());
+
+            /// --- back to the phase the ring came in ---
+            enterPowerPhase(previousPhase);
 
             /// --- reset last ring endtime & last action endtime to current time ---
             lastRingTime = millis();
@@ -144,84 +179,145 @@ void ringIfRung() {
 }
 
 
-/// === activate surveillance routine ===
-void activateSurveillance() {
-
-    /// --- time at start of surveillance ---
-    unsigned long  startMs = millis();
+/// === capture a few seconds of the scene & send them to telegram as one album ===
+void warnSuspiciousActivity(const String& caption) {
+    /// --- without telegram the warning only goes to the local broker ---
+    if constexpr (!featureTelegram) {
+        publishMQTT("doorbell/alert", caption);
+        return;
+    }
 
-    /// --- surveil for surveillance period ---
-    while (millis() - startMs <= surveillancePeriod) {
-        mcp.digitalWrite(RED_LED_PIN, HIGH);
+    PowerPhase previousPhase = enterPowerPhase(POWER_NOTIFY);
 
-        /// --- capture & save image to SD card every second ---
-        captureAndSaveImage(getCurrentDateTime());
-        mcp.digitalWrite(RED_LED_PIN, LOW);
+    Burst burst;
+    if (!captureBurst(burst, suspiciousAlbumFrames, suspiciousAlbumInterval)) {
+        error("Capture failed", false);
+        enterPowerPhase(previousPhase);
+        return;
+    }
 
-        /// --- check if rung ---
-        ringIfRung();
+    /// --- the sharpest frame leads the album, the rest follow in capture order ---
+    TelegramMedia media[BURST_MAX_FRAMES];
+    int count = 0;
+    media[count++] = { String(), burst.frames[burst.best]->buf, burst.frames[burst.best]->len };
+    for (int i = 0; i < burst.count; i++) {
+        if (i != burst.best) {
+            media[count++] = { String(), burst.frames[i]->buf, burst.frames[i]->len };
+        }
     }
 
-    /// --- reset last action endtime to current time ---
-    lastActionTime = millis();
-}
+    sendMediaGroupToTelegram(media, count, caption);
 
+    releaseBurst(burst, String());
+    enterPowerPhase(previousPhase);
+}
 
-/// === upload & delete all images (JPEG files) from SD card ===
-bool uploadAndDeleteAll() {
 
-    /// --- open SD root directory ---
-    File root = SD_MMC.open("/");
-    if (!root || !root.isDirectory()) {
-        DBG_PRINTLN("ERROR: SD root open failed");
-        lastActionTime = millis();
-        return true;
-    }
+/// === activate surveillance routine while motion continues, false if nobody was seen & it ended early ===
+bool activateSurveillance() {
 
-    /// --- open next available file in root ---
-    File file = root.openNextFile();
+    /// --- full speed for JPEG saves & the person classifier ---
+    PowerPhase previousPhase = enterPowerPhase(POWER_SURVEILLANCE);
 
-    /// --- loop through files ---
-    while (file) {
-        delay(100);
+    /// --- time at start of surveillance ---
+    unsigned long  startMs = millis();
 
-        /// --- skip folders, non-JPEGs & the last ring capture ---
-        String filename = file.name();
-        if (file.isDirectory() || !filename.endsWith(".jpg") || filename == "IMG_" + lastRingCaptureFilename + ".jpg") {
-            file = root.openNextFile();
-            continue;
+    /// --- every surveillance burst is a session, uploaded & deleted as a whole ---
+    beginSession();
+
+    /// --- without a model every motion is treated as a person ---
+    bool person  = !personModelLoaded();
+    int  best    = -1;
+    int  checked = 0;
+
+    /// --- motion started the burst, it lasts while the PIR or the frames keep seeing it ---
+    bool          moving       = true;
+    unsigned long lastMotionMs = startMs;
+    int           frames       = 0;
+    int           movingFrames = 0;
+    const char*   endedBy      = "quiet";
+    resetFrameMotion();
+
+    /// --- surveil for at least the surveillance period, then until quiet for the hold-off, at most the maximum ---
+    while (true) {
+        unsigned long elapsed = millis() - startMs;
+        if (elapsed > max(surveillancePeriod, surveillanceMaxPeriod)) {
+            endedBy = "max";
+            break;
+        }
+        if (elapsed > surveillancePeriod && millis() - lastMotionMs >= surveillanceHoldOff) {
+            break;
         }
 
-        /// --- upload JPEG file to cloudinary ---
-        bool ok = uploadImageToCloudinary(file, filename);
+        mcp.digitalWrite(RED_LED_PIN, HIGH);
 
-        /// --- delete file if upload ok ---
-        if (ok) {
-            DBG_PRINTLN("Upload OK deleting " + filename + " from SD card");
-            SD_MMC.remove("/" + filename);
+        /// --- capture & save image to SD card every second & publish it to the local broker ---
+        int score  = -1;
+        int change = -1;
+        bool saved = captureAndSaveImage(getCurrentDateTime(), "surveillance", person ? nullptr : &score, &change);
+        mcp.digitalWrite(RED_LED_PIN, LOW);
+        if (saved) {
+            frames++;
         }
-        else {
-            DBG_PRINTLN("Upload failed, stopping uploads");
-            lastActionTime = millis();
-            return true;
+
+        /// --- hysteresis: motion starts above motionOnScore & ends below motionOffScore, the PIR counts as motion ---
+        if (mcp.digitalRead(PIR_PIN) == HIGH || change >= motionOnScore) {
+            moving = true;
+        }
+        else if (change >= 0 && change < motionOffScore) {
+            moving = false;
+        }
+        if (moving) {
+            lastMotionMs = millis();
+            movingFrames++;
         }
 
-        /// --- stop if motion detected ---
-        if (mcp.digitalRead(PIR_PIN) == HIGH) {
-            DBG_PRINTLN("Motion detected, stopping uploads");
-            lastActionTime = millis();
-            return true;
+        /// --- classify the opening frames, a frame that can't be scored keeps the burst going, a skipped one is ignored ---
+        if (!person && saved) {
+            checked++;
+            best = max(best, score);
+
+            if (score < 0 || score >= personThreshold) {
+                person = true;
+            }
+            /// --- cats, cars & sunlight: end the burst early ---
+            else if (millis() - startMs >= personGatePeriod) {
+                DBG_PRINTLN("Nobody there, ending surveillance");
+                endedBy = "nobody";
+                break;
+            }
         }
 
-        /// --- open next available file in root ---
-        file = root.openNextFile();
-        delay(100);
+        /// --- check if rung ---
+        ringIfRung();
     }
 
-    /// --- reset last action endtime to current time & finish uploading ---
-    DBG_PRINTLN("No images left to upload");
+    unsigned long durationMs = millis() - startMs;
+
+    /// --- report how the burst was gated ---
+    if (checked > 0) {
+        publishMQTT("doorbell/motion",
+            "{\"person\":" + String(person ? "true" : "false") +
+            ",\"score\":" + String(best) +
+            ",\"checked\":" + String(checked) +
+            ",\"ms\":" + String(durationMs) + "}");
+    }
+    journal(JOURNAL_MOTION, checked > 0 ? person : 2, best < 0 ? 0xFFFF : best, durationMs);
+
+    /// --- report the length of the event, its frames & what ended it ---
+    publishMQTT("doorbell/surveillance",
+        "{\"ms\":" + String(durationMs) +
+        ",\"frames\":" + String(frames) +
+        ",\"moving\":" + String(movingFrames) +
+        ",\"extended_ms\":" + String(durationMs > surveillancePeriod ? durationMs - surveillancePeriod : 0) +
+        ",\"end\":\"" + endedBy + "\"}");
+
+    enterPowerPhase(previousPhase);
+
+    /// --- reset last action endtime to current time ---
     lastActionTime = millis();
-    return false;
+
+    return person;
 }
 
 
@@ -234,9 +330,15 @@ void setup() {
 
     /// --- record time at start of boot ---
     unsigned long boot_startTime = millis(); 
+    uint32_t bootTrace = traceBegin();
+
+    /// --- start a new wake in the trace buffer ---
+    initTrace();
 
     /// --- initialise MCP23017 as GPIO expander ---
+    uint32_t phaseTrace = traceBegin();
     initMCP();
+    traceEnd(TRACE_INIT_MCP, phaseTrace);
 
     /// --- if serial debugging begin debug serial & set button pinmode on the MCP23017 ---
     #if SERIAL_DEBUG
@@ -251,15 +353,54 @@ void setup() {
         attachInterrupt(digitalPinToInterrupt(BTN_ESP_PIN), handleButtonInterrupt, FALLING);
     #endif
 
+    /// --- load settings tuned over MQTT, the camera reads its frame size & quality ---
+    initRuntimeConfig();
+
     /// --- initialise camera and micro SD card ---
+    phaseTrace = traceBegin();
     initCamera();
+    traceEnd(TRACE_INIT_CAMERA, phaseTrace);
+
+    /// --- reserve PSRAM for every frame held after capture ---
+    initFramePool();
+
+    phaseTrace = traceBegin();
     initMicroSD();
+    traceEnd(TRACE_INIT_SD, phaseTrace);
+
+    /// --- mount the spiffs partition for the latest ring capture & upload manifest ---
+    initHotTier();
+
+    /// --- captures of this wake go to a session directory of their own ---
+    initSessions();
+
+    /// --- continue the event journal, its sequence is recovered from the SD card after power loss ---
+    initJournal();
+
+    /// --- load the person classifier that gates surveillance bursts ---
+    initPersonDetect();
 
     /// --- connect to WiFi ---
+    phaseTrace = traceBegin();
     initWifi();
+    traceEnd(TRACE_INIT_WIFI, phaseTrace);
+
+    /// --- 80 MHz & modem sleep from here, busier phases raise both ---
+    initPowerProfiles();
+
+    /// --- start background error notifications ---
+    if constexpr (featureTelegram) {
+        initTelegram();
+    }
+    initNotify();
 
-    /// --- set MQTT server ---
-    mqtt.setServer(MQTT_HOST, MQTT_PORT);
+    /// --- start MQTT service task ---
+    initMQTT();
+
+    /// --- start MJPEG stream server ---
+    if constexpr (featureStream) {
+        initStreamServer();
+    }
 
     /// --- set pinmodes ---
     mcp.pinMode(BLUE_LED_PIN, OUTPUT);
@@ -276,6 +417,9 @@ void setup() {
     /// --- configure pin as a source to wake when goes HIGH ---
     esp_sleep_enable_ext0_wakeup((gpio_num_t)WAKE_PIN, 1);
 
+    /// --- light sleep between events, the same pin wakes it ---
+    initIdle();
+
     /// --- get reason for wake ---
     esp_sleep_wakeup_cause_t wakeupReason = esp_sleep_get_wakeup_cause();
 
@@ -288,16 +432,34 @@ void setup() {
             delay(300);
             mcp.digitalWrite(BUZZER_PIN, LOW);
             DBG_PRINTLN("Cold boot");
-            checkForFirmwareUpdate();
+            if constexpr (featureOta) {
+                /// --- the update check is a TLS download like a drain ---
+                PowerPhase previousPhase = enterPowerPhase(POWER_UPLOAD);
+                checkForFirmwareUpdate();
+                enterPowerPhase(previousPhase);
+            }
             initTime();
+
+            /// --- compare SD & flash latency for a ring capture & a state file ---
+            if (storageBenchRounds > 0) {
+                static const uint8_t state[64] = {};
+                PooledFrame* frame = captureFrame();
+                if (frame) {
+                    benchmarkStorageTiers(frame->buf, frame->len, storageBenchRounds);
+                    releaseFrame(frame);
+                }
+                benchmarkStorageTiers(state, sizeof(state), storageBenchRounds);
+            }
+
             warmUpPIR();
             break;
 
         /// --- activate surveillance immediately if woke from wake source ---
         case ESP_SLEEP_WAKEUP_EXT0:
             DBG_PRINTLN("Wakeup by PIR");
-            activateSurveillance();
-            motionDectctionCount++;
+            if (activateSurveillance()) {
+                recordActivity();
+            }
             break;
 
         /// --- if woke from timer wake ---
@@ -312,73 +474,138 @@ void setup() {
             break;
     }
 
+    traceEnd(TRACE_BOOT, bootTrace);
+    journal(JOURNAL_BOOT, wakeupReason, 0, millis() - boot_startTime);
+
     DBG_PRINT("Boot duration: ");
     DBG_PRINTLN(millis() - boot_startTime);
 
+    /// --- report build profile, boot time & free heap to compare profiles ---
+    publishMQTT("doorbell/build",
+        String("{\"profile\":\"") + featureProfile + "\"" +
+        ",\"boot_ms\":" + String(millis() - boot_startTime) +
+        ",\"heap\":" + String(ESP.getFreeHeap()) +
+        ",\"heap_min\":" + String(ESP.getMinFreeHeap()) + "}");
+
     DBG_PRINTLN("Runtime begin");
 }
 
 
 /// === main runtime loop ===
 void loop() {
-    /// --- keep MQTT running ---
-    mqtt.loop();
+    /// --- apply settings changed over MQTT since the last pass ---
+    applyRuntimeConfig();
 
     /// --- set default runtime states of peripherals ---
     mcp.digitalWrite(BLUE_LED_PIN, HIGH);
     mcp.digitalWrite(RED_LED_PIN, LOW);
     mcp.digitalWrite(BUZZER_PIN, LOW);
 
-    /// --- notify user if motion detections exceed suspicious activity threshold ---
-    if (motionDectctionCount > acceptableDetections && !warnedOnce) {
-        
-        /// --- capture & save image ---
-        captureAndSaveImage(lastRingCaptureFilename);
-
-        /// --- send this image to telegram ---
-        sendImageToTelegram("⚠️ Suspicious activity near your door!");
+    /// --- notify user if recent motion detections exceed suspicious activity threshold ---
+    if (activityAlert(1)) {
+        /// --- another unit of the fleet may have alerted on the same visitor ---
+        bool lead = fleetShouldAlert(1);
+        journal(JOURNAL_ALERT, 1, !lead, activityLevel() * 100);
 
-        warnedOnce = true;
+        /// --- send a short album of the scene to telegram ---
+        if (lead) {
+            warnSuspiciousActivity("⚠️ Suspicious activity near your door!");
+        }
     }
 
-    /// --- sound alarm if motion detections are seriously high ---
-    if (motionDectctionCount > 2*acceptableDetections && !warnedTwice) {
-                
-        /// --- capture & save image ---
-        captureAndSaveImage(lastRingCaptureFilename);
+    /// --- sound alarm if recent motion detections are seriously high ---
+    if (activityAlert(2)) {
+        bool lead = fleetShouldAlert(2);
+        journal(JOURNAL_ALERT, 2, !lead, activityLevel() * 100);
 
-        /// --- send this image to telegram ---
-        sendImageToTelegram("⚠️ Seriously suspicious activity near your door!");
+        /// --- send a short album of the scene to telegram, the alarm sounds at every unit ---
+        if (lead) {
+            warnSuspiciousActivity("⚠️ Seriously suspicious activity near your door!");
+        }
 
         soundAlarm(60000);
-
-        warnedTwice = true;
     }
 
     /// --- ring if doorbell rung ---
     ringIfRung();
 
+    /// --- publish journal ranges asked for over MQTT ---
+    serviceJournal();
+
+    /// --- stay awake while someone is watching the live stream ---
+    bool streaming = false;
+    if constexpr (featureStream) {
+        streaming = streamClientCount() > 0;
+        if (streaming) {
+            lastActionTime = millis();
+        }
+    }
+
     /// --- activate surveillance if PIR input HIGH (motion detected) ---
     if (mcp.digitalRead(PIR_PIN) == HIGH) {
         DBG_PRINTLN("Motion detected");
-        activateSurveillance();
-        motionDectctionCount++;
+        if (activateSurveillance()) {
+            recordActivity();
+        }
     }
-    /// --- if images left to upload on SD card & right time to upload ---
-    else if (imagesLeftToUpload == true && timeToUpload() == true) {
+    /// --- if images left to upload on SD card, right time to upload, this unit holds the upload slot & this wake's upload budget isn't used up ---
+    else if (featureCloudinary && imagesLeftToUpload == true && timeToUpload() == true && fleetMayUpload() && uploadBudgetLeft()) {
         /// --- upload all images to cloudinary and delete from SD card ---
-        imagesLeftToUpload = uploadAndDeleteAll();
+        if constexpr (featureCloudinary) {
+            PowerPhase previousPhase = enterPowerPhase(POWER_UPLOAD);
+            imagesLeftToUpload = uploadAndDeleteAll();
+            enterPowerPhase(previousPhase);
+        }
     }
     /// --- if maximum allowed standby duration has passed ---
     else if (millis() - lastActionTime >= allowedStandbyDuration) {
         DBG_PRINTLN("ESP32-CAM entering deep sleep");
         DBG_DELAY(1000);
 
-        /// --- shedule next random time to upload if images left to upload ---
-        if (imagesLeftToUpload) {
-            scheduleRandomTimerWake();
+        /// --- the housekeeping & reports below only queue events, they need neither full speed nor full TX power ---
+        enterPowerPhase(POWER_SLEEP);
+
+        /// --- delete some of the wiped & uploaded sessions ---
+        reclaimTrash(trashReclaimBudget);
+
+        /// --- report recent activity & its daily profile ---
+        publishActivity();
+
+        /// --- journal the wake, the batch stays in RTC memory ---
+        journal(JOURNAL_SLEEP, featureCloudinary && imagesLeftToUpload, 0, millis());
+
+        /// --- report frame pool high-water marks ---
+        publishFramePoolStats();
+
+        /// --- report time spent in light sleep & the estimated current of this wake ---
+        publishIdleStats();
+
+        /// --- slot claims, exports, the last digest & the outbox go out with the radio always on ---
+        enterPowerPhase(POWER_NOTIFY);
+
+        /// --- lease the next free upload slots, or plan the wakes the backlog needs without the fleet, if images left to upload ---
+        if (featureCloudinary && imagesLeftToUpload) {
+            scheduleUploadWake();
         }
 
+        /// --- announce backlog & leased slots to the other units ---
+        announceFleetState();
+
+        /// --- export trace spans collected since the last flush ---
+        flushTraceToMQTT();
+
+        /// --- export journal records written since the last export ---
+        exportJournal(journalExportBudget);
+
+        /// --- send errors still waiting for a digest ---
+        flushNotify(true);
+
+        /// --- report time & estimated energy of each power phase of this wake ---
+        publishPowerStats();
+
+        /// --- give the MQTT task a chance to drain the outbox ---
+        flushMQTT(mqttFlushTimeout);
+
         /// --- hold led in current state (HIGH) ---
         gpio_hold_en((gpio_num_t)BLUE_LED_PIN);
 
@@ -388,4 +615,8 @@ void loop() {
         /// --- enter deepsleep ---
         esp_deep_sleep_start();
     }
+    /// --- light sleep until the next event or the end of standby ---
+    else if (!streaming) {
+        idleUntilEvent(allowedStandbyDuration - (millis() - lastActionTime));
+    }
 }
\ No newline at end of file
@@ -1,3 +1,13 @@
+// === standard headers ===
+// --- WiFi connectivity ---
+#include <WiFi.h>
+
+// --- FreeRTOS tasks & mutexes ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+
 // === project headers ===
 // --- corresponding header ---
 #include "mqtt.h"
@@ -5,12 +15,20 @@
 // --- secrets_example.h for reference ---
 #include "secrets.h"
 
+// --- configuration ---
+#include "settings.h"
+#include "runtime_config.h"
+
 // --- network ---
 #include "wifi.h"
 
+// --- services ---
+#include "fleet.h"
+
 // --- utilities ---
 #include "debug.h"
 #include "error.h"
+#include "journal.h"
 
 
 /// === WIFI client setup ===
@@ -21,24 +39,292 @@ WiFiClient wifiClient;
 PubSubClient mqtt(wifiClient);
 
 
-/// === ensure connection to MQTT  ===
-void ensureMQTT() {
-    /// --- attempt to connect for 5 seconds ---
-    unsigned long attemptConnection_startTime = millis();
-    while (!mqtt.connected() && millis() - attemptConnection_startTime < 5000) {
-        DBG_PRINTLN("Not connected to MQTT");
-        delay(50);
-        mqtt.connect(
-            "smart-doorbell",
-            MQTT_USER,
-            MQTT_PASS
-        );
+/// === guards every access to the shared MQTT client ===
+SemaphoreHandle_t mqttLock = nullptr;
+
+
+// === offline outbox ===
+/// --- single queued event ---
+struct OutboxEvent {
+    uint32_t seq;
+    bool     carried;
+    bool     retained;
+    uint32_t queuedAt;
+    char     topic[MQTT_TOPIC_LEN];
+    char     payload[MQTT_PAYLOAD_LEN];
+};
+
+/// --- ring buffer kept in RTC memory so queued events survive deep sleep ---
+RTC_DATA_ATTR static OutboxEvent outbox[MQTT_OUTBOX_SIZE];
+RTC_DATA_ATTR static int         outboxHead    = 0;
+RTC_DATA_ATTR static int         outboxCount   = 0;
+RTC_DATA_ATTR static uint32_t    outboxNextSeq = 0;
+RTC_DATA_ATTR static uint32_t    outboxDropped = 0;
+
+/// --- short critical section guarding the outbox indices ---
+static portMUX_TYPE outboxMux = portMUX_INITIALIZER_UNLOCKED;
+
+
+// === publish statistics ===
+/// --- latency of the last event published from the outbox ---
+static volatile unsigned long lastPublishLatency = 0;
+
+/// --- connection state as last seen by the MQTT task ---
+static volatile bool brokerConnected = false;
+
+
+/// === attempt a single non-blocking broker connection ===
+static bool connectMQTT() {
+    DBG_PRINTLN("Connecting to MQTT");
+
+    /// --- client ids must differ per unit, the broker drops a connection when another takes its id ---
+    return mqtt.connect(
+        (String("smart-doorbell-") + fleetUnitId()).c_str(),
+        MQTT_USER,
+        MQTT_PASS
+    );
+}
+
+
+/// === route incoming messages, runs on the MQTT task inside mqtt.loop() ===
+static void onMessage(char* topic, uint8_t* payload, unsigned int length) {
+    String value;
+    value.reserve(length);
+    for (unsigned int i = 0; i < length; i++) {
+        value += (char)payload[i];
     }
+    value.trim();
 
-    if (!mqtt.connected()) {
-        error("Failed to connect to MQTT in time", false);
+    /// --- journal range, "<from>[,<count>]" ---
+    if (strcmp(topic, JOURNAL_GET_TOPIC) == 0) {
+        int comma = value.indexOf(',');
+        uint32_t from  = strtoul(value.c_str(), nullptr, 10);
+        uint32_t count = comma < 0 ? JOURNAL_REQUEST_MAX : strtoul(value.c_str() + comma + 1, nullptr, 10);
+        requestJournalRange(from, min(count, JOURNAL_REQUEST_MAX));
+        return;
     }
-    else {
-        DBG_PRINTLN("Connected to MQTT");
+
+    /// --- announcements, leases & alerts of every unit, this one included ---
+    size_t fleetLen = strlen(FLEET_TOPIC_PREFIX);
+    if (strncmp(topic, FLEET_TOPIC_PREFIX, fleetLen) == 0) {
+        handleFleetMessage(topic + fleetLen, value);
+        return;
+    }
+
+    size_t prefixLen = strlen(CONFIG_TOPIC_PREFIX);
+    if (strncmp(topic, CONFIG_TOPIC_PREFIX, prefixLen) == 0) {
+        handleConfigCommand(topic + prefixLen, value);
     }
+}
+
+
+/// === publish queued events in one batch ===
+static int drainOutbox() {
+    int published = 0;
+
+    while (mqtt.connected()) {
+        /// --- copy the oldest event out of the ring buffer ---
+        OutboxEvent event;
+        portENTER_CRITICAL(&outboxMux);
+        bool empty = (outboxCount == 0);
+        if (!empty) {
+            event = outbox[outboxHead];
+        }
+        portEXIT_CRITICAL(&outboxMux);
+
+        if (empty) {
+            break;
+        }
+
+        /// --- stop the batch on the first failed publish & retry later ---
+        if (!mqtt.publish(event.topic, event.payload, event.retained)) {
+            break;
+        }
+
+        /// --- pop the event unless it was overwritten while publishing ---
+        portENTER_CRITICAL(&outboxMux);
+        if (outboxCount > 0 && outbox[outboxHead].seq == event.seq) {
+            outboxHead = (outboxHead + 1) % MQTT_OUTBOX_SIZE;
+            outboxCount--;
+        }
+        portEXIT_CRITICAL(&outboxMux);
+
+        /// --- only events queued during this boot have a meaningful latency ---
+        if (!event.carried) {
+            lastPublishLatency = millis() - event.queuedAt;
+        }
+        published++;
+    }
+
+    return published;
+}
+
+
+/// === publish outbox depth & latency for Home Assistant ===
+static void publishStats() {
+    String stats =
+        "{\"outbox\":" + String(mqttOutboxDepth()) +
+        ",\"dropped\":" + String(outboxDropped) +
+        ",\"latency_ms\":" + String(lastPublishLatency) + "}";
+
+    mqtt.publish("doorbell/mqtt/stats", stats.c_str(), true);
+}
+
+
+/// === MQTT service task: reconnect with backoff, keep alive & drain outbox ===
+static void mqttTask(void* param) {
+    unsigned long backoff       = mqttBackoffMin;
+    unsigned long lastAttemptMs = 0;
+    bool          firstAttempt  = true;
+
+    while (true) {
+        xSemaphoreTake(mqttLock, portMAX_DELAY);
+        bool connected = mqtt.connected();
+        if (!connected) {
+            brokerConnected = false;
+        }
+        xSemaphoreGive(mqttLock);
+
+        /// --- connect without the lock, publishers see the broker offline meanwhile & leave the client alone ---
+        if (!connected) {
+            /// --- only retry once the current backoff has elapsed ---
+            bool due = firstAttempt || millis() - lastAttemptMs >= backoff;
+            if (WiFi.status() == WL_CONNECTED && due) {
+                firstAttempt  = false;
+                lastAttemptMs = millis();
+
+                if (connectMQTT()) {
+                    DBG_PRINTLN("Connected to MQTT");
+                    backoff = mqttBackoffMin;
+
+                    /// --- retained commands are delivered again on every connect, runtime_config skips the ones handled already ---
+                    mqtt.subscribe((String(CONFIG_TOPIC_PREFIX) + "#").c_str());
+                    mqtt.subscribe(JOURNAL_GET_TOPIC);
+
+                    /// --- retained fleet state follows the subscription ---
+                    mqtt.subscribe((String(FLEET_TOPIC_PREFIX) + "#").c_str());
+                    fleetSubscribed();
+                }
+                else {
+                    /// --- double the backoff with up to 25% jitter, never past mqttBackoffMax ---
+                    backoff = min(backoff * 2, mqttBackoffMax);
+                    backoff = min(backoff + esp_random() % (backoff / 4 + 1), mqttBackoffMax);
+                    DBG_PRINT("MQTT connect failed, retrying in ");
+                    DBG_PRINTLN(backoff);
+                }
+            }
+        }
+
+        xSemaphoreTake(mqttLock, portMAX_DELAY);
+
+        if (mqtt.connected()) {
+            brokerConnected = true;
+
+            /// --- service keep-alive & incoming packets ---
+            mqtt.loop();
+
+            /// --- replay anything queued while offline ---
+            if (drainOutbox() > 0) {
+                publishStats();
+            }
+        }
+
+        xSemaphoreGive(mqttLock);
+
+        vTaskDelay(pdMS_TO_TICKS(mqttTaskPeriod));
+    }
+}
+
+
+/// === configure MQTT client & start the MQTT service task ===
+void initMQTT() {
+    /// --- set MQTT server ---
+    mqtt.setServer(MQTT_HOST, MQTT_PORT);
+
+    /// --- configuration commands ---
+    mqtt.setCallback(onMessage);
+
+    /// --- enlarge packet buffer for binary snapshot chunks ---
+    if (!mqtt.setBufferSize(MQTT_BUFFER_SIZE)) {
+        error("Failed to allocate MQTT buffer", false);
+    }
+
+    /// --- events carried over deep sleep have no valid enqueue time ---
+    for (int i = 0; i < MQTT_OUTBOX_SIZE; i++) {
+        outbox[i].carried = true;
+    }
+
+    mqttLock = xSemaphoreCreateMutex();
+    if (mqttLock == nullptr) {
+        error("Failed to create MQTT lock", false);
+        return;
+    }
+
+    if (xTaskCreatePinnedToCore(mqttTask, "mqtt", 4096, nullptr, 1, nullptr, 0) != pdPASS) {
+        error("Failed to start MQTT task", false);
+    }
+}
+
+
+/// === queue an event for publishing, never blocks on the network ===
+bool publishMQTT(const char* topic, const String& payload, bool retained) {
+    if (strlen(topic) >= MQTT_TOPIC_LEN || payload.length() >= MQTT_PAYLOAD_LEN) {
+        DBG_PRINTLN("MQTT event too large for outbox");
+        return false;
+    }
+
+    portENTER_CRITICAL(&outboxMux);
+
+    /// --- overwrite the oldest event when the outbox is full ---
+    if (outboxCount == MQTT_OUTBOX_SIZE) {
+        outboxHead = (outboxHead + 1) % MQTT_OUTBOX_SIZE;
+        outboxCount--;
+        outboxDropped++;
+    }
+
+    OutboxEvent& event = outbox[(outboxHead + outboxCount) % MQTT_OUTBOX_SIZE];
+    event.seq      = outboxNextSeq++;
+    event.carried  = false;
+    event.retained = retained;
+    event.queuedAt = millis();
+    strncpy(event.topic, topic, MQTT_TOPIC_LEN);
+    strncpy(event.payload, payload.c_str(), MQTT_PAYLOAD_LEN);
+    outboxCount++;
+
+    portEXIT_CRITICAL(&outboxMux);
+
+    return true;
+}
+
+
+/// === wait for the outbox to drain, anything left is kept for the next wake ===
+bool flushMQTT(unsigned long timeoutMs) {
+    unsigned long flush_startTime = millis();
+    while (mqttOutboxDepth() > 0 && millis() - flush_startTime < timeoutMs) {
+        delay(20);
+    }
+
+    return mqttOutboxDepth() == 0;
+}
+
+
+/// === check if the MQTT task currently holds a broker connection ===
+bool mqttConnected() {
+    return brokerConnected;
+}
+
+
+/// === number of events waiting in the outbox ===
+int mqttOutboxDepth() {
+    portENTER_CRITICAL(&outboxMux);
+    int depth = outboxCount;
+    portEXIT_CRITICAL(&outboxMux);
+
+    return depth;
+}
+
+
+/// === enqueue-to-publish latency of the last outbox event ===
+unsigned long mqttPublishLatency() {
+    return lastPublishLatency;
 }
\ No newline at end of file
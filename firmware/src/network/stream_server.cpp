@@ -0,0 +1,356 @@
+// === standard headers ===
+// --- WiFi connectivity & TCP server ---
+#include <WiFi.h>
+
+// --- FreeRTOS tasks ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "stream_server.h"
+
+// --- configuration ---
+#include "settings.h"
+#include "secrets.h"
+
+// --- hardware ---
+#include "frame_pool.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "error.h"
+
+
+// === shared frames ===
+/// --- most recent frame, holds one pool reference of its own ---
+static PooledFrame* latestFrame = nullptr;
+
+/// --- guards the latest frame pointer & the client statistics ---
+static portMUX_TYPE frameMux = portMUX_INITIALIZER_UNLOCKED;
+
+
+// === clients ===
+/// --- TCP server accepting stream requests ---
+static WiFiServer streamServer(streamPort);
+
+/// --- statistics per client slot, written by the client & accept tasks under frameMux ---
+static StreamClientStats clientStats[STREAM_MAX_CLIENTS];
+
+/// --- connection handed to a client task ---
+struct StreamClient {
+    WiFiClient client;
+    int        slot;
+};
+
+
+// === multipart framing ===
+#define STREAM_BOUNDARY "guardianbellframe"
+
+static const char* STREAM_HEADER =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=" STREAM_BOUNDARY "\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: close\r\n\r\n";
+
+static const char* STREAM_PART =
+    "--" STREAM_BOUNDARY "\r\n"
+    "Content-Type: image/jpeg\r\n"
+    "Content-Length: %u\r\n\r\n";
+
+static const char* STREAM_UNAUTHORIZED =
+    "HTTP/1.1 401 Unauthorized\r\n"
+    "WWW-Authenticate: Bearer\r\n"
+    "Connection: close\r\n\r\n";
+
+/// --- request lines read before giving up on the headers ---
+const int STREAM_MAX_HEADER_LINES = 24;
+
+
+/// === take a reference to the latest frame if it is newer than lastSeq ===
+static PooledFrame* acquireLatestFrame(uint32_t lastSeq) {
+    PooledFrame* frame = nullptr;
+
+    portENTER_CRITICAL(&frameMux);
+    if (latestFrame != nullptr && latestFrame->seq != lastSeq) {
+        frame = latestFrame;
+        retainFrame(frame);
+    }
+    portEXIT_CRITICAL(&frameMux);
+
+    return frame;
+}
+
+
+/// === make frame the latest, dropping the reference to the previous one ===
+static void swapLatestFrame(PooledFrame* frame) {
+    portENTER_CRITICAL(&frameMux);
+    PooledFrame* old = latestFrame;
+    latestFrame = frame;
+    portEXIT_CRITICAL(&frameMux);
+
+    releaseFrame(old);
+}
+
+
+/// === capture task: publishes frames while at least one client is connected ===
+static void streamCaptureTask(void* param) {
+    while (true) {
+        if (streamClientCount() == 0) {
+            /// --- release the last frame so its pool slot is free while idle ---
+            swapLatestFrame(nullptr);
+
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        /// --- pool exhausted by slow clients: skip instead of stalling capture ---
+        PooledFrame* frame = captureFrame();
+        if (frame == nullptr) {
+            vTaskDelay(pdMS_TO_TICKS(5));
+            continue;
+        }
+
+        /// --- clients still sending the old frame keep it alive ---
+        swapLatestFrame(frame);
+    }
+}
+
+
+/// === publish per-client fps & dropped frames ===
+static void reportClientStats(int slot) {
+    portENTER_CRITICAL(&frameMux);
+    StreamClientStats stats = clientStats[slot];
+    portEXIT_CRITICAL(&frameMux);
+
+    DBG_PRINT("Stream client " + String(slot) + ": ");
+    DBG_PRINT(stats.fps);
+    DBG_PRINT(" fps, dropped ");
+    DBG_PRINTLN(stats.framesDropped);
+
+    publishMQTT("doorbell/stream/stats",
+        "{\"client\":" + String(slot) +
+        ",\"fps\":" + String(stats.fps, 1) +
+        ",\"sent\":" + String(stats.framesSent) +
+        ",\"dropped\":" + String(stats.framesDropped) + "}");
+}
+
+
+/// === client task: sends the latest frame, skipping any produced meanwhile ===
+static void streamClientTask(void* param) {
+    StreamClient* sc = static_cast<StreamClient*>(param);
+    WiFiClient& client = sc->client;
+    StreamClientStats& stats = clientStats[sc->slot];
+
+    client.setNoDelay(true);
+    client.print(STREAM_HEADER);
+
+    uint32_t      lastSeq          = 0;
+    uint32_t      windowFrames     = 0;
+    unsigned long window_startTime = millis();
+
+    while (client.connected()) {
+        PooledFrame* frame = acquireLatestFrame(lastSeq);
+        if (frame == nullptr) {
+            vTaskDelay(pdMS_TO_TICKS(5));
+            continue;
+        }
+
+        /// --- frames published while this client was still writing are dropped ---
+        uint32_t dropped = lastSeq != 0 && frame->seq > lastSeq + 1 ? frame->seq - lastSeq - 1 : 0;
+
+        char part[96];
+        int partLen = snprintf(part, sizeof(part), STREAM_PART, (unsigned)frame->len);
+
+        bool ok =
+            client.write((const uint8_t*)part, partLen) == (size_t)partLen &&
+            client.write(frame->buf, frame->len) == frame->len &&
+            client.write((const uint8_t*)"\r\n", 2) == 2;
+
+        lastSeq = frame->seq;
+        releaseFrame(frame);
+
+        if (!ok) {
+            break;
+        }
+
+        windowFrames++;
+
+        /// --- recompute fps & report over each stats window ---
+        unsigned long elapsed = millis() - window_startTime;
+        bool windowEnded = elapsed >= streamStatsPeriod;
+
+        portENTER_CRITICAL(&frameMux);
+        stats.framesDropped += dropped;
+        stats.framesSent++;
+        if (windowEnded) {
+            stats.fps = windowFrames * 1000.0f / elapsed;
+        }
+        portEXIT_CRITICAL(&frameMux);
+
+        if (windowEnded) {
+            reportClientStats(sc->slot);
+            windowFrames = 0;
+            window_startTime = millis();
+        }
+    }
+
+    reportClientStats(sc->slot);
+
+    client.stop();
+
+    portENTER_CRITICAL(&frameMux);
+    stats.active = false;
+    portEXIT_CRITICAL(&frameMux);
+    delete sc;
+
+    vTaskDelete(nullptr);
+}
+
+
+/// === compare a presented token with STREAM_TOKEN in constant time ===
+static bool tokenMatches(const String& token) {
+    size_t expected = strlen(STREAM_TOKEN);
+    uint8_t diff = token.length() != expected;
+    for (size_t i = 0; i < token.length(); i++) {
+        diff |= (uint8_t)token[i] ^ (uint8_t)STREAM_TOKEN[i % expected];
+    }
+    return diff == 0;
+}
+
+
+/// === read the request, true if it carries STREAM_TOKEN as ?token= or an Authorization: Bearer header ===
+static bool requestAuthorized(WiFiClient& client) {
+    /// --- "GET /?token=<token> HTTP/1.1" ---
+    String line = client.readStringUntil('\n');
+    bool authorized = false;
+
+    int at = line.indexOf("token=");
+    if (at >= 0) {
+        int end = at + 6;
+        while (end < (int)line.length() && line[end] != '&' && line[end] != ' ') {
+            end++;
+        }
+        authorized = tokenMatches(line.substring(at + 6, end));
+    }
+
+    /// --- headers up to the blank line ---
+    for (int i = 0; i < STREAM_MAX_HEADER_LINES; i++) {
+        line = client.readStringUntil('\n');
+        line.trim();
+        if (line.length() == 0) {
+            break;
+        }
+        if (line.startsWith("Authorization: Bearer ")) {
+            authorized |= tokenMatches(line.substring(22));
+        }
+    }
+
+    return authorized;
+}
+
+
+/// === accept task: hands each new connection to its own client task ===
+static void streamAcceptTask(void* param) {
+    while (true) {
+        WiFiClient client = streamServer.available();
+        if (!client) {
+            vTaskDelay(pdMS_TO_TICKS(50));
+            continue;
+        }
+
+        /// --- every path serves the stream, but only with the token ---
+        if (!requestAuthorized(client)) {
+            client.print(STREAM_UNAUTHORIZED);
+            client.stop();
+            continue;
+        }
+
+        /// --- claim a free client slot ---
+        int slot = -1;
+        portENTER_CRITICAL(&frameMux);
+        for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+            if (!clientStats[i].active) {
+                slot = i;
+                clientStats[i] = { true, 0.0f, 0, 0 };
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&frameMux);
+
+        if (slot < 0) {
+            client.print("HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\n\r\n");
+            client.stop();
+            continue;
+        }
+
+        StreamClient* sc = new StreamClient{ client, slot };
+        if (xTaskCreatePinnedToCore(streamClientTask, "stream_client", 4096, sc, 1, nullptr, 0) != pdPASS) {
+            DBG_PRINTLN("Failed to start stream client task");
+            portENTER_CRITICAL(&frameMux);
+            clientStats[slot].active = false;
+            portEXIT_CRITICAL(&frameMux);
+            client.stop();
+            delete sc;
+        }
+    }
+}
+
+
+/// === start MJPEG streaming server ===
+void initStreamServer() {
+    /// --- sharing frames needs the PSRAM frame pool ---
+    if (!psramFound()) {
+        error("No PSRAM, stream server disabled", false);
+        return;
+    }
+
+    /// --- the camera is never served to the LAN without authentication ---
+    if (strlen(STREAM_TOKEN) == 0) {
+        error("No stream token, stream server disabled", false);
+        return;
+    }
+
+    streamServer.begin();
+
+    if (xTaskCreatePinnedToCore(streamAcceptTask, "stream_accept", 3072, nullptr, 1, nullptr, 0) != pdPASS ||
+        xTaskCreatePinnedToCore(streamCaptureTask, "stream_capture", 3072, nullptr, 1, nullptr, 1) != pdPASS) {
+        error("Failed to start stream server", false);
+        return;
+    }
+
+    DBG_PRINTLN("Stream server listening on port " + String(streamPort));
+}
+
+
+/// === number of connected stream clients ===
+int streamClientCount() {
+    int count = 0;
+    portENTER_CRITICAL(&frameMux);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (clientStats[i].active) {
+            count++;
+        }
+    }
+    portEXIT_CRITICAL(&frameMux);
+
+    return count;
+}
+
+
+/// === copy statistics of a client slot ===
+bool getStreamClientStats(int slot, StreamClientStats& stats) {
+    if (slot < 0 || slot >= STREAM_MAX_CLIENTS) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&frameMux);
+    stats = clientStats[slot];
+    portEXIT_CRITICAL(&frameMux);
+
+    return stats.active;
+}
\ No newline at end of file
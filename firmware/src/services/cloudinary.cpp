@@ -2,6 +2,10 @@
 // --- HTTP client for REST requests / file download ---
 #include <HTTPClient.h>
 
+// --- FreeRTOS task delays ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
 
 // === project headers ===
 // --- corresponding header ---
@@ -19,16 +23,19 @@
 // --- utilities ---
 #include "debug.h"
 #include "error.h"
+#include "trace.h"
 
 
 /// === WIFI client setup ===
 WiFiClientSecure cloudinaryClient;
  
 
-/// === upload a JPEG file to cloudinary ===
-bool uploadImageToCloudinary(File &file, String filename) {
+/// === POST a JPEG file over client & close it, returns the HTTP status, 0 without a response or -1 if the connection failed ===
+int postImageToCloudinary(WiFiClientSecure& client, File& file, const String& filename, uint8_t* buf, size_t bufLen) {
+    uint32_t uploadSpan = traceBegin();
+
     /// --- skip certificate validation ---
-    cloudinaryClient.setInsecure();
+    client.setInsecure();
 
     /// --- URL endpoint ---
     String url = "/v1_1/" + String(CLOUDINARY_CLOUD_NAME) + "/image/upload";
@@ -56,16 +63,18 @@ bool uploadImageToCloudinary(File &file, String filename) {
     /// --- determine total size of content ---
     uint32_t totalLength = head.length() + file.size() + tail.length();
 
-    /// --- connect to telegram ---
+    /// --- connect to cloudinary ---
     DBG_PRINTLN("Connecting to " + String(cloudinaryHost));
-    if (!cloudinaryClient.connect(cloudinaryHost, 443)) {
-        error("Cloudinary connection failed", true);
+    uint32_t connectSpan = traceBegin();
+    bool connected = client.connect(cloudinaryHost, 443);
+    traceEnd(TRACE_TLS_CONNECT, connectSpan);
+    if (!connected) {
         file.close();
-        return false;
+        return -1;
     }
 
     /// --- send HTTP POST headers ---
-    cloudinaryClient.print(
+    client.print(
         "POST " + url + " HTTP/1.1\r\n"
         "Host: " + String(cloudinaryHost) + "\r\n"
         "Content-Type: multipart/form-data; boundary=" + boundary + "\r\n"
@@ -74,30 +83,52 @@ bool uploadImageToCloudinary(File &file, String filename) {
     );
 
     /// --- send multipart head ---
-    cloudinaryClient.print(head);
+    client.print(head);
 
     /// --- send file binary ---
-    uint8_t buf[1024];
     DBG_PRINTLN("Uploading JPEG to cloudinary...");
     while (file.available()) {
-        int n = file.read(buf, sizeof(buf));
-        cloudinaryClient.write(buf, n);
+        int n = file.read(buf, bufLen);
+        client.write(buf, n);
     }
 
     /// --- send multipart tail ---
-    cloudinaryClient.print(tail);
+    client.print(tail);
 
     // -- close file ---
     file.close();
 
-    /// --- read cloudinary response ---
+    /// --- on a link shared by parallel uploads the response can trail the last write by seconds ---
+    unsigned long waitStart = millis();
+    while (client.connected() && client.available() == 0 && millis() - waitStart < cloudinaryResponseTimeout) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    /// --- read cloudinary response, "HTTP/1.1 200 OK" ---
     DBG_PRINTLN("Cloudinary response:");
-    while (cloudinaryClient.connected()) {
-        String line = cloudinaryClient.readStringUntil('\n');
+    String status = client.readStringUntil('\n');
+    int code = status.substring(status.indexOf(' ') + 1).toInt();
+    while (client.connected()) {
+        String line = client.readStringUntil('\n');
         if (line == "\r") break;
     }
-    String body = cloudinaryClient.readString();
+    String body = client.readString();
     DBG_PRINTLN(body);
+    client.stop();
+
+    traceEnd(TRACE_UPLOAD, uploadSpan);
+
+    return code;
+}
+
+
+/// === upload a JPEG file to cloudinary ===
+bool uploadImageToCloudinary(File &file, String filename) {
+    uint8_t buf[1024];
+    if (postImageToCloudinary(cloudinaryClient, file, filename, buf, sizeof(buf)) < 0) {
+        error("Cloudinary connection failed", true);
+        return false;
+    }
 
     DBG_PRINTLN("JPEG uploaded");
     return true;
@@ -0,0 +1,523 @@
+// === standard headers ===
+// --- system time functions ---
+#include <time.h>
+
+// --- ESP32 sleep modes ---
+#include <esp_sleep.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "fleet.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- services ---
+#include "upload_engine.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "time_util.h"
+#include "capture_session.h"
+#include "upload_scheduler.h"
+
+
+// Several units on one property share the broker & the uplink. Their peers
+// are asleep most of the time, so fleet state lives in retained messages under
+// doorbell/fleet/ & reaches a unit right after it subscribes. Each unit
+// announces its backlog & capabilities on unit/<id>. The upload window is
+// split into fleetSlotMinutes slots, each leased on slot/<n> by one unit at a
+// time; a unit claims a run of free slots sized by its share of the fleet's
+// backlog, & no longer than its own backlog takes at the measured throughput,
+// & only uploads inside it. Two units claiming the same slot both see the
+// broker's last write after fleetSettleTime, & that one wins. While armed the
+// claim settles in the background, the loop asks again on its next pass
+// instead of waiting for it; only the claims made before deep sleep block.
+// Suspicious activity alerts are claimed the same way on alert, so within
+// fleetAlertWindow only the first unit, or one escalating, sends the album.
+
+
+// === fleet state as last seen on the broker, written by the MQTT task ===
+/// --- holder of a slot & the end of its lease, unit 0 when free ---
+struct FleetLease {
+    uint32_t unit;
+    uint32_t end;
+};
+
+/// --- announced backlog of another unit ---
+struct FleetPeer {
+    uint32_t unit;
+    uint32_t backlog;
+    uint32_t seen;
+};
+
+/// --- latest alert claim ---
+struct FleetAlert {
+    uint32_t unit;
+    uint32_t time;
+    uint8_t  level;
+};
+
+static FleetLease leases[FLEET_MAX_SLOTS];
+static FleetPeer  peers[FLEET_MAX_PEERS];
+static FleetAlert lastAlert;
+
+/// --- millis() of the last subscription, 0 before the first ---
+static volatile unsigned long subscribedAt = 0;
+
+static portMUX_TYPE fleetMux = portMUX_INITIALIZER_UNLOCKED;
+
+
+// === this unit ===
+static char     unitId[7] = "";
+static uint32_t unitNumber = 0;
+
+/// --- leased upload slots, kept over deep sleep ---
+RTC_DATA_ATTR static uint32_t leaseStart = 0;
+RTC_DATA_ATTR static uint32_t leaseEnd   = 0;
+
+/// --- a slot lost to another unit isn't claimed again before it ends ---
+static uint32_t lostUntil = 0;
+
+/// --- claim published & waiting to settle, count 0 when none ---
+struct FleetClaim {
+    time_t        start;
+    time_t        end;
+    int           first;
+    int           count;
+    unsigned long sentAt;
+    unsigned long flushedAt;
+};
+
+static FleetClaim claim;
+
+
+/// === upload window split into slots ===
+struct SlotWindow {
+    time_t start;
+    time_t end;
+    int    slots;
+};
+
+
+/// === unit id, the last three bytes of the MAC address in hex ===
+const char* fleetUnitId() {
+    if (unitNumber == 0) {
+        unitNumber = (uint32_t)(ESP.getEfuseMac() >> 24) & 0xFFFFFF;
+        snprintf(unitId, sizeof(unitId), "%06x", (unsigned)unitNumber);
+    }
+    return unitId;
+}
+
+
+/// === unit id as a number, as carried in leases & alerts ===
+static uint32_t ownUnit() {
+    fleetUnitId();
+    return unitNumber;
+}
+
+
+/// === called by the MQTT task after subscribing, retained state follows ===
+void fleetSubscribed() {
+    subscribedAt = millis() | 1;
+}
+
+
+/// === check the retained fleet state has arrived & the clock is synced ===
+static bool fleetReady() {
+    unsigned long since = subscribedAt;
+    return mqttConnected() && since != 0 && millis() - since >= fleetSyncTime && time(nullptr) > 1600000000;
+}
+
+
+/// === number following key in a flat JSON object, 0 if missing ===
+static uint32_t jsonField(const String& json, const char* key) {
+    int at = json.indexOf(String("\"") + key + "\":");
+    return at < 0 ? 0 : strtoul(json.c_str() + at + strlen(key) + 3, nullptr, 10);
+}
+
+
+/// === record an announcement, leases or alert of any unit, runs on the MQTT task ===
+void handleFleetMessage(const char* subtopic, const String& value) {
+    /// --- "slot/<n>": "<unit> <lease end>", empty when released ---
+    if (strncmp(subtopic, "slot/", 5) == 0) {
+        int slot = atoi(subtopic + 5);
+        if (slot < 0 || slot >= FLEET_MAX_SLOTS) {
+            return;
+        }
+        char* rest = nullptr;
+        FleetLease lease;
+        lease.unit = strtoul(value.c_str(), &rest, 16);
+        lease.end  = strtoul(rest, nullptr, 10);
+
+        portENTER_CRITICAL(&fleetMux);
+        leases[slot] = lease;
+        portEXIT_CRITICAL(&fleetMux);
+        return;
+    }
+
+    /// --- "unit/<id>": announcement, only the backlog & when it was sent are kept ---
+    if (strncmp(subtopic, "unit/", 5) == 0) {
+        uint32_t unit = strtoul(subtopic + 5, nullptr, 16);
+        if (unit == ownUnit()) {
+            return;
+        }
+        FleetPeer peer = { unit, jsonField(value, "backlog"), jsonField(value, "seen") };
+
+        /// --- update the unit's entry, or replace the one heard from longest ago ---
+        portENTER_CRITICAL(&fleetMux);
+        int slot = 0;
+        for (int i = 0; i < FLEET_MAX_PEERS; i++) {
+            if (peers[i].unit == unit) {
+                slot = i;
+                break;
+            }
+            if (peers[i].seen < peers[slot].seen) {
+                slot = i;
+            }
+        }
+        peers[slot] = peer;
+        portEXIT_CRITICAL(&fleetMux);
+        return;
+    }
+
+    /// --- "alert": "<unit> <time> <level>" ---
+    if (strcmp(subtopic, "alert") == 0) {
+        char* rest = nullptr;
+        FleetAlert alert;
+        alert.unit  = strtoul(value.c_str(), &rest, 16);
+        alert.time  = strtoul(rest, &rest, 10);
+        alert.level = strtoul(rest, nullptr, 10);
+
+        portENTER_CRITICAL(&fleetMux);
+        lastAlert = alert;
+        portEXIT_CRITICAL(&fleetMux);
+    }
+}
+
+
+/// === announce backlog, capabilities & leased slots, retained for units waking later ===
+void announceFleetState() {
+    uint32_t connections = 0;
+    if constexpr (featureCloudinary) {
+        connections = uploadConnections();
+    }
+
+    uint32_t slotSeconds = fleetSlotMinutes * 60;
+    publishMQTT((String(FLEET_TOPIC_PREFIX) + "unit/" + fleetUnitId()).c_str(),
+        "{\"backlog\":" + String(pendingCaptures()) +
+        ",\"conns\":" + String(connections) +
+        ",\"cloud\":" + String(featureCloudinary ? 1 : 0) +
+        ",\"lease\":" + String(leaseStart) +
+        ",\"n\":" + String(leaseEnd > leaseStart ? (leaseEnd - leaseStart + slotSeconds - 1) / slotSeconds : 0) +
+        ",\"seen\":" + String((uint32_t)time(nullptr)) + "}", true);
+}
+
+
+/// === slots of the upload window in progress or next to come, day 1 is the window after ===
+static bool slotWindow(SlotWindow& window, int day) {
+    if (!nextUploadWindow(window.start, window.end)) {
+        return false;
+    }
+    window.start += day * 24 * 3600;
+    window.end   += day * 24 * 3600;
+
+    time_t slotSeconds = fleetSlotMinutes * 60;
+    window.slots = min((int)((window.end - window.start + slotSeconds - 1) / slotSeconds), FLEET_MAX_SLOTS);
+    return window.slots > 0;
+}
+
+static time_t slotStart(const SlotWindow& window, int slot) {
+    return window.start + slot * (time_t)fleetSlotMinutes * 60;
+}
+
+static time_t slotEnd(const SlotWindow& window, int slot) {
+    return min(slotStart(window, slot + 1), window.end);
+}
+
+
+/// === check a slot is unleased, leased by this unit or by a lease that has ended ===
+static bool slotFree(const SlotWindow& window, int slot) {
+    portENTER_CRITICAL(&fleetMux);
+    FleetLease lease = leases[slot];
+    portEXIT_CRITICAL(&fleetMux);
+
+    /// --- slot topics are reused every window, tomorrow's slot is free once today's lease ended ---
+    time_t ended = min(slotStart(window, slot), time(nullptr));
+    return lease.unit == 0 || lease.unit == ownUnit() || (time_t)lease.end <= ended;
+}
+
+
+/// === slots to lease: this unit's share of the fleet's backlog across the free slots, at most what its backlog needs ===
+static int slotsWanted(int freeSlots) {
+    uint32_t now   = time(nullptr);
+    uint32_t mine  = pendingCaptures();
+    uint64_t total = mine;
+
+    portENTER_CRITICAL(&fleetMux);
+    for (int i = 0; i < FLEET_MAX_PEERS; i++) {
+        if (peers[i].unit != 0 && now - peers[i].seen < fleetPeerExpiry) {
+            total += peers[i].backlog;
+        }
+    }
+    portEXIT_CRITICAL(&fleetMux);
+
+    int share = total == 0 ? 1 : (int)((freeSlots * (uint64_t)mine + total / 2) / total);
+
+    /// --- slots the backlog takes to drain, from the upload planner's throughput estimate ---
+    uint32_t slotSeconds = fleetSlotMinutes * 60;
+    int      needed      = min((uint32_t)fleetMaxLease, (uploadSecondsNeeded() + slotSeconds - 1) / slotSeconds);
+
+    return constrain(min(share, needed), 1, fleetMaxLease);
+}
+
+
+/// === publish claims of count slots from first, settleClaim() tells how many were won ===
+static void sendClaim(const SlotWindow& window, int first, int count) {
+    for (int slot = first; slot < first + count; slot++) {
+        publishMQTT((String(FLEET_TOPIC_PREFIX) + "slot/" + String(slot)).c_str(),
+                    String(fleetUnitId()) + " " + String((uint32_t)slotEnd(window, slot)), true);
+    }
+
+    claim.start     = window.start;
+    claim.end       = window.end;
+    claim.first     = first;
+    claim.count     = count;
+    claim.sentAt    = millis();
+    claim.flushedAt = 0;
+}
+
+
+/// === slots in a row from the first claimed that this unit won, -1 while the claim settles ===
+static int settleClaim() {
+    /// --- once the claims are on the broker, every unit sees the same last write ---
+    if (claim.flushedAt == 0) {
+        if (mqttOutboxDepth() > 0) {
+            if (millis() - claim.sentAt < fleetSettleTime) {
+                return -1;
+            }
+
+            /// --- the queued claims still go out later, release them behind so peers don't skip the slots ---
+            for (int slot = claim.first; slot < claim.first + claim.count; slot++) {
+                publishMQTT((String(FLEET_TOPIC_PREFIX) + "slot/" + String(slot)).c_str(), "", true);
+            }
+            claim.count = 0;
+            return 0;
+        }
+        claim.flushedAt = millis() | 1;
+    }
+    if (millis() - claim.flushedAt < fleetSettleTime) {
+        return -1;
+    }
+
+    SlotWindow window = { claim.start, claim.end, 0 };
+    int first = claim.first;
+    int count = claim.count;
+    claim.count = 0;
+
+    int won = 0;
+    portENTER_CRITICAL(&fleetMux);
+    while (won < count && leases[first + won].unit == ownUnit()) {
+        won++;
+    }
+    portEXIT_CRITICAL(&fleetMux);
+
+    /// --- hand back slots won behind a lost one, a lease is one run of slots ---
+    for (int slot = first + won + 1; slot < first + count; slot++) {
+        portENTER_CRITICAL(&fleetMux);
+        bool held = leases[slot].unit == ownUnit();
+        portEXIT_CRITICAL(&fleetMux);
+        if (held) {
+            publishMQTT((String(FLEET_TOPIC_PREFIX) + "slot/" + String(slot)).c_str(), "", true);
+        }
+    }
+
+    /// --- a run right after the lease extends it ---
+    if (won > 0) {
+        if ((time_t)leaseEnd != slotStart(window, first)) {
+            leaseStart = slotStart(window, first);
+        }
+        leaseEnd = slotEnd(window, first + won - 1);
+        announceFleetState();
+    }
+    return won;
+}
+
+
+/// === claim count slots from first & wait for them to settle, only used before deep sleep ===
+static int claimSlots(const SlotWindow& window, int first, int count) {
+    sendClaim(window, first, count);
+
+    int won;
+    while ((won = settleClaim()) < 0) {
+        delay(20);
+    }
+    return won;
+}
+
+
+/// === free slots in a row from first, at most max ===
+static int freeRun(const SlotWindow& window, int first, int max) {
+    int run = 0;
+    while (first + run < window.slots && run < max && slotFree(window, first + run)) {
+        run++;
+    }
+    return run;
+}
+
+
+/// === check this unit may upload now, claiming the current slot if it is free without waiting for the claim ===
+bool fleetMayUpload() {
+    uint32_t now = time(nullptr);
+
+    /// --- coordination needs the broker, without it a unit uploads on its own after a while ---
+    if (!fleetReady()) {
+        return (now >= leaseStart && now < leaseEnd) || millis() >= fleetBrokerWait;
+    }
+
+    SlotWindow window;
+    if (!slotWindow(window, 0) || now < window.start) {
+        return false;
+    }
+    int slot = (now - window.start) / (fleetSlotMinutes * 60);
+    if (slot >= window.slots) {
+        return false;
+    }
+
+    /// --- a lease overwritten by another unit is lost ---
+    if (now >= leaseStart && now < leaseEnd) {
+        if (!slotFree(window, slot)) {
+            leaseEnd = 0;
+        }
+        else {
+            /// --- claim the next slot ahead of the lease's end, so a drain continues into it if it is free ---
+            int next = slot + 1;
+            if (claim.count == 0 && leaseEnd - now <= fleetRenewLead && (time_t)leaseEnd == slotStart(window, next) &&
+                next < window.slots && now >= lostUntil && slotFree(window, next)) {
+                sendClaim(window, next, 1);
+            }
+            if (claim.count > 0 && settleClaim() == 0) {
+                lostUntil = leaseEnd;
+            }
+            return true;
+        }
+    }
+
+    if (now < lostUntil) {
+        return false;
+    }
+
+    /// --- a claim settles over the next passes of the loop, a loss is kept until the slot ends ---
+    if (claim.count == 0) {
+        int free = 0;
+        for (int i = slot; i < window.slots; i++) {
+            free += slotFree(window, i);
+        }
+
+        int run = freeRun(window, slot, slotsWanted(free));
+        if (run == 0) {
+            lostUntil = slotEnd(window, slot);
+            DBG_PRINTLN("Upload slot held by another unit");
+            return false;
+        }
+        sendClaim(window, slot, run);
+    }
+
+    int won = settleClaim();
+    if (won < 0) {
+        return false;
+    }
+    if (won == 0) {
+        lostUntil = slotEnd(window, slot);
+        DBG_PRINTLN("Upload slot held by another unit");
+        return false;
+    }
+
+    DBG_PRINTLN("Leased upload slots until " + String(leaseEnd));
+    return now >= leaseStart && now < leaseEnd;
+}
+
+
+/// === lease upload slots ahead & wake at the first, false if none could be leased ===
+bool scheduleFleetUploadWake() {
+    /// --- a claim made by the loop is settled first, its slots are this unit's until they end if won ---
+    while (claim.count > 0 && settleClaim() < 0) {
+        delay(20);
+    }
+
+    uint32_t now = time(nullptr);
+
+    /// --- a lease still ahead stands ---
+    if (leaseStart > now) {
+        esp_sleep_enable_timer_wakeup((uint64_t)(leaseStart - now) * 1000000ULL);
+        return true;
+    }
+    if (!fleetReady()) {
+        return false;
+    }
+
+    /// --- the rest of this window, then the next ---
+    int attempts = 0;
+    for (int day = 0; day < 2 && attempts < fleetClaimAttempts; day++) {
+        SlotWindow window;
+        if (!slotWindow(window, day)) {
+            return false;
+        }
+
+        int free = 0;
+        for (int slot = 0; slot < window.slots; slot++) {
+            free += slotStart(window, slot) > now && slotFree(window, slot);
+        }
+        int wanted = slotsWanted(free);
+
+        for (int slot = 0; slot < window.slots && attempts < fleetClaimAttempts; slot++) {
+            if (slotStart(window, slot) <= now || !slotFree(window, slot)) {
+                continue;
+            }
+
+            attempts++;
+            if (claimSlots(window, slot, freeRun(window, slot, wanted)) > 0) {
+                DBG_PRINTLN("Scheduling upload wake in " + String(leaseStart - now) + " seconds");
+                esp_sleep_enable_timer_wakeup((uint64_t)(leaseStart - now) * 1000000ULL);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/// === claim a suspicious-activity alert, false if another unit already sent it ===
+bool fleetShouldAlert(uint8_t level) {
+    if (!fleetReady()) {
+        return true;
+    }
+
+    uint32_t now = time(nullptr);
+
+    portENTER_CRITICAL(&fleetMux);
+    FleetAlert alert = lastAlert;
+    portEXIT_CRITICAL(&fleetMux);
+
+    /// --- another unit alerted on the same activity, unless this one escalates ---
+    if (alert.unit != 0 && alert.unit != ownUnit() && now - alert.time < fleetAlertWindow && level <= alert.level) {
+        return false;
+    }
+
+    publishMQTT(FLEET_ALERT_TOPIC, String(fleetUnitId()) + " " + String(now) + " " + String(level), true);
+    if (!flushMQTT(fleetSettleTime)) {
+        return true;
+    }
+    delay(fleetSettleTime);
+
+    portENTER_CRITICAL(&fleetMux);
+    alert = lastAlert;
+    portEXIT_CRITICAL(&fleetMux);
+
+    return alert.unit == ownUnit() || alert.level < level;
+}
@@ -0,0 +1,191 @@
+// === standard headers ===
+// --- SD card access via SD_MMC interface ---
+#include <SD_MMC.h>
+
+// --- TCP client to the gateway ---
+#include <WiFi.h>
+
+// --- CRC-32 of the streamed file ---
+#include <esp_rom_crc.h>
+
+// --- FreeRTOS task delays ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "ingest_client.h"
+
+// --- secrets_example.h for reference ---
+#include "secrets.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- services ---
+#include "fleet.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "trace.h"
+
+
+// Every HTTPS upload to Cloudinary costs a TLS handshake & a multipart request
+// for one file. The ingest gateway (tools/ingest_gateway) runs on the LAN, so
+// one plain TCP connection carries the whole drain: files go out back to back
+// as length-prefixed frames, a CRC-32 trailer computed while streaming, &
+// the gateway acknowledges each once it is on disk. Acks trail the files by
+// up to the window agreed in the handshake, the gateway forwards the spooled
+// files to the cloud at its own pace.
+
+
+/// === little endian fields ===
+static void putU16(uint8_t* p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void putU32(uint8_t* p, uint32_t v) {
+    putU16(p, v);
+    putU16(p + 2, v >> 16);
+}
+
+static uint16_t getU16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+
+/// === read exactly len bytes before timeoutMs, false if the connection closed or stalled ===
+static bool readExact(WiFiClient& client, uint8_t* buf, size_t len, unsigned long timeoutMs) {
+    unsigned long start = millis();
+    size_t got = 0;
+
+    while (got < len) {
+        int n = client.available() > 0 ? client.read(buf + got, len - got) : 0;
+        if (n > 0) {
+            got += n;
+            continue;
+        }
+        if (!client.connected() || millis() - start >= timeoutMs) {
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    return true;
+}
+
+
+/// === check a gateway is configured in secrets ===
+bool ingestConfigured() {
+    return INGEST_HOST != nullptr && INGEST_HOST[0] != '\0';
+}
+
+
+/// === connect & say hello, window & maxBytes are what the gateway accepts ===
+bool ingestConnect(WiFiClient& client, uint16_t& window, uint32_t& maxBytes) {
+    uint32_t openSpan = traceBegin();
+    if (!client.connect(INGEST_HOST, INGEST_PORT, ingestConnectTimeout)) {
+        return false;
+    }
+
+    /// --- files are small & back to back, don't hold the trailer back ---
+    client.setNoDelay(true);
+
+    /// --- the gateway only talks to units holding its token ---
+    size_t tokenLen = min(strlen(INGEST_TOKEN), INGEST_TOKEN_LEN);
+
+    uint8_t hello[17 + INGEST_TOKEN_LEN];
+    size_t  helloLen = 17 + tokenLen;
+    putU32(hello, helloLen - 4);
+    hello[4] = INGEST_HELLO;
+    memcpy(hello + 5, "GBIG", 4);
+    hello[9] = INGEST_VERSION;
+    memcpy(hello + 10, fleetUnitId(), 6);
+    hello[16] = tokenLen;
+    memcpy(hello + 17, INGEST_TOKEN, tokenLen);
+
+    uint8_t welcome[12];
+    if (client.write(hello, helloLen) != helloLen ||
+        !readExact(client, welcome, sizeof(welcome), ingestConnectTimeout) ||
+        getU32(welcome) != sizeof(welcome) - 4 || welcome[4] != INGEST_WELCOME || welcome[5] != INGEST_VERSION) {
+        DBG_PRINTLN("Ingest gateway handshake failed");
+        client.stop();
+        return false;
+    }
+
+    traceEnd(TRACE_INGEST_OPEN, openSpan);
+
+    window   = constrain(getU16(welcome + 6), 1, INGEST_MAX_WINDOW);
+    maxBytes = getU32(welcome + 8);
+    return true;
+}
+
+
+/// === stream a file as one FILE frame & close it, false if the connection failed ===
+bool ingestSendFile(WiFiClient& client, uint32_t seq, File& file, const char* name, uint8_t* buf, size_t bufLen) {
+    size_t   nameLen = min(strlen(name), INGEST_NAME_LEN);
+    uint32_t size    = file.size();
+
+    /// --- frame header, sequence & name in one write ---
+    uint8_t head[5 + 4 + 2 + INGEST_NAME_LEN];
+    putU32(head, 1 + 4 + 2 + nameLen + size + 4);
+    head[4] = INGEST_FILE;
+    putU32(head + 5, seq);
+    putU16(head + 9, nameLen);
+    memcpy(head + 11, name, nameLen);
+
+    size_t headLen = 11 + nameLen;
+    bool   ok      = client.write(head, headLen) == headLen;
+
+    /// --- file data, the checksum covers exactly what was sent ---
+    uint32_t crc  = 0;
+    uint32_t sent = 0;
+    while (ok && sent < size) {
+        int n = file.read(buf, min(bufLen, (size_t)(size - sent)));
+        if (n <= 0) {
+            break;
+        }
+        crc  = esp_rom_crc32_le(crc, buf, n);
+        ok   = client.write(buf, n) == (size_t)n;
+        sent += n;
+    }
+    file.close();
+
+    /// --- a short read still has to fill the frame, an inverted CRC makes the gateway reject it ---
+    bool shortRead = sent < size;
+    memset(buf, 0, bufLen);
+    while (ok && sent < size) {
+        size_t n = min(bufLen, (size_t)(size - sent));
+        crc   = esp_rom_crc32_le(crc, buf, n);
+        ok    = client.write(buf, n) == n;
+        sent += n;
+    }
+
+    uint8_t trailer[4];
+    putU32(trailer, shortRead ? ~crc : crc);
+    return ok && client.write(trailer, sizeof(trailer)) == sizeof(trailer);
+}
+
+
+/// === read one ACK if it has arrived, 1 if read, 0 if none yet, -1 if the connection is gone ===
+int ingestReadAck(WiFiClient& client, uint32_t& seq, uint8_t& status) {
+    uint8_t ack[10];
+    if (client.available() < (int)sizeof(ack)) {
+        return client.connected() ? 0 : -1;
+    }
+
+    if (!readExact(client, ack, sizeof(ack), ingestAckTimeout) ||
+        getU32(ack) != sizeof(ack) - 4 || ack[4] != INGEST_ACK) {
+        DBG_PRINTLN("Malformed ingest ack");
+        return -1;
+    }
+
+    seq    = getU32(ack + 5);
+    status = ack[9];
+    return 1;
+}
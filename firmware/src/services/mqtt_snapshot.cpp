@@ -0,0 +1,92 @@
+// === standard headers ===
+// --- FreeRTOS mutexes ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "mqtt_snapshot.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- utilities ---
+#include "debug.h"
+
+
+/// === snapshot id, kept in RTC memory so ids stay unique across deep sleep ===
+RTC_DATA_ATTR static uint32_t nextSnapshotId = 0;
+
+
+/// === write a little-endian integer into a chunk header ===
+static void putLE(uint8_t* dst, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        dst[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+
+/// === publish a JPEG to the local broker as numbered binary chunks ===
+///
+/// Each chunk is published on `doorbell/snapshot/<kind>` with an 8 byte header:
+/// snapshot id (u32), chunk index (u16) & chunk count (u16), all little-endian,
+/// followed by the JPEG bytes. Chunks are sized to fit the PubSubClient buffer.
+bool publishSnapshotToMQTT(const uint8_t* jpeg, size_t len, const char* kind) {
+    if (mqttLock == nullptr || len == 0) {
+        return false;
+    }
+
+    /// --- snapshots are not queued, skip if the broker is unavailable ---
+    if (!mqttConnected()) {
+        DBG_PRINTLN("MQTT offline, snapshot skipped");
+        return false;
+    }
+
+    String topic = "doorbell/snapshot/" + String(kind);
+
+    /// --- largest chunk that fits the buffer with fixed header, topic & chunk header ---
+    size_t chunkSize = mqtt.getBufferSize() - 5 - 2 - topic.length() - SNAPSHOT_CHUNK_HEADER_LEN;
+    size_t chunkCount = (len + chunkSize - 1) / chunkSize;
+    if (chunkCount > 0xFFFF) {
+        DBG_PRINTLN("Snapshot too large to chunk");
+        return false;
+    }
+
+    /// --- do not hold up capture if the MQTT task is busy, the client is left alone while it reconnects ---
+    if (xSemaphoreTake(mqttLock, pdMS_TO_TICKS(100)) != pdTRUE) {
+        DBG_PRINTLN("MQTT busy, snapshot skipped");
+        return false;
+    }
+    if (!mqttConnected()) {
+        xSemaphoreGive(mqttLock);
+        return false;
+    }
+
+    uint32_t id = nextSnapshotId++;
+    bool ok = true;
+
+    for (size_t index = 0; index < chunkCount && ok; index++) {
+        size_t offset = index * chunkSize;
+        size_t n = min(chunkSize, len - offset);
+
+        uint8_t header[SNAPSHOT_CHUNK_HEADER_LEN];
+        putLE(header, id, 4);
+        putLE(header + 4, index, 2);
+        putLE(header + 6, chunkCount, 2);
+
+        /// --- stream header & frame bytes straight to the socket, no copy ---
+        ok = mqtt.beginPublish(topic.c_str(), SNAPSHOT_CHUNK_HEADER_LEN + n, false) &&
+             mqtt.write(header, SNAPSHOT_CHUNK_HEADER_LEN) == SNAPSHOT_CHUNK_HEADER_LEN &&
+             mqtt.write(jpeg + offset, n) == n &&
+             mqtt.endPublish();
+    }
+
+    xSemaphoreGive(mqttLock);
+
+    if (!ok) {
+        DBG_PRINTLN("Snapshot publish failed");
+    }
+
+    return ok;
+}
\ No newline at end of file
@@ -28,6 +28,7 @@
 // --- utilities ---
 #include "debug.h"
 #include "error.h"
+#include "journal.h"
 
 
 /// === WIFI client setup ===
@@ -141,17 +142,23 @@ void performFirmwareUpdateOTA(String rmtVersion) {
     }
 
     /// --- notify firmware update sucess via telegram ---
-    sendMsgToTelegram("Firmware updated sucessfully from " + FW_VERSION + " to " + rmtVersion);
+    if constexpr (featureTelegram) {
+        sendMsgToTelegram("Firmware updated sucessfully from " + FW_VERSION + " to " + rmtVersion);
 
-    delay(1000);
+        delay(1000);
 
-    /// --- send firmware update notes via telegram ---
-    sendMsgToTelegram("GuardianBell " + rmtVersion + ":\n" + updateNotes);
+        /// --- send firmware update notes via telegram ---
+        sendMsgToTelegram("GuardianBell " + rmtVersion + ":\n" + updateNotes);
 
-    delay(2000);
+        delay(2000);
+    }
     
     http.end();
 
+    /// --- the restart clears RTC memory, write the buffered journal out first ---
+    journal(JOURNAL_OTA, Update.isFinished() ? 1 : 2);
+    flushJournal();
+
     ESP.restart();
 }
 
@@ -164,6 +171,7 @@ void checkForFirmwareUpdate() {
     String remoteVersion = fetchRemoteFirmwareVersion();
     if (remoteVersion.length() == 0) {
         error("No remote firmware version available", false);
+        journal(JOURNAL_OTA, 2);
         return;
     }
 
@@ -175,6 +183,7 @@ void checkForFirmwareUpdate() {
     /// --- compare local firmware version to remote firmware version ---
     if (remoteVersion == FW_VERSION) {
         DBG_PRINTLN("Firmware up to date");
+        journal(JOURNAL_OTA, 0);
         return;
     }
     else {
@@ -5,6 +5,10 @@
 // --- HTTP client for REST requests / file download ---
 #include <HTTPClient.h>
 
+// --- FreeRTOS mutexes ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
 
 // === project headers ===
 // --- corresponding header ---
@@ -16,20 +20,65 @@
 // --- configuration ---
 #include "settings.h"
 
+// --- hardware ---
+#include "hot_tier.h"
+
 // --- network ---
 #include "wifi.h"
 
 // --- utilities ---
 #include "debug.h"
 #include "error.h"
+#include "trace.h"
 
 
 /// === WIFI client setup ===
 WiFiClientSecure telegramClient;
 
 
+/// === guards telegramClient, shared by the main loop & the notification task ===
+/// Recursive, as a fatal error() while sending notifies from the same task.
+static SemaphoreHandle_t telegramLock = nullptr;
+
+/// --- holds the lock for one request, a no-op until initTelegram() ---
+struct TelegramGuard {
+    TelegramGuard()  { if (telegramLock) xSemaphoreTakeRecursive(telegramLock, portMAX_DELAY); }
+    ~TelegramGuard() { if (telegramLock) xSemaphoreGiveRecursive(telegramLock); }
+};
+
+
+/// === create the Telegram client lock ===
+void initTelegram() {
+    telegramLock = xSemaphoreCreateRecursiveMutex();
+}
+
+
+/// === percent-encode a query parameter ===
+static String urlEncode(const String& text) {
+    static const char* hex = "0123456789ABCDEF";
+
+    String encoded;
+    encoded.reserve(text.length() * 3 / 2);
+    for (size_t i = 0; i < text.length(); i++) {
+        uint8_t c = text[i];
+        if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+            c == '-' || c == '_' || c == '.' || c == '~') {
+            encoded += (char)c;
+        }
+        else {
+            encoded += '%';
+            encoded += hex[c >> 4];
+            encoded += hex[c & 15];
+        }
+    }
+    return encoded;
+}
+
+
 /// === send error message to telegram ===
 void sendMsgToTelegram(const String& msg) {
+    TelegramGuard guard;
+
     /// --- ensure active WiFi connection ---
     initWifi();
 
@@ -40,10 +89,13 @@ void sendMsgToTelegram(const String& msg) {
     String url =
         "/bot" + String(TELEGRAM_BOT_TOKEN) +
         "/sendMessage?chat_id=" + String(TELEGRAM_CHAT_ID) +
-        "&text=" + msg;
+        "&text=" + urlEncode(msg);
 
     /// --- connect to telegram ---
-    if (!telegramClient.connect(telegramHost, 443)) {
+    uint32_t connectSpan = traceBegin();
+    bool connected = telegramClient.connect(telegramHost, 443);
+    traceEnd(TRACE_TLS_CONNECT, connectSpan);
+    if (!connected) {
         DBG_PRINTLN("ERROR: Telegram error notify failed");
         return;
     }
@@ -62,11 +114,14 @@ void sendMsgToTelegram(const String& msg) {
 
 /// === send error message to telegram with caption===
 void sendImageToTelegram(String caption) {
+    TelegramGuard guard;
+    uint32_t sendSpan = traceBegin();
+
     /// --- skip certificate validation ---
     telegramClient.setInsecure();
 
-    /// --- open latest ring capture JPEG ---
-    File file = SD_MMC.open("/IMG_" + lastRingCaptureFilename + ".jpg");
+    /// --- open latest ring capture JPEG from its storage tier ---
+    File file = storageFor(lastRingCaptureFilename).open("/IMG_" + lastRingCaptureFilename + ".jpg");
     if (!file) {
         error("Failed to open JPEG file", false);
     }
@@ -103,7 +158,10 @@ void sendImageToTelegram(String caption) {
     /// --- connect to telegram ---
     const char* telegramHost = "api.telegram.org";
     DBG_PRINTLN("Connecting to " + String(telegramHost));
-    if (!telegramClient.connect(telegramHost, 443)) {
+    uint32_t connectSpan = traceBegin();
+    bool connected = telegramClient.connect(telegramHost, 443);
+    traceEnd(TRACE_TLS_CONNECT, connectSpan);
+    if (!connected) {
         error("Telegram connection failed", true);
         file.close();
         return;
@@ -147,5 +205,183 @@ void sendImageToTelegram(String caption) {
     /// --- stop client ---
     telegramClient.stop();
 
+    traceEnd(TRACE_TELEGRAM_SEND, sendSpan);
+
     DBG_PRINTLN("JPEG sent");
+}
+
+
+/// === escape a caption for a JSON string ===
+static String jsonEscape(const String& text) {
+    String escaped;
+    escaped.reserve(text.length() + 8);
+    for (size_t i = 0; i < text.length(); i++) {
+        char c = text[i];
+        if      (c == '"')  escaped += "\\\"";
+        else if (c == '\\') escaped += "\\\\";
+        else if (c == '\n') escaped += "\\n";
+        else if (c == '\r') escaped += "\\r";
+        else                escaped += c;
+    }
+    return escaped;
+}
+
+
+/// === send several photos as one album in a single multipart request ===
+///
+/// Sizes are read up front so Content-Length is known before the first byte is
+/// sent; each photo is then streamed from memory or in 1 KB reads from the SD
+/// card, so no image is ever buffered whole. A single photo falls back to
+/// sendPhoto, which Telegram requires for albums of one.
+bool sendMediaGroupToTelegram(const TelegramMedia* media, int count, const String& caption) {
+    if (count < 1 || count > TELEGRAM_MEDIA_GROUP_MAX) {
+        error("Invalid Telegram album size", false);
+        return false;
+    }
+
+    TelegramGuard guard;
+    uint32_t sendSpan = traceBegin();
+
+    /// --- skip certificate validation ---
+    telegramClient.setInsecure();
+
+    /// --- size of every photo, opening SD files only briefly ---
+    size_t sizes[TELEGRAM_MEDIA_GROUP_MAX];
+    for (int i = 0; i < count; i++) {
+        if (media[i].buf != nullptr) {
+            sizes[i] = media[i].len;
+            continue;
+        }
+
+        File file = SD_MMC.open(media[i].path);
+        if (!file) {
+            error("Failed to open JPEG file", false);
+            return false;
+        }
+        sizes[i] = file.size();
+        file.close();
+    }
+
+    bool   album    = count > 1;
+    String url      = "/bot" + String(TELEGRAM_BOT_TOKEN) + (album ? "/sendMediaGroup" : "/sendPhoto");
+    String boundary = "----ESP32CAMBoundary";
+
+    /// --- build multipart head, an album describes its photos as JSON attachments ---
+    String head =
+        "--" + boundary + "\r\n"
+        "Content-Disposition: form-data; name=\"chat_id\"\r\n\r\n" +
+        String(TELEGRAM_CHAT_ID) + "\r\n";
+
+    if (album) {
+        String items = "[";
+        for (int i = 0; i < count; i++) {
+            items += (i ? ",{" : "{");
+            items += "\"type\":\"photo\",\"media\":\"attach://photo" + String(i) + "\"";
+            /// --- Telegram shows the caption of the first photo for the album ---
+            if (i == 0) {
+                items += ",\"caption\":\"" + jsonEscape(caption) + "\"";
+            }
+            items += "}";
+        }
+        items += "]";
+
+        head += "--" + boundary + "\r\n"
+                "Content-Disposition: form-data; name=\"media\"\r\n\r\n" +
+                items + "\r\n";
+    }
+    else {
+        head += "--" + boundary + "\r\n"
+                "Content-Disposition: form-data; name=\"caption\"\r\n\r\n" +
+                caption + "\r\n";
+    }
+
+    /// --- header of each photo part ---
+    String partHeads[TELEGRAM_MEDIA_GROUP_MAX];
+    for (int i = 0; i < count; i++) {
+        String name = album ? "photo" + String(i) : String("photo");
+        partHeads[i] =
+            (i ? "\r\n--" : "--") + boundary + "\r\n"
+            "Content-Disposition: form-data; name=\"" + name + "\"; filename=\"doorbell" + String(i) + ".jpg\"\r\n"
+            "Content-Type: image/jpeg\r\n\r\n";
+    }
+
+    /// --- build multipart tail ---
+    String tail = "\r\n--" + boundary + "--\r\n";
+
+    /// --- determine total size of content ---
+    uint32_t totalLength = head.length() + tail.length();
+    for (int i = 0; i < count; i++) {
+        totalLength += partHeads[i].length() + sizes[i];
+    }
+
+    /// --- connect to telegram ---
+    DBG_PRINTLN("Connecting to " + String(telegramHost));
+    uint32_t connectSpan = traceBegin();
+    bool connected = telegramClient.connect(telegramHost, 443);
+    traceEnd(TRACE_TLS_CONNECT, connectSpan);
+    if (!connected) {
+        error("Telegram connection failed", false);
+        return false;
+    }
+
+    /// --- send HTTP POST headers ---
+    telegramClient.print(
+        "POST " + url + " HTTP/1.1\r\n"
+        "Host: " + String(telegramHost) + "\r\n"
+        "Content-Type: multipart/form-data; boundary=" + boundary + "\r\n"
+        "Content-Length: " + String(totalLength) + "\r\n"
+        "Connection: close\r\n\r\n"
+    );
+
+    /// --- send multipart head ---
+    telegramClient.print(head);
+
+    /// --- stream every photo ---
+    DBG_PRINTLN("Sending " + String(count) + " JPEGs to telegram...");
+    uint8_t buf[1024];
+    bool ok = true;
+    for (int i = 0; i < count && ok; i++) {
+        telegramClient.print(partHeads[i]);
+
+        if (media[i].buf != nullptr) {
+            ok = telegramClient.write(media[i].buf, media[i].len) == media[i].len;
+            continue;
+        }
+
+        /// --- a file that changed since it was sized would corrupt the request ---
+        File file = SD_MMC.open(media[i].path);
+        size_t sent = 0;
+        while (file && file.available() && sent < sizes[i]) {
+            int n = file.read(buf, min(sizeof(buf), sizes[i] - sent));
+            if (n <= 0 || telegramClient.write(buf, n) != (size_t)n) break;
+            sent += n;
+        }
+        file.close();
+        ok = sent == sizes[i];
+    }
+
+    if (!ok) {
+        error("Telegram album upload interrupted", false);
+        telegramClient.stop();
+        return false;
+    }
+
+    /// --- send multipart tail ---
+    telegramClient.print(tail);
+
+    /// --- read telegram response ---
+    DBG_PRINTLN("Telegram response:");
+    while (telegramClient.connected()) {
+        String line = telegramClient.readStringUntil('\n');
+        if (line == "\r") break;
+    }
+    String body = telegramClient.readString();
+    DBG_PRINTLN(body);
+
+    /// --- stop client ---
+    telegramClient.stop();
+
+    traceEnd(TRACE_TELEGRAM_SEND, sendSpan);
+
+    return body.indexOf("\"ok\":true") >= 0;
 }
\ No newline at end of file
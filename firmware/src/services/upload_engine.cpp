@@ -0,0 +1,451 @@
+// === standard headers ===
+// --- SD card access via SD_MMC interface ---
+#include <SD_MMC.h>
+
+// --- TLS/SSL client for secure HTTPS connections ---
+#include <WiFiClientSecure.h>
+
+// --- plain TCP client to the LAN ingest gateway ---
+#include <WiFi.h>
+
+// --- PSRAM allocation ---
+#include <esp_heap_caps.h>
+
+// --- FreeRTOS tasks & queues ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "upload_engine.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- network ---
+#include "wifi.h"
+#include "mqtt.h"
+
+// --- services ---
+#include "cloudinary.h"
+#include "ingest_client.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "error.h"
+
+
+// A drain is limited by round trips, not bandwidth: every upload waits for a
+// TLS handshake & the server's response. One worker task per connection takes
+// paths from a queue and uploads them, so several handshakes & responses
+// overlap. Workers above the current connection count sit out; the count is
+// moved one step every uploadTuneWindow uploads, keeping its direction while
+// throughput improves & turning back once it doesn't. The chosen count is kept
+// in RTC memory for the next drain. SD reads go through a PSRAM chunk buffer
+// per connection; the TLS record buffers are above the PSRAM malloc threshold
+// & land there as well. Results are handed back to the caller, which owns the
+// manifest & every SD delete. With a LAN ingest gateway configured, a single
+// worker streams the drain over one connection instead, keeping a window of
+// files in flight & posting each result as its ack arrives; if the gateway
+// can't be reached, the drain falls back to the Cloudinary workers. A file
+// larger than the gateway takes goes to Cloudinary from the gateway worker,
+// once the acks in flight are in.
+
+
+/// === one queued file ===
+struct UploadJob {
+    char path[UPLOAD_PATH_LEN];
+};
+
+
+// === connections ===
+static WiFiClientSecure uploadClients[UPLOAD_MAX_CONNECTIONS];
+
+/// --- allocated on the first drain & kept, so PSRAM doesn't fragment ---
+static uint8_t* uploadChunks[UPLOAD_MAX_CONNECTIONS];
+
+/// --- connections allowed to take work, tuned during a drain ---
+RTC_DATA_ATTR static int connections = UPLOAD_MIN_CONNECTIONS;
+
+/// --- worker tasks alive, they exit once stopping is set & no work is left ---
+static int           workers  = 0;
+static volatile bool stopping = false;
+
+/// --- least stack left unused by a worker of the drain, reported when it ends ---
+static uint32_t stackHeadroom = TLS_TASK_STACK;
+
+static portMUX_TYPE engineMux = portMUX_INITIALIZER_UNLOCKED;
+
+static QueueHandle_t jobQueue    = nullptr;
+static QueueHandle_t resultQueue = nullptr;
+
+
+// === LAN ingest gateway, replaces the connections for a whole drain ===
+static WiFiClient ingestClient;
+static bool       ingesting      = false;
+static uint16_t   ingestWindow   = 1;
+static uint32_t   ingestMaxBytes = 0;
+
+/// --- a file sent & waiting for its ack ---
+struct IngestPending {
+    UploadResult  result;
+    uint32_t      seq;
+    unsigned long sentAt;
+};
+
+
+// === throughput, only touched by the draining task ===
+/// --- current tuning sample ---
+static uint32_t      sampleFiles = 0;
+static uint32_t      sampleBytes = 0;
+static unsigned long sampleStart = 0;
+static float         lastRate    = 0;
+static int           direction   = 1;
+
+/// --- whole drain ---
+static uint32_t      drainFiles = 0;
+static uint32_t      drainBytes = 0;
+static unsigned long drainStart = 0;
+
+
+/// === upload one file to Cloudinary over a slot's connection & chunk buffer ===
+static void uploadToCloudinary(int slot, const UploadJob& job, UploadResult& result) {
+    strncpy(result.path, job.path, UPLOAD_PATH_LEN);
+    result.ok    = false;
+    result.bytes = 0;
+    unsigned long startMs = millis();
+
+    File file = SD_MMC.open(job.path, FILE_READ);
+    if (file) {
+        const char* slash = strrchr(job.path, '/');
+        result.bytes = file.size();
+        result.ok    = postImageToCloudinary(uploadClients[slot], file, slash ? slash + 1 : job.path,
+                                             uploadChunks[slot], UPLOAD_CHUNK_SIZE) == 200;
+    }
+    result.ms = millis() - startMs;
+}
+
+
+/// === upload queued files over one connection until stopped ===
+static void uploadWorker(void* param) {
+    int slot = (int)(intptr_t)param;
+    UploadJob job;
+
+    while (true) {
+        /// --- connections above the tuned count sit out ---
+        bool allowed = slot < connections;
+        if (!allowed || xQueueReceive(jobQueue, &job, pdMS_TO_TICKS(50)) != pdTRUE) {
+            if (stopping) {
+                break;
+            }
+            if (!allowed) {
+                vTaskDelay(pdMS_TO_TICKS(50));
+            }
+            continue;
+        }
+
+        UploadResult result;
+        uploadToCloudinary(slot, job, result);
+        xQueueSend(resultQueue, &result, portMAX_DELAY);
+    }
+
+    portENTER_CRITICAL(&engineMux);
+    stackHeadroom = min(stackHeadroom, (uint32_t)uxTaskGetStackHighWaterMark(nullptr));
+    workers--;
+    portEXIT_CRITICAL(&engineMux);
+
+    vTaskDelete(nullptr);
+}
+
+
+/// === stream queued files to the gateway, a window ahead of the acks, until stopped ===
+static void ingestWorker(void* param) {
+    IngestPending pending[INGEST_MAX_WINDOW];
+    int      head    = 0;
+    int      count   = 0;
+    uint32_t nextSeq = 0;
+    bool     broken  = false;
+    UploadJob job;
+
+    /// --- a file the gateway won't take, held until the window is empty ---
+    bool oversized = false;
+
+    while (true) {
+        bool progress = false;
+
+        /// --- nothing waits on an ack any more, so a slow Cloudinary upload can't time the gateway out ---
+        if (oversized && count == 0) {
+            UploadResult result;
+            uploadToCloudinary(0, job, result);
+            xQueueSend(resultQueue, &result, portMAX_DELAY);
+            oversized = false;
+            progress  = true;
+        }
+
+        /// --- send the next file while the window has room, a broken connection fails it at once ---
+        if (!oversized && count < ingestWindow &&
+            xQueueReceive(jobQueue, &job, pdMS_TO_TICKS(count > 0 ? 0 : 50)) == pdTRUE) {
+            progress = true;
+
+            IngestPending& sent = pending[(head + count) % INGEST_MAX_WINDOW];
+            strncpy(sent.result.path, job.path, UPLOAD_PATH_LEN);
+            sent.result.ok    = false;
+            sent.result.bytes = 0;
+            sent.seq    = nextSeq;
+            sent.sentAt = millis();
+
+            bool inFlight = false;
+            File file = broken ? File() : SD_MMC.open(job.path, FILE_READ);
+            if (file && file.size() > ingestMaxBytes) {
+                DBG_PRINTLN("Too large for the ingest gateway, uploading to Cloudinary " + String(job.path));
+                file.close();
+                oversized = true;
+            }
+            else if (file) {
+                const char* slash = strrchr(job.path, '/');
+                sent.result.bytes = file.size();
+                broken = !ingestSendFile(ingestClient, nextSeq++, file, slash ? slash + 1 : job.path,
+                                         uploadChunks[0], UPLOAD_CHUNK_SIZE);
+                inFlight = !broken;
+            }
+
+            if (inFlight) {
+                count++;
+            }
+            else if (!oversized) {
+                sent.result.ms = millis() - sent.sentAt;
+                xQueueSend(resultQueue, &sent.result, portMAX_DELAY);
+            }
+        }
+
+        /// --- acks come back in file order ---
+        uint32_t seq;
+        uint8_t  status;
+        int      got = 0;
+        while (count > 0 && !broken && (got = ingestReadAck(ingestClient, seq, status)) == 1) {
+            IngestPending& acked = pending[head];
+            if (seq != acked.seq) {
+                broken = true;
+                break;
+            }
+            acked.result.ok = status == INGEST_STORED;
+            acked.result.ms = millis() - acked.sentAt;
+            xQueueSend(resultQueue, &acked.result, portMAX_DELAY);
+
+            head = (head + 1) % INGEST_MAX_WINDOW;
+            count--;
+            progress = true;
+        }
+
+        if (got < 0 || (count > 0 && millis() - pending[head].sentAt > ingestAckTimeout)) {
+            DBG_PRINTLN("Ingest gateway stopped answering");
+            broken = true;
+        }
+
+        /// --- files without an ack may not have reached the disk, fail them ---
+        if (broken && count > 0) {
+            ingestClient.stop();
+            while (count > 0) {
+                pending[head].result.ms = millis() - pending[head].sentAt;
+                xQueueSend(resultQueue, &pending[head].result, portMAX_DELAY);
+                head = (head + 1) % INGEST_MAX_WINDOW;
+                count--;
+            }
+        }
+
+        if (!progress) {
+            if (stopping && count == 0) {
+                break;
+            }
+            if (count > 0) {
+                vTaskDelay(pdMS_TO_TICKS(2));
+            }
+        }
+    }
+
+    ingestClient.stop();
+
+    portENTER_CRITICAL(&engineMux);
+    stackHeadroom = min(stackHeadroom, (uint32_t)uxTaskGetStackHighWaterMark(nullptr));
+    workers--;
+    portEXIT_CRITICAL(&engineMux);
+
+    vTaskDelete(nullptr);
+}
+
+
+/// === connect to the gateway & start its worker, false to fall back to the Cloudinary workers ===
+static bool startIngest() {
+    if (uploadChunks[0] == nullptr) {
+        uploadChunks[0] = (uint8_t*)heap_caps_malloc(UPLOAD_CHUNK_SIZE, MALLOC_CAP_SPIRAM);
+    }
+    if (uploadChunks[0] == nullptr || !ingestConnect(ingestClient, ingestWindow, ingestMaxBytes)) {
+        error("Ingest gateway unreachable, uploading to Cloudinary", false);
+        return false;
+    }
+
+    if (xTaskCreatePinnedToCore(ingestWorker, "ingest", TLS_TASK_STACK, nullptr, 1, nullptr, 0) != pdPASS) {
+        ingestClient.stop();
+        return false;
+    }
+
+    portENTER_CRITICAL(&engineMux);
+    workers++;
+    portEXIT_CRITICAL(&engineMux);
+
+    return true;
+}
+
+
+/// === start a worker per connection, or the gateway worker, for one drain ===
+bool startUploads() {
+    if (jobQueue == nullptr) {
+        jobQueue    = xQueueCreate(UPLOAD_QUEUE_LEN, sizeof(UploadJob));
+        resultQueue = xQueueCreate(UPLOAD_QUEUE_LEN + UPLOAD_MAX_CONNECTIONS, sizeof(UploadResult));
+        if (jobQueue == nullptr || resultQueue == nullptr) {
+            error("Failed to create upload queues", false);
+            return false;
+        }
+    }
+
+    stopping      = false;
+    stackHeadroom = TLS_TASK_STACK;
+
+    /// --- one pipelined connection to the gateway replaces every TLS connection ---
+    ingesting = ingestConfigured() && startIngest();
+
+    for (int slot = 0; !ingesting && slot < UPLOAD_MAX_CONNECTIONS; slot++) {
+        if (uploadChunks[slot] == nullptr) {
+            uploadChunks[slot] = (uint8_t*)heap_caps_malloc(UPLOAD_CHUNK_SIZE, MALLOC_CAP_SPIRAM);
+        }
+        if (uploadChunks[slot] == nullptr ||
+            xTaskCreatePinnedToCore(uploadWorker, "upload", TLS_TASK_STACK, (void*)(intptr_t)slot, 1, nullptr, 0) != pdPASS) {
+            break;
+        }
+
+        portENTER_CRITICAL(&engineMux);
+        workers++;
+        portEXIT_CRITICAL(&engineMux);
+    }
+
+    if (workers == 0) {
+        error("Failed to start upload workers", false);
+        return false;
+    }
+
+    if (!ingesting) {
+        connections = constrain(connections, min(UPLOAD_MIN_CONNECTIONS, workers), workers);
+    }
+
+    sampleFiles = 0;
+    sampleBytes = 0;
+    sampleStart = millis();
+    lastRate    = 0;
+    direction   = 1;
+    drainFiles  = 0;
+    drainBytes  = 0;
+    drainStart  = millis();
+
+    return true;
+}
+
+
+/// === queue a file, a path that doesn't fit a job is rejected & never produces a result ===
+UploadSubmit submitUpload(const String& path) {
+    UploadJob job;
+    if (path.length() >= UPLOAD_PATH_LEN) {
+        error("Upload path too long " + path, false);
+        return UPLOAD_REJECTED;
+    }
+    memcpy(job.path, path.c_str(), path.length() + 1);
+
+    return xQueueSend(jobQueue, &job, 0) == pdTRUE ? UPLOAD_QUEUED : UPLOAD_QUEUE_FULL;
+}
+
+
+/// === move the connection count one step, turning back once throughput stops improving ===
+static void tuneConnections() {
+    float rate = sampleBytes / (float)max(1UL, millis() - sampleStart);
+
+    if (lastRate > 0 && rate < lastRate * (1.0f + uploadTuneGain)) {
+        direction = -direction;
+    }
+    lastRate = rate;
+
+    int limit = min(workers, UPLOAD_MAX_CONNECTIONS);
+    connections = constrain(connections + direction, min(UPLOAD_MIN_CONNECTIONS, limit), limit);
+
+    DBG_PRINTF("Upload %.1f kB/s, %d connections\n", rate, connections);
+
+    sampleFiles = 0;
+    sampleBytes = 0;
+    sampleStart = millis();
+}
+
+
+/// === wait up to waitMs for a finished upload ===
+bool nextUploadResult(UploadResult& result, unsigned long waitMs) {
+    if (xQueueReceive(resultQueue, &result, pdMS_TO_TICKS(waitMs)) != pdTRUE) {
+        return false;
+    }
+
+    if (result.ok) {
+        drainFiles++;
+        drainBytes += result.bytes;
+        sampleFiles++;
+        sampleBytes += result.bytes;
+    }
+    if (!ingesting && sampleFiles >= (uint32_t)uploadTuneWindow) {
+        tuneConnections();
+    }
+
+    return true;
+}
+
+
+/// === drop queued files that haven't started, returns how many ===
+int cancelUploads() {
+    UploadJob job;
+    int cancelled = 0;
+    while (xQueueReceive(jobQueue, &job, 0) == pdTRUE) {
+        cancelled++;
+    }
+    return cancelled;
+}
+
+
+/// === end a drain once every result is collected, the workers exit & release their connections ===
+void stopUploads() {
+    stopping = true;
+
+    while (true) {
+        portENTER_CRITICAL(&engineMux);
+        int alive = workers;
+        portEXIT_CRITICAL(&engineMux);
+        if (alive == 0) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    DBG_PRINTF("Upload worker stack headroom %u bytes\n", stackHeadroom);
+
+    unsigned long ms = millis() - drainStart;
+    if (drainFiles > 0) {
+        publishMQTT("doorbell/upload",
+            "{\"files\":" + String(drainFiles) +
+            ",\"bytes\":" + String(drainBytes) +
+            ",\"ms\":" + String(ms) +
+            ",\"kbps\":" + String((uint32_t)(drainBytes * 8ULL / max(1UL, ms))) +
+            ",\"connections\":" + String(connections) +
+            ",\"gateway\":" + String(ingesting ? 1 : 0) + "}");
+    }
+}
+
+
+/// === connections currently allowed to upload ===
+int uploadConnections() {
+    return connections;
+}
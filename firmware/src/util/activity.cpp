@@ -0,0 +1,146 @@
+// === standard headers ===
+// --- system time functions ---
+#include <time.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "activity.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- utilities ---
+#include "debug.h"
+
+
+// Motion detections are counted in an exponentially decayed counter kept in
+// RTC memory, so the suspicious activity thresholds see every detection of
+// the last activityHalfLife-ish seconds, however many wakes they took. The
+// decay is applied lazily from the wall clock, which keeps running through
+// deep sleep: each event or query costs one exp2f.
+
+
+// === state kept through deep sleep ===
+/// --- decayed detections as of activityAt ---
+RTC_DATA_ATTR static float    activity   = 0;
+RTC_DATA_ATTR static time_t   activityAt = 0;
+
+/// --- alert multiples raised & not yet re-armed, one bit each ---
+RTC_DATA_ATTR static uint8_t  alertsRaised = 0;
+
+/// --- detections per local hour of the day ---
+RTC_DATA_ATTR static uint16_t hourly[ACTIVITY_HOURS];
+
+/// --- detections since power on ---
+RTC_DATA_ATTR static uint32_t totalDetections = 0;
+
+
+/// === wall clock before NTP sync starts at 1970, which is still monotonic ===
+static inline bool timeSynced(time_t now) {
+    return now > 1577836800;
+}
+
+
+/// === bring the counter forward to now ===
+static void decayTo(time_t now) {
+    /// --- a sync that rebaseActivity() didn't see, e.g. a late SNTP reply, is a jump not elapsed time ---
+    if (!timeSynced(activityAt) && timeSynced(now)) {
+        activityAt = now;
+    }
+
+    /// --- a clock that jumps back (e.g. an NTP correction) doesn't add activity ---
+    if (now > activityAt) {
+        activity *= exp2f(-(float)(now - activityAt) / activityHalfLife);
+    }
+    activityAt = now;
+
+    /// --- negligible leftovers are flushed so the counter can't decay forever ---
+    if (activity < 0.01f) {
+        activity = 0;
+    }
+}
+
+
+/// === move a timestamp taken on the unsynced clock across the first NTP sync, from & to are the same instant ===
+void rebaseActivity(time_t from, time_t to) {
+    if (!timeSynced(activityAt) && !timeSynced(from) && timeSynced(to)) {
+        activityAt += to - from;
+    }
+}
+
+
+/// === count one confirmed motion detection ===
+void recordActivity() {
+    time_t now = time(nullptr);
+
+    decayTo(now);
+    activity += 1.0f;
+    totalDetections++;
+
+    /// --- halve the histogram when a bucket would overflow, keeping its shape ---
+    if (timeSynced(now)) {
+        struct tm local;
+        localtime_r(&now, &local);
+        if (hourly[local.tm_hour] == UINT16_MAX) {
+            for (int h = 0; h < ACTIVITY_HOURS; h++) {
+                hourly[h] /= 2;
+            }
+        }
+        hourly[local.tm_hour]++;
+    }
+}
+
+
+/// === decayed number of recent motion detections ===
+float activityLevel() {
+    decayTo(time(nullptr));
+    return activity;
+}
+
+
+/// === true once each time activity rises above multiple x acceptableDetections ===
+bool activityAlert(int multiple) {
+    float   level = activityLevel();
+    float   limit = (float)multiple * acceptableDetections;
+    uint8_t bit   = 1 << (multiple - 1);
+
+    /// --- re-arm only once activity has fallen to half the limit, so a level hovering around it alerts once ---
+    if (level <= limit / 2) {
+        alertsRaised &= ~bit;
+        return false;
+    }
+
+    if (level > limit && !(alertsRaised & bit)) {
+        alertsRaised |= bit;
+        return true;
+    }
+
+    return false;
+}
+
+
+/// === publish the activity level & its daily profile, one digit per hour ===
+void publishActivity() {
+    uint16_t peak = 1;
+    for (int h = 0; h < ACTIVITY_HOURS; h++) {
+        peak = max(peak, hourly[h]);
+    }
+
+    char profile[ACTIVITY_HOURS + 1];
+    for (int h = 0; h < ACTIVITY_HOURS; h++) {
+        profile[h] = '0' + (hourly[h] * 9 + peak - 1) / peak;
+    }
+    profile[ACTIVITY_HOURS] = '\0';
+
+    DBG_PRINT("Activity level: ");
+    DBG_PRINTLN(activityLevel());
+
+    publishMQTT("doorbell/activity",
+        "{\"level\":" + String(activityLevel(), 2) +
+        ",\"total\":" + String(totalDetections) +
+        ",\"hours\":\"" + profile + "\"}");
+}
@@ -0,0 +1,75 @@
+// === standard headers ===
+// --- ESP32-CAM driver ---
+#include <esp_camera.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "burst_capture.h"
+
+// --- hardware ---
+#include "frame_pool.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "capture_save_image.h"
+#include "sharpness.h"
+#include "trace.h"
+
+
+/// === capture a burst into the frame pool & pick its sharpest frame ===
+bool captureBurst(Burst& burst, int frames, unsigned long intervalMs) {
+    burst.count = 0;
+    burst.best  = -1;
+
+    /// --- discard the stale frame the driver kept while idle ---
+    camera_fb_t* fb = esp_camera_fb_get();
+    if (fb) esp_camera_fb_return(fb);
+
+    /// --- capture first, score afterwards so frames stay close together ---
+    frames = min(frames, BURST_MAX_FRAMES);
+    for (int i = 0; i < frames; i++) {
+        uint32_t span = traceBegin();
+        PooledFrame* frame = captureFrame();
+        traceEnd(TRACE_CAMERA_FB_GET, span);
+
+        /// --- pool exhausted or no PSRAM: score what was captured ---
+        if (frame == nullptr) {
+            break;
+        }
+        burst.frames[burst.count++] = frame;
+
+        if (i + 1 < frames) {
+            delay(intervalMs);
+        }
+    }
+
+    /// --- score every frame, keeping the sharpest ---
+    uint32_t span = traceBegin();
+    for (int i = 0; i < burst.count; i++) {
+        burst.scores[i] = jpegSharpness(burst.frames[i]->buf, burst.frames[i]->len);
+        if (burst.best < 0 || burst.scores[i] > burst.scores[burst.best]) {
+            burst.best = i;
+        }
+
+        DBG_PRINT("Burst frame " + String(i) + " sharpness ");
+        DBG_PRINTLN(burst.scores[i]);
+    }
+    traceEnd(TRACE_SHARPNESS, span);
+
+    return burst.count > 0;
+}
+
+
+/// === archive the frames that were not picked to SD card, then release the whole burst ===
+void releaseBurst(Burst& burst, const String& archivePrefix) {
+    for (int i = 0; i < burst.count; i++) {
+        if (i != burst.best && archivePrefix.length() > 0) {
+            saveFrame(burst.frames[i], archivePrefix + "_burst" + String(i));
+        }
+        releaseFrame(burst.frames[i]);
+    }
+
+    burst.count = 0;
+    burst.best  = -1;
+}
@@ -15,15 +15,74 @@
 
 // --- hardware ---
 #include "camera.h"
+#include "frame_pool.h"
 #include "microSD_card.h"
+#include "hot_tier.h"
+
+// --- services ---
+#include "mqtt_snapshot.h"
 
 // --- utilities ---
 #include "debug.h"
+#include "capture_session.h"
 #include "error.h"
+#include "person_detect.h"
+#include "motion_detect.h"
+#include "trace.h"
+
+
+/// === save a captured frame to its storage tier, optionally publishing it to the local broker ===
+bool saveFrame(const PooledFrame* frame, const String& filename, const char* snapshotKind) {
+    /// --- set path of JPEG file within the current session ---
+    String path = capturePath(filename);
+    DBG_PRINTF("Picture file name: %s\n", path.c_str());
+
+    /// --- the latest ring capture goes to the LittleFS hot tier, everything else to SD ---
+    fs::FS &fs = storageFor(filename);
+    bool onFlash = hotTierMounted() && &fs != &SD_MMC;
+    TracePhase openPhase  = onFlash ? TRACE_FLASH_OPEN  : TRACE_SD_OPEN;
+    TracePhase writePhase = onFlash ? TRACE_FLASH_WRITE : TRACE_SD_WRITE;
+    TracePhase closePhase = onFlash ? TRACE_FLASH_CLOSE : TRACE_SD_CLOSE;
+
+    /// --- open file for writing ---
+    uint32_t span = traceBegin();
+    File file = fs.open(path.c_str(), FILE_WRITE);
+    traceEnd(openPhase, span);
+
+    /// --- write captured frame to file as JPEG ---
+    bool saved = false;
+    if (!file) {
+        DBG_PRINTF("Failed to open file in writing mode\n");
+        // error("Failed to open file in writing mode");
+    } 
+    else {
+        span = traceBegin();
+        saved = file.write(frame->buf, frame->len) == frame->len;
+        traceEnd(writePhase, span);
+        DBG_PRINTF("Saved: %s\n", path.c_str());
+    }
+
+    /// --- close file ---
+    span = traceBegin();
+    file.close();
+    traceEnd(closePhase, span);
+
+    /// --- only a complete file joins the upload backlog ---
+    if (saved) {
+        captureSaved(filename);
+    }
+
+    /// --- publish frame to Home Assistant over MQTT ---
+    if (snapshotKind != nullptr) {
+        publishSnapshotToMQTT(frame->buf, frame->len, snapshotKind);
+    }
 
+    return saved;
+}
 
-/// === capture & save image to SD card===
-void captureAndSaveImage(String filename) {
+
+/// === capture & save image to SD card, optionally publishing it to the local broker & scoring it for a person & motion, false if no frame was saved ===
+bool captureAndSaveImage(String filename, const char* snapshotKind, int* personScore, int* motionScore) {
     
     /// --- discard first frame ---
     camera_fb_t *fb = esp_camera_fb_get();
@@ -32,32 +91,37 @@ void captureAndSaveImage(String filename) {
     /// --- delay for stability ---
     delay(50);
     
-    /// --- capture image as JPEG ---
-    fb = esp_camera_fb_get();
-    if (!fb) {
-        DBG_PRINTLN("capture failed");
-        error("Capture failed", true);
+    /// --- capture image as JPEG into the frame pool ---
+    uint32_t span = traceBegin();
+    PooledFrame* frame = captureFrame();
+
+    /// --- a full pool or a borrowed frame still in use by the stream frees up quickly, retry once ---
+    if (!frame) {
+        delay(captureRetryDelay);
+        frame = captureFrame();
     }
+    traceEnd(TRACE_CAMERA_FB_GET, span);
 
-    /// --- set path of JPEG file ---
-    String path = "/IMG_" + filename + ".jpg";
-    Serial.printf("Picture file name: %s\n", path.c_str());
+    /// --- a missed frame is not worth halting the doorbell, the caller carries on without it ---
+    if (!frame) {
+        error("Capture failed, frame skipped", false);
+        return false;
+    }
 
-    /// --- open file for writing ---
-    fs::FS &fs = SD_MMC;
-    File file = fs.open(path.c_str(), FILE_WRITE);
+    bool saved = saveFrame(frame, filename, snapshotKind);
 
-    /// --- write captured frame to file as JPEG ---
-    if (!file) {
-        Serial.printf("Failed to open file in writing mode");
-        // error("Failed to open file in writing mode");
-    } 
-    else {
-        file.write(fb->buf, fb->len);
-        Serial.printf("Saved: %s\n", path.c_str());
+    /// --- classify while the frame is still held, -1 if there is no model ---
+    if (personScore != nullptr) {
+        *personScore = personScoreJpeg(frame->buf, frame->len);
     }
 
-    /// --- close file & return frame buffer ---
-    file.close();
-    esp_camera_fb_return(fb);
+    /// --- compare with the previous frame, -1 for the first ---
+    if (motionScore != nullptr) {
+        *motionScore = frameMotionScore(frame->buf, frame->len);
+    }
+
+    /// --- return frame to the pool ---
+    releaseFrame(frame);
+
+    return saved;
 }
\ No newline at end of file
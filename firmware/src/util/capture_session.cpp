@@ -0,0 +1,229 @@
+// === standard headers ===
+// --- SD card access via SD_MMC interface ---
+#include <SD_MMC.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "capture_session.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "error.h"
+
+
+// === session state ===
+/// --- number of the current session, kept over deep sleep ---
+RTC_DATA_ATTR static uint32_t sessionSeq = 0;
+
+/// --- number given to the next directory moved to the trash ---
+RTC_DATA_ATTR static uint32_t trashSeq = 0;
+
+/// --- captures waiting for upload, recounted from the card after power loss ---
+RTC_DATA_ATTR static uint32_t pending = 0;
+
+/// --- the session directory is only created by its first capture ---
+static bool sessionCreated = false;
+
+
+/// === directory of a session number ===
+static String sessionDir(uint32_t seq) {
+    char name[16];
+    snprintf(name, sizeof(name), "/S%06u", (unsigned)seq);
+    return String(SESSIONS_ROOT) + name;
+}
+
+
+/// === highest number in names like S000042 or T000042 within dir ===
+static uint32_t highestSeq(const char* dir) {
+    uint32_t highest = 0;
+
+    File root = SD_MMC.open(dir);
+    File entry = root ? root.openNextFile() : File();
+    while (entry) {
+        uint32_t seq = strtoul(entry.name() + 1, nullptr, 10);
+        if (seq > highest) {
+            highest = seq;
+        }
+        entry = root.openNextFile();
+    }
+
+    return highest;
+}
+
+
+/// === move a file or directory into the trash, a single directory entry update ===
+static bool moveToTrash(const String& path) {
+    char name[16];
+    snprintf(name, sizeof(name), "/T%06u", (unsigned)++trashSeq);
+    return SD_MMC.rename(path, String(TRASH_ROOT) + name);
+}
+
+
+/// === number of captures in the session directories ===
+static uint32_t countCaptures() {
+    uint32_t count = 0;
+
+    File root = SD_MMC.open(SESSIONS_ROOT);
+    File session = root ? root.openNextFile() : File();
+    while (session) {
+        if (session.isDirectory()) {
+            File entry = session.openNextFile();
+            while (entry) {
+                count += !entry.isDirectory();
+                entry = session.openNextFile();
+            }
+        }
+        session = root.openNextFile();
+    }
+
+    return count;
+}
+
+
+/// === create the session & trash roots & open a session for this wake ===
+void initSessions() {
+    SD_MMC.mkdir(SESSIONS_ROOT);
+    SD_MMC.mkdir(TRASH_ROOT);
+
+    /// --- after power loss continue numbering past everything still on the card ---
+    if (sessionSeq == 0) {
+        sessionSeq = highestSeq(SESSIONS_ROOT);
+        trashSeq   = highestSeq(TRASH_ROOT);
+        pending    = countCaptures();
+    }
+
+    beginSession();
+}
+
+
+/// === start a new session, its directory appears with the first capture ===
+void beginSession() {
+    sessionSeq++;
+    sessionCreated = false;
+}
+
+
+/// === SD card path of a capture, the latest ring capture stays in the root ===
+String capturePath(const String& filename) {
+    if (filename == lastRingCaptureFilename) {
+        return "/IMG_" + filename + ".jpg";
+    }
+
+    String dir = sessionDir(sessionSeq);
+    if (!sessionCreated) {
+        SD_MMC.mkdir(dir);
+        sessionCreated = true;
+    }
+
+    return dir + "/IMG_" + filename + ".jpg";
+}
+
+
+/// === drop a fully uploaded session in one rename ===
+void retireSession(const String& dir) {
+    if (!moveToTrash(dir)) {
+        error("Failed to retire session " + dir, false);
+        return;
+    }
+
+    /// --- the current session is recreated by its next capture ---
+    if (dir == sessionDir(sessionSeq)) {
+        sessionCreated = false;
+    }
+}
+
+
+/// === wipe every capture by swapping the session root, independent of the file count ===
+void wipeSessions() {
+    if (!moveToTrash(SESSIONS_ROOT)) {
+        error("Failed to wipe sessions", false);
+        return;
+    }
+    SD_MMC.mkdir(SESSIONS_ROOT);
+    sessionCreated = false;
+    pending = 0;
+
+    /// --- captures saved in the root before sessions existed ---
+    File root = SD_MMC.open("/");
+    File file = root ? root.openNextFile() : File();
+    while (file) {
+        String filename = file.name();
+        bool legacy = !file.isDirectory() && filename.endsWith(".jpg") &&
+                      filename != "IMG_" + lastRingCaptureFilename + ".jpg";
+        file.close();
+
+        if (legacy) {
+            moveToTrash("/" + filename);
+        }
+        file = root.openNextFile();
+    }
+}
+
+
+/// === delete the tree at path until the deadline, true once it is gone ===
+static bool removeTree(const String& path, unsigned long startMs, unsigned long budgetMs) {
+    File dir = SD_MMC.open(path);
+    if (!dir) {
+        return true;
+    }
+    if (!dir.isDirectory()) {
+        dir.close();
+        SD_MMC.remove(path);
+        return true;
+    }
+
+    File entry = dir.openNextFile();
+    while (entry) {
+        String child = path + "/" + entry.name();
+        bool isDir = entry.isDirectory();
+        entry.close();
+
+        if (isDir) {
+            if (!removeTree(child, startMs, budgetMs)) {
+                return false;
+            }
+        }
+        else {
+            SD_MMC.remove(child);
+        }
+
+        if (millis() - startMs >= budgetMs) {
+            return false;
+        }
+        entry = dir.openNextFile();
+    }
+    dir.close();
+
+    return path == TRASH_ROOT || SD_MMC.rmdir(path);
+}
+
+
+/// === free the space of trashed captures within a time budget, true once the trash is empty ===
+bool reclaimTrash(unsigned long budgetMs) {
+    return removeTree(TRASH_ROOT, millis(), budgetMs);
+}
+
+
+
+/// === captures saved since the last complete drain ===
+uint32_t pendingCaptures() {
+    return pending;
+}
+
+
+/// === count a capture onto the backlog once saveFrame() has written it ===
+void captureSaved(const String& filename) {
+    if (filename != lastRingCaptureFilename) {
+        pending++;
+    }
+}
+
+
+/// === count uploaded captures off the backlog ===
+void capturesUploaded(uint32_t count) {
+    pending -= min(count, pending);
+}
\ No newline at end of file
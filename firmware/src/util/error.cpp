@@ -5,11 +5,10 @@
 // --- configuration ---
 #include "pins.h"
 
-// --- services ---
-#include "telegram.h"
-
 // --- utilities ---
 #include "debug.h"
+#include "journal.h"
+#include "notify.h"
 
 
 /// === error handler ===
@@ -19,8 +18,13 @@ void error(const String& message, bool fatalError) {
         DBG_PRINT("FATAL ERROR: ");
         DBG_PRINTLN(message);
 
-        /// --- attempt Telegram notification ---
-        sendMsgToTelegram("FATAL ERROR: " + message);
+        /// --- the buffered journal would be lost with the halt ---
+        journal(JOURNAL_ERROR, 1, 0, journalHash(message));
+        flushJournal();
+
+        /// --- attempt Telegram notification with anything still pending, the device halts here ---
+        notify("FATAL ERROR: " + message);
+        flushNotify(true);
 
         /// --- infinite blink visual indicator ---
         pinMode(FLASH_LED_PIN, OUTPUT);
@@ -35,8 +39,9 @@ void error(const String& message, bool fatalError) {
     else {
         DBG_PRINT("ERROR: ");
         DBG_PRINTLN(message);
+        journal(JOURNAL_ERROR, 0, 0, journalHash(message));
 
-        /// --- attempt Telegram notification ---
-        sendMsgToTelegram("ERROR: " + message);
+        /// --- coalesced & rate limited, sent in the background ---
+        notify("ERROR: " + message);
     }
 }
\ No newline at end of file
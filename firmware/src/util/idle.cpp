@@ -0,0 +1,200 @@
+// === standard headers ===
+// --- ESP32 sleep modes ---
+#include <esp_sleep.h>
+
+// --- GPIO wake sources ---
+#include <driver/gpio.h>
+
+// --- microsecond timer, kept running through light sleep ---
+#include <esp_timer.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "idle.h"
+
+// --- configuration ---
+#include "settings.h"
+#include "pins.h"
+
+// --- hardware ---
+#include "mcp23017.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "button_interrupt.h"
+#include "notify.h"
+
+
+// Between events the loop light sleeps instead of polling. The Arduino core is
+// built without tickless idle, so esp_pm can't enter light sleep on its own;
+// idleUntilEvent() enters it from the loop. The PIR wakes it through ext0 on
+// WAKE_PIN, set up for deep sleep already, and the button (or the MCP23017
+// interrupt line, if wired) through the GPIO source. WiFi stays associated
+// in modem sleep: the access point buffers frames while the chip sleeps, and
+// a timer wake every idleSleepPeriod ms picks them up within idleAwakeWindow.
+// Time asleep & awake is counted for the whole wake, timer wakes also measure
+// how late the chip resumes, and both are published before deep sleep.
+
+
+// === statistics ===
+static int64_t  idleSince   = 0;
+static int64_t  sleptUs     = 0;
+static int64_t  lastWakeUs  = 0;
+static uint32_t timerWakes  = 0;
+static uint32_t gpioWakes   = 0;
+static int64_t  lateUsTotal = 0;
+static int64_t  lateUsMax   = 0;
+
+static bool idleReady = false;
+
+
+/// === start counting, WiFi stays associated in the modem sleep of the arm power profile ===
+void initIdle() {
+    idleSince  = esp_timer_get_time();
+    lastWakeUs = idleSince;
+
+    /// --- route button & PIR changes to the interrupt line, reading the port clears it ---
+    if (MCP_INT_PIN >= 0) {
+        mcp.setupInterrupts(true, false, LOW);
+        mcp.setupInterruptPin(BTN_MCP_PIN, CHANGE);
+        mcp.setupInterruptPin(PIR_PIN, CHANGE);
+        pinMode(MCP_INT_PIN, INPUT_PULLUP);
+    }
+
+    idleReady = true;
+}
+
+
+/// === level wake on the active-low lines, the button keeps its edge interrupt while awake ===
+static void armGpioWake(bool arm) {
+    #if !SERIAL_DEBUG
+        if (arm) {
+            gpio_wakeup_enable((gpio_num_t)BTN_ESP_PIN, GPIO_INTR_LOW_LEVEL);
+        }
+        else {
+            gpio_wakeup_disable((gpio_num_t)BTN_ESP_PIN);
+            gpio_set_intr_type((gpio_num_t)BTN_ESP_PIN, GPIO_INTR_NEGEDGE);
+        }
+    #endif
+
+    if (MCP_INT_PIN >= 0) {
+        if (arm) {
+            gpio_wakeup_enable((gpio_num_t)MCP_INT_PIN, GPIO_INTR_LOW_LEVEL);
+        }
+        else {
+            gpio_wakeup_disable((gpio_num_t)MCP_INT_PIN);
+        }
+    }
+}
+
+
+/// === check nothing needs the CPU or the radio right now ===
+static bool mayIdle() {
+    /// --- a polled button can't wake the chip ---
+    if (SERIAL_DEBUG && MCP_INT_PIN < 0) {
+        return false;
+    }
+
+    /// --- events still to handle: a press, motion or queued MQTT events ---
+    if (doorbellInterrupted || digitalRead(WAKE_PIN) == HIGH || mqttOutboxDepth() > 0) {
+        return false;
+    }
+
+    /// --- notifications waiting for a digest or being sent, the notify task needs the radio ---
+    if (notifyPending() > 0 || notifySending()) {
+        return false;
+    }
+
+    /// --- an interrupt line held low would wake the chip at once ---
+    if (MCP_INT_PIN >= 0) {
+        mcp.clearInterrupts();
+        if (digitalRead(MCP_INT_PIN) == LOW) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/// === light sleep for up to maxMs or until a wake source fires, false if it stayed awake ===
+bool idleUntilEvent(unsigned long maxMs) {
+    if (!idleReady || maxMs < idleMinSleep || !mayIdle()) {
+        return false;
+    }
+
+    /// --- stay awake briefly after a wake so WiFi & the MQTT task catch up, the CPU idles meanwhile ---
+    if (esp_timer_get_time() - lastWakeUs < (int64_t)idleAwakeWindow * 1000) {
+        delay(10);
+        return false;
+    }
+
+    uint64_t sleepUs = (uint64_t)min(maxMs, idleSleepPeriod) * 1000;
+
+    #if SERIAL_DEBUG
+        Serial.flush();
+    #endif
+
+    esp_sleep_enable_timer_wakeup(sleepUs);
+    esp_sleep_enable_gpio_wakeup();
+    armGpioWake(true);
+
+    int64_t start = esp_timer_get_time();
+    esp_light_sleep_start();
+    int64_t end   = esp_timer_get_time();
+
+    armGpioWake(false);
+
+    /// --- the timer source is shared with the deep sleep upload wake ---
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+
+    sleptUs   += end - start;
+    lastWakeUs = end;
+
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER) {
+        int64_t late = max((int64_t)0, end - start - (int64_t)sleepUs);
+        timerWakes++;
+        lateUsTotal += late;
+        lateUsMax    = max(lateUsMax, late);
+    }
+    else {
+        gpioWakes++;
+
+        /// --- the edge interrupt is clock gated in light sleep, so the wake is the press ---
+        #if !SERIAL_DEBUG
+            if (digitalRead(BTN_ESP_PIN) == LOW) {
+                doorbellInterrupted = true;
+            }
+        #endif
+    }
+
+    return true;
+}
+
+
+/// === time spent in light sleep this wake ===
+int64_t idleSleptUs() {
+    return sleptUs;
+}
+
+
+/// === publish time asleep & the estimated average current, then wakes & wake latency, each fits one outbox event ===
+void publishIdleStats() {
+    int64_t totalUs = max((int64_t)1, esp_timer_get_time() - idleSince);
+    int64_t awakeUs = totalUs - sleptUs;
+    float   current = (awakeUs * idleActiveCurrent + sleptUs * idleSleepCurrent) / totalUs;
+
+    publishMQTT("doorbell/idle",
+        "{\"asleep_pct\":" + String(100.0f * sleptUs / totalUs, 1) +
+        ",\"ma\":" + String(current, 1) + "}");
+
+    publishMQTT("doorbell/idle/wakes",
+        "{\"timer\":" + String(timerWakes) +
+        ",\"gpio\":" + String(gpioWakes) +
+        ",\"late_us\":" + String((uint32_t)(timerWakes ? lateUsTotal / timerWakes : 0)) +
+        ",\"late_max_us\":" + String((uint32_t)lateUsMax) + "}");
+}
@@ -0,0 +1,429 @@
+// === standard headers ===
+// --- SD card access via SD_MMC interface ---
+#include <SD_MMC.h>
+
+// --- system time functions ---
+#include <time.h>
+
+// --- CRC-32 in ROM ---
+#include <esp_rom_crc.h>
+
+// --- FreeRTOS mutexes ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "journal.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- utilities ---
+#include "debug.h"
+
+
+// Records are appended to a buffer in RTC memory and written to the SD card
+// JOURNAL_BUFFER_SIZE at a time, usually spanning several wakes, so the card
+// sees one 640 byte append instead of a write per event. A power loss drops
+// the buffered records; their sequence numbers are skipped on the next power
+// on, so the gap shows in the decoded journal. The export position is kept
+// on the card next to the journal, so records written before a power loss
+// are still exported after it. Journal failures are never reported through
+// error(), which journals itself.
+
+
+// === export format ===
+/// --- "GBJR" magic, version, record size & record count precede the records ---
+const uint8_t JOURNAL_FORMAT_VERSION = 1;
+const int     JOURNAL_HEADER_LEN     = 8;
+
+/// --- records read from SD & published per MQTT message ---
+const int JOURNAL_EXPORT_BATCH = 64;
+
+/// --- bytes covered by a record's CRC ---
+const size_t JOURNAL_CRC_LEN = offsetof(JournalRecord, crc);
+
+
+// === buffered records, kept in RTC memory so a batch can span deep sleeps ===
+RTC_DATA_ATTR static JournalRecord pending[JOURNAL_BUFFER_SIZE];
+RTC_DATA_ATTR static int           pendingCount = 0;
+
+RTC_DATA_ATTR static uint32_t nextSeq     = 0;
+RTC_DATA_ATTR static uint32_t exportedSeq = 0;
+
+/// --- cleared by power loss, the sequence is then recovered from the SD card ---
+RTC_DATA_ATTR static bool journalReady = false;
+
+/// --- guards the buffer, events are journalled from any task ---
+static portMUX_TYPE journalMux = portMUX_INITIALIZER_UNLOCKED;
+
+/// --- serialises SD access of flushes & exports ---
+static SemaphoreHandle_t journalLock = nullptr;
+
+/// --- records read back for export, only used by the main loop ---
+static JournalRecord exportBatch[JOURNAL_EXPORT_BATCH];
+
+/// --- range asked for on JOURNAL_GET_TOPIC, served by the main loop ---
+static uint32_t requestFrom    = 0;
+static uint32_t requestCount   = 0;
+static bool     requestPending = false;
+
+
+/// === checksum of a record's fields ===
+static inline uint32_t recordCrc(const JournalRecord& record) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&record, JOURNAL_CRC_LEN);
+}
+
+
+/// === pad a torn tail back to a slot boundary, the padding fails its CRC ===
+static void alignTail(File& file) {
+    static const uint8_t zeros[sizeof(JournalRecord)] = {};
+    size_t torn = file.size() % sizeof(JournalRecord);
+    if (torn != 0) {
+        file.write(zeros, sizeof(JournalRecord) - torn);
+    }
+}
+
+
+/// === export position kept on the card, false if there is none ===
+static bool loadExported(uint32_t& seq) {
+    File file = SD_MMC.open(JOURNAL_EXPORTED_PATH, FILE_READ);
+    bool ok = file && file.read((uint8_t*)&seq, sizeof(seq)) == sizeof(seq);
+    file.close();
+    return ok;
+}
+
+
+/// === persist the export position, caller holds journalLock ===
+static void saveExported(uint32_t seq) {
+    File file = SD_MMC.open(JOURNAL_EXPORTED_PATH, FILE_WRITE);
+    if (file) {
+        file.write((const uint8_t*)&seq, sizeof(seq));
+        file.close();
+    }
+}
+
+
+/// === read a slot of a journal file, false if it is torn or corrupt ===
+static bool readSlot(File& file, uint32_t slot, JournalRecord& record) {
+    return file.seek(slot * sizeof(JournalRecord)) &&
+           file.read((uint8_t*)&record, sizeof(record)) == sizeof(record) &&
+           record.crc == recordCrc(record);
+}
+
+
+/// === sequence number of the last intact record of a file, padding a torn tail ===
+static bool lastSeqOf(const char* path, uint32_t& seq) {
+    File file = SD_MMC.open(path, FILE_READ);
+    if (!file) {
+        return false;
+    }
+    size_t size = file.size();
+    file.close();
+
+    /// --- keep slots aligned after a write cut short ---
+    if (size % sizeof(JournalRecord) != 0) {
+        File tail = SD_MMC.open(path, FILE_APPEND);
+        if (tail) {
+            alignTail(tail);
+            tail.close();
+        }
+    }
+
+    file = SD_MMC.open(path, FILE_READ);
+    uint32_t slots = size / sizeof(JournalRecord);
+    JournalRecord record;
+    for (uint32_t slot = slots; slot > 0; slot--) {
+        if (readSlot(file, slot - 1, record)) {
+            seq = record.seq;
+            file.close();
+            return true;
+        }
+    }
+    file.close();
+    return false;
+}
+
+
+/// === continue the sequence after power loss, must follow initMicroSD ===
+void initJournal() {
+    if (journalLock == nullptr) {
+        journalLock = xSemaphoreCreateMutex();
+    }
+
+    if (journalReady) {
+        return;
+    }
+
+    /// --- skip a buffer's worth of numbers, records lost with the RTC buffer may have been exported ---
+    uint32_t last;
+    uint32_t start = 0;
+    if (lastSeqOf(JOURNAL_PATH, last) || lastSeqOf(JOURNAL_OLD_PATH, last)) {
+        start = last + 1 + JOURNAL_BUFFER_SIZE;
+    }
+
+    /// --- resume the export where it stopped, records on the card before the power loss are still due ---
+    uint32_t exported;
+    if (!loadExported(exported) || exported > start) {
+        exported = start;
+    }
+
+    /// --- renumber events journalled before the sequence was known ---
+    portENTER_CRITICAL(&journalMux);
+    nextSeq = start;
+    for (int i = 0; i < pendingCount; i++) {
+        pending[i].seq = nextSeq++;
+        pending[i].crc = recordCrc(pending[i]);
+    }
+    exportedSeq  = exported;
+    journalReady = true;
+    portEXIT_CRITICAL(&journalMux);
+
+    DBG_PRINTLN("Journal continues at " + String(start));
+}
+
+
+/// === append an event, no formatting & no SD access until the batch is full ===
+void journal(JournalEvent event, uint8_t code, uint16_t arg, uint32_t value) {
+    JournalRecord record;
+    record.time  = (uint32_t)time(nullptr);
+    record.event = event;
+    record.code  = code;
+    record.arg   = arg;
+    record.value = value;
+
+    portENTER_CRITICAL(&journalMux);
+    record.seq = nextSeq++;
+    record.crc = recordCrc(record);
+
+    /// --- SD unavailable & buffer full: the sequence gap marks the lost record ---
+    if (pendingCount < JOURNAL_BUFFER_SIZE) {
+        pending[pendingCount++] = record;
+    }
+    bool full = pendingCount == JOURNAL_BUFFER_SIZE;
+    portEXIT_CRITICAL(&journalMux);
+
+    if (full) {
+        flushJournal();
+    }
+}
+
+
+/// === FNV-1a hash of a message, tools/journal_decode.py maps it back to the error() call ===
+uint32_t journalHash(const String& message) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < message.length(); i++) {
+        hash = (hash ^ (uint8_t)message[i]) * 16777619u;
+    }
+    return hash;
+}
+
+
+/// === append the buffered records to the journal file in one write ===
+bool flushJournal() {
+    if (journalLock == nullptr || xSemaphoreTake(journalLock, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return false;
+    }
+
+    /// --- copy the batch out so events aren't blocked by the SD card ---
+    static JournalRecord batch[JOURNAL_BUFFER_SIZE];
+    portENTER_CRITICAL(&journalMux);
+    int count = pendingCount;
+    memcpy(batch, pending, count * sizeof(JournalRecord));
+    portEXIT_CRITICAL(&journalMux);
+
+    if (count == 0) {
+        xSemaphoreGive(journalLock);
+        return true;
+    }
+
+    size_t len = count * sizeof(JournalRecord);
+    File file = SD_MMC.open(JOURNAL_PATH, FILE_APPEND);
+    size_t written = 0;
+    if (file) {
+        /// --- a previous short write left a torn slot, start the batch on a boundary ---
+        alignTail(file);
+        written = file.write((const uint8_t*)batch, len);
+
+        /// --- pad a short write at once so readers keep seeing aligned slots ---
+        if (written != len) {
+            alignTail(file);
+        }
+    }
+    size_t fileSize = file ? file.size() : 0;
+    file.close();
+
+    /// --- drop only the records that reached the card, a torn one is written again after its padding ---
+    int stored = written / sizeof(JournalRecord);
+    portENTER_CRITICAL(&journalMux);
+    pendingCount -= stored;
+    memmove(pending, pending + stored, pendingCount * sizeof(JournalRecord));
+    portEXIT_CRITICAL(&journalMux);
+
+    bool ok = written == len;
+    if (ok) {
+        /// --- the previous file is dropped once the current one is full ---
+        if (fileSize >= JOURNAL_FILE_RECORDS * sizeof(JournalRecord)) {
+            SD_MMC.remove(JOURNAL_OLD_PATH);
+            SD_MMC.rename(JOURNAL_PATH, JOURNAL_OLD_PATH);
+        }
+    }
+    else {
+        DBG_PRINTLN("Journal flush failed");
+    }
+
+    xSemaphoreGive(journalLock);
+    return ok;
+}
+
+
+/// === read intact records of a file with seq >= from, appending to out ===
+static int readFileRange(const char* path, uint32_t& from, JournalRecord* out, int max) {
+    File file = SD_MMC.open(path, FILE_READ);
+    if (!file) {
+        return 0;
+    }
+    uint32_t slots = file.size() / sizeof(JournalRecord);
+
+    /// --- binary search for the first slot with seq >= from, torn slots defer to the next intact one ---
+    uint32_t lo = 0, hi = slots;
+    JournalRecord record;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t probe = mid;
+        while (probe < hi && !readSlot(file, probe, record)) {
+            probe++;
+        }
+        if (probe < hi && record.seq < from) {
+            lo = probe + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    int count = 0;
+    for (uint32_t slot = lo; slot < slots && count < max; slot++) {
+        if (readSlot(file, slot, record) && record.seq >= from) {
+            out[count++] = record;
+            from = record.seq + 1;
+        }
+    }
+    file.close();
+
+    return count;
+}
+
+
+/// === up to max records with seq >= from, from both files & the RTC buffer ===
+static int readRange(uint32_t from, JournalRecord* out, int max) {
+    int count = 0;
+
+    xSemaphoreTake(journalLock, portMAX_DELAY);
+    count += readFileRange(JOURNAL_OLD_PATH, from, out + count, max - count);
+    count += readFileRange(JOURNAL_PATH, from, out + count, max - count);
+    xSemaphoreGive(journalLock);
+
+    portENTER_CRITICAL(&journalMux);
+    for (int i = 0; i < pendingCount && count < max; i++) {
+        if (pending[i].seq >= from) {
+            out[count++] = pending[i];
+        }
+    }
+    portEXIT_CRITICAL(&journalMux);
+
+    return count;
+}
+
+
+/// === publish records as one binary message on doorbell/journal ===
+static bool publishRecords(const JournalRecord* records, int count) {
+    uint8_t header[JOURNAL_HEADER_LEN] = {
+        'G', 'B', 'J', 'R',
+        JOURNAL_FORMAT_VERSION,
+        sizeof(JournalRecord),
+        (uint8_t)(count & 0xFF),
+        (uint8_t)(count >> 8)
+    };
+    size_t bodyLen = count * sizeof(JournalRecord);
+
+    /// --- the client is left alone while the MQTT task reconnects ---
+    if (xSemaphoreTake(mqttLock, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    if (!mqttConnected()) {
+        xSemaphoreGive(mqttLock);
+        return false;
+    }
+
+    bool ok = mqtt.beginPublish("doorbell/journal", JOURNAL_HEADER_LEN + bodyLen, false) &&
+              mqtt.write(header, JOURNAL_HEADER_LEN) == JOURNAL_HEADER_LEN &&
+              mqtt.write((const uint8_t*)records, bodyLen) == bodyLen &&
+              mqtt.endPublish();
+
+    xSemaphoreGive(mqttLock);
+    return ok;
+}
+
+
+/// === publish up to maxRecords journalled since the last export, returns the number sent ===
+int exportJournal(int maxRecords) {
+    if (journalLock == nullptr || mqttLock == nullptr || !mqttConnected()) {
+        return 0;
+    }
+
+    int sent = 0;
+
+    while (sent < maxRecords) {
+        int count = readRange(exportedSeq, exportBatch, min(JOURNAL_EXPORT_BATCH, maxRecords - sent));
+        if (count == 0 || !publishRecords(exportBatch, count)) {
+            break;
+        }
+        exportedSeq = exportBatch[count - 1].seq + 1;
+        sent += count;
+    }
+
+    /// --- one small write per export, not per batch ---
+    if (sent > 0 && xSemaphoreTake(journalLock, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        saveExported(exportedSeq);
+        xSemaphoreGive(journalLock);
+    }
+
+    return sent;
+}
+
+
+/// === ask for a range to be published again, called by the MQTT task ===
+void requestJournalRange(uint32_t from, uint32_t count) {
+    portENTER_CRITICAL(&journalMux);
+    requestFrom    = from;
+    requestCount   = count;
+    requestPending = true;
+    portEXIT_CRITICAL(&journalMux);
+}
+
+
+/// === serve a range requested on JOURNAL_GET_TOPIC ===
+void serviceJournal() {
+    portENTER_CRITICAL(&journalMux);
+    bool     due   = requestPending;
+    uint32_t from  = requestFrom;
+    uint32_t count = requestCount;
+    requestPending = false;
+    portEXIT_CRITICAL(&journalMux);
+
+    if (!due || journalLock == nullptr || mqttLock == nullptr) {
+        return;
+    }
+
+    while (count > 0) {
+        int n = readRange(from, exportBatch, min((uint32_t)JOURNAL_EXPORT_BATCH, count));
+        if (n == 0 || !publishRecords(exportBatch, n)) {
+            break;
+        }
+        from   = exportBatch[n - 1].seq + 1;
+        count -= n;
+    }
+}
@@ -0,0 +1,66 @@
+// === project headers ===
+// --- corresponding header ---
+#include "motion_detect.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- utilities ---
+#include "sharpness.h"
+
+
+// Frames are compared on a luma thumbnail taken from the DC coefficients of
+// the JPEG, like the person classifier's, so no frame is decoded. The score
+// is the share of thumbnail pixels whose luma moved by more than
+// motionPixelDelta, after taking out the median change, so the camera's auto
+// exposure settling doesn't count as motion while anything moving across
+// less than half of the scene does.
+
+
+// === thumbnail of the previous frame ===
+static uint8_t previous[MOTION_THUMB_W * MOTION_THUMB_H];
+static bool    havePrevious = false;
+
+
+/// === forget the previous frame, the next one has nothing to be compared with ===
+void resetFrameMotion() {
+    havePrevious = false;
+}
+
+
+/// === % of the scene that changed since the previous frame, -1 without one or if the JPEG can't be parsed ===
+int frameMotionScore(const uint8_t* jpeg, size_t len) {
+    static uint8_t current[MOTION_THUMB_W * MOTION_THUMB_H];
+    const int pixels = MOTION_THUMB_W * MOTION_THUMB_H;
+
+    if (!jpegLumaThumbnail(jpeg, len, current, MOTION_THUMB_W, MOTION_THUMB_H)) {
+        havePrevious = false;
+        return -1;
+    }
+
+    int score = -1;
+    if (havePrevious) {
+        /// --- median change from a histogram, an exposure step moves every pixel the same way ---
+        static uint16_t histogram[511];
+        memset(histogram, 0, sizeof(histogram));
+        for (int i = 0; i < pixels; i++) {
+            histogram[current[i] - previous[i] + 255]++;
+        }
+        int shift = -255;
+        for (int seen = histogram[0]; seen <= pixels / 2; seen += histogram[shift + 255]) {
+            shift++;
+        }
+
+        int changed = 0;
+        for (int i = 0; i < pixels; i++) {
+            if (abs(current[i] - previous[i] - shift) > motionPixelDelta) {
+                changed++;
+            }
+        }
+        score = changed * 100 / pixels;
+    }
+
+    memcpy(previous, current, sizeof(previous));
+    havePrevious = true;
+    return score;
+}
@@ -0,0 +1,232 @@
+// === standard headers ===
+// --- WiFi connectivity ---
+#include <WiFi.h>
+
+// --- FreeRTOS tasks ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "notify.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- network ---
+#include "wifi.h"
+#include "mqtt.h"
+
+// --- services ---
+#include "telegram.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "power_profile.h"
+
+
+// === pending messages ===
+/// --- one distinct message & how often it was raised since the last digest ---
+struct NotifySlot {
+    uint32_t hash;
+    uint16_t count;
+    char     text[NOTIFY_TEXT_LEN];
+};
+
+static NotifySlot slots[NOTIFY_SLOTS];
+static int        slotCount = 0;
+
+/// --- distinct messages dropped because every slot was taken ---
+static uint32_t   overflowed = 0;
+
+/// --- digests being sent right now, from the task or the main loop ---
+static int sending = 0;
+
+/// --- least stack the task left unused after a digest, reported when it drops ---
+static uint32_t stackHeadroom = TLS_TASK_STACK;
+
+/// --- guards the pending messages ---
+static portMUX_TYPE notifyMux = portMUX_INITIALIZER_UNLOCKED;
+
+
+// === token bucket ===
+/// --- digests that may be sent right now ---
+static int           tokens         = notifyBucketSize;
+static unsigned long lastRefillTime = 0;
+
+
+/// === FNV-1a hash of a message ===
+static uint32_t hashMessage(const char* text) {
+    uint32_t hash = 2166136261u;
+    while (*text) {
+        hash = (hash ^ (uint8_t)*text++) * 16777619u;
+    }
+    return hash;
+}
+
+
+/// === add a token for every refill period that passed ===
+static void refillTokens() {
+    unsigned long now = millis();
+    while (tokens < notifyBucketSize && now - lastRefillTime >= notifyRefillPeriod) {
+        tokens++;
+        lastRefillTime += notifyRefillPeriod;
+    }
+    if (tokens == notifyBucketSize) {
+        lastRefillTime = now;
+    }
+}
+
+
+/// === take every pending message as one digest ===
+static String takeDigest() {
+    /// --- copy the slots out under the lock, the digest is formatted with interrupts enabled ---
+    NotifySlot taken[NOTIFY_SLOTS];
+
+    portENTER_CRITICAL(&notifyMux);
+    int      count   = slotCount;
+    uint32_t dropped = overflowed;
+    memcpy(taken, slots, sizeof(NotifySlot) * count);
+    slotCount  = 0;
+    overflowed = 0;
+    portEXIT_CRITICAL(&notifyMux);
+
+    String digest;
+    for (int i = 0; i < count; i++) {
+        if (i > 0) digest += "\n";
+        digest += taken[i].text;
+        if (taken[i].count > 1) {
+            digest += " (x" + String(taken[i].count) + ")";
+        }
+    }
+    if (dropped > 0) {
+        digest += "\n+" + String(dropped) + " more";
+    }
+
+    return digest;
+}
+
+
+/// === notification task: sends coalesced digests as tokens allow ===
+static void notifyTask(void* param) {
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(notifyFlushPeriod));
+
+        /// --- never reconnect WiFi from here, wait for the main loop to ---
+        if (WiFi.status() == WL_CONNECTED) {
+            flushNotify(false);
+        }
+
+        /// --- a Telegram send does a full TLS handshake on this stack ---
+        uint32_t headroom = uxTaskGetStackHighWaterMark(nullptr);
+        if (headroom < stackHeadroom) {
+            stackHeadroom = headroom;
+            DBG_PRINTF("Notify task stack headroom %u bytes\n", stackHeadroom);
+        }
+    }
+}
+
+
+/// === start the background notification task ===
+void initNotify() {
+    lastRefillTime = millis();
+
+    if (xTaskCreatePinnedToCore(notifyTask, "notify", TLS_TASK_STACK, nullptr, 1, nullptr, 0) != pdPASS) {
+        DBG_PRINTLN("Failed to start notify task");
+    }
+}
+
+
+/// === queue a message, repeats of a pending message only raise its count ===
+void notify(const String& message) {
+    char text[NOTIFY_TEXT_LEN];
+    strncpy(text, message.c_str(), NOTIFY_TEXT_LEN - 1);
+    text[NOTIFY_TEXT_LEN - 1] = '\0';
+    uint32_t hash = hashMessage(text);
+
+    portENTER_CRITICAL(&notifyMux);
+    int i = 0;
+    while (i < slotCount && (slots[i].hash != hash || strcmp(slots[i].text, text) != 0)) {
+        i++;
+    }
+
+    if (i < slotCount) {
+        if (slots[i].count < UINT16_MAX) slots[i].count++;
+    }
+    else if (slotCount < NOTIFY_SLOTS) {
+        slots[slotCount].hash  = hash;
+        slots[slotCount].count = 1;
+        memcpy(slots[slotCount].text, text, NOTIFY_TEXT_LEN);
+        slotCount++;
+    }
+    else {
+        overflowed++;
+    }
+    portEXIT_CRITICAL(&notifyMux);
+}
+
+
+/// === send pending messages as one digest, force skips the rate limit ===
+bool flushNotify(bool force) {
+    if (notifyPending() == 0) {
+        return true;
+    }
+
+    portENTER_CRITICAL(&notifyMux);
+    refillTokens();
+    bool allowed = force || tokens > 0;
+    if (allowed && tokens > 0) {
+        tokens--;
+    }
+    if (allowed) {
+        sending++;
+    }
+    portEXIT_CRITICAL(&notifyMux);
+
+    /// --- out of tokens: keep coalescing until the bucket refills ---
+    if (!allowed) {
+        return false;
+    }
+
+    /// --- another task may have taken the digest meanwhile ---
+    String digest = takeDigest();
+    if (digest.length() > 0) {
+        /// --- without telegram the digest goes to the local broker, cut to one outbox event ---
+        if constexpr (featureTelegram) {
+            /// --- the TLS handshake wants full speed & the radio awake, whatever the loop is doing ---
+            holdPowerPhase(POWER_NOTIFY);
+            sendMsgToTelegram(digest);
+            releasePowerPhase(POWER_NOTIFY);
+        }
+        else {
+            publishMQTT("doorbell/notify", digest.substring(0, MQTT_PAYLOAD_LEN - 1));
+        }
+    }
+
+    portENTER_CRITICAL(&notifyMux);
+    sending--;
+    portEXIT_CRITICAL(&notifyMux);
+
+    return true;
+}
+
+
+/// === number of distinct messages waiting for a digest ===
+int notifyPending() {
+    portENTER_CRITICAL(&notifyMux);
+    int pending = slotCount + (overflowed > 0 ? 1 : 0);
+    portEXIT_CRITICAL(&notifyMux);
+
+    return pending;
+}
+
+
+/// === true while a digest is being sent ===
+bool notifySending() {
+    portENTER_CRITICAL(&notifyMux);
+    bool busy = sending > 0;
+    portEXIT_CRITICAL(&notifyMux);
+
+    return busy;
+}
@@ -0,0 +1,306 @@
+// === standard headers ===
+// --- SD card access via SD_MMC interface ---
+#include <SD_MMC.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "person_detect.h"
+
+// --- hardware ---
+#include "hot_tier.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "error.h"
+#include "sharpness.h"
+#include "trace.h"
+
+
+// The classifier is a three layer int8 CNN on a 32x24 luma thumbnail taken
+// from the DC coefficients of the JPEG, so no frame is ever decoded. Layers
+// are 3x3 stride-2 convolutions with ReLU over uint8 HWC maps with a border
+// of padding, so the kernel needs no bounds checks & each kernel row is one
+// contiguous run of 3 x input channels bytes. Accumulators stay in 32 bits
+// & four output channels share every input load; only the requantisation
+// of each output uses a 64-bit multiply. The convolution runs from IRAM.
+//
+// Model file, little endian, written by tools/person_model.py:
+//   "GBPM" | u8 version | u8 input w | u8 input h | u8 layers | u8 channels[3] | u8 0 | f32 output scale
+//   per layer: i8 weights[out][3][3][in] | i32 bias[out] | i32 multiplier[out] | i8 shift[out]
+//   i8 logit weights[channels[2]] | i32 logit bias
+// The first layer sees raw pixels, its bias already folds in the 128 zero point.
+
+
+// === model ===
+const uint8_t PERSON_MODEL_VERSION = 1;
+
+const int PERSON_MAX_CHANNELS = 32;
+
+/// --- one convolution, weights point into the arena ---
+struct ConvLayer {
+    int       inC;
+    int       outC;
+    int8_t*   weights;
+    int32_t   bias[PERSON_MAX_CHANNELS];
+    int32_t   multiplier[PERSON_MAX_CHANNELS];
+    int8_t    shift[PERSON_MAX_CHANNELS];
+};
+
+static ConvLayer layers[PERSON_LAYERS];
+
+static int8_t  logitWeights[PERSON_MAX_CHANNELS];
+static int32_t logitBias   = 0;
+static float   outputScale = 0;
+
+/// --- weights & activation maps, allocated once a model is loaded ---
+static uint8_t* arena = nullptr;
+
+/// --- padded input of every layer & the unpadded output of the last ---
+static uint8_t* maps[PERSON_LAYERS + 1];
+
+
+/// === width, height & channels of the map feeding layer i (i == PERSON_LAYERS is the output) ===
+static inline int mapW(int i) { return PERSON_INPUT_W >> i; }
+static inline int mapH(int i) { return PERSON_INPUT_H >> i; }
+static inline int mapC(int i) { return i == 0 ? 1 : PERSON_CHANNELS[i - 1]; }
+
+/// --- layer inputs carry a one pixel border, the final map doesn't ---
+static inline size_t mapBytes(int i) {
+    int pad = i < PERSON_LAYERS ? 2 : 0;
+    return (size_t)(mapW(i) + pad) * (mapH(i) + pad) * mapC(i);
+}
+
+
+// === kernel ===
+/// === scale an accumulator into the next layer's uint8 range, clamping negatives (ReLU) ===
+static inline uint8_t requantize(int32_t acc, int32_t multiplier, int shift) {
+    int64_t scaled = ((int64_t)acc * multiplier + ((int64_t)1 << (30 + shift))) >> (31 + shift);
+    return scaled < 0 ? 0 : scaled > 255 ? 255 : (uint8_t)scaled;
+}
+
+
+/// === 3x3 stride-2 convolution of a padded map into the interior of the next ===
+static void IRAM_ATTR conv3x3s2(const ConvLayer& layer, const uint8_t* in, int inW, uint8_t* out, int outW, int outH, int outPad) {
+    const int inStride  = (inW + 2) * layer.inC;
+    const int outStride = (outW + 2 * outPad) * layer.outC;
+    const int rowLen    = 3 * layer.inC;
+    const int filterLen = 9 * layer.inC;
+
+    for (int oy = 0; oy < outH; oy++) {
+        uint8_t* dst = out + (oy + outPad) * outStride + outPad * layer.outC;
+
+        for (int ox = 0; ox < outW; ox++) {
+            /// --- output (oy, ox) is centred on input (2oy, 2ox), the padded window starts there ---
+            const uint8_t* window = in + 2 * oy * inStride + 2 * ox * layer.inC;
+
+            for (int oc = 0; oc < layer.outC; oc += 4) {
+                const int8_t* w0 = layer.weights + oc * filterLen;
+                const int8_t* w1 = w0 + filterLen;
+                const int8_t* w2 = w1 + filterLen;
+                const int8_t* w3 = w2 + filterLen;
+
+                int32_t acc0 = layer.bias[oc];
+                int32_t acc1 = layer.bias[oc + 1];
+                int32_t acc2 = layer.bias[oc + 2];
+                int32_t acc3 = layer.bias[oc + 3];
+
+                for (int ky = 0; ky < 3; ky++) {
+                    const uint8_t* x = window + ky * inStride;
+                    for (int i = 0; i < rowLen; i++) {
+                        int32_t v = x[i];
+                        acc0 += v * w0[i];
+                        acc1 += v * w1[i];
+                        acc2 += v * w2[i];
+                        acc3 += v * w3[i];
+                    }
+                    w0 += rowLen;
+                    w1 += rowLen;
+                    w2 += rowLen;
+                    w3 += rowLen;
+                }
+
+                dst[oc]     = requantize(acc0, layer.multiplier[oc],     layer.shift[oc]);
+                dst[oc + 1] = requantize(acc1, layer.multiplier[oc + 1], layer.shift[oc + 1]);
+                dst[oc + 2] = requantize(acc2, layer.multiplier[oc + 2], layer.shift[oc + 2]);
+                dst[oc + 3] = requantize(acc3, layer.multiplier[oc + 3], layer.shift[oc + 3]);
+            }
+
+            dst += layer.outC;
+        }
+    }
+}
+
+
+// === model loading ===
+/// --- sequential reader over a model blob ---
+struct BlobReader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    bool take(void* dst, size_t n) {
+        if ((size_t)(end - p) < n) return false;
+        memcpy(dst, p, n);
+        p += n;
+        return true;
+    }
+};
+
+
+/// === parse a model blob into the arena, false if it doesn't match the architecture ===
+bool loadPersonModel(const uint8_t* blob, size_t len) {
+    BlobReader reader = { blob, blob + len };
+
+    uint8_t header[12];
+    if (!reader.take(header, sizeof(header)) || memcmp(header, "GBPM", 4) != 0 ||
+        header[4] != PERSON_MODEL_VERSION || header[5] != PERSON_INPUT_W || header[6] != PERSON_INPUT_H ||
+        header[7] != PERSON_LAYERS) {
+        return false;
+    }
+    for (int i = 0; i < PERSON_LAYERS; i++) {
+        if (header[8 + i] != PERSON_CHANNELS[i]) return false;
+    }
+    if (!reader.take(&outputScale, sizeof(outputScale))) {
+        return false;
+    }
+
+    /// --- one allocation for every weight & map, kept for the rest of the wake ---
+    size_t weightBytes = 0, mapTotal = 0;
+    for (int i = 0; i < PERSON_LAYERS; i++) {
+        weightBytes += (size_t)9 * mapC(i) * PERSON_CHANNELS[i];
+    }
+    for (int i = 0; i <= PERSON_LAYERS; i++) {
+        mapTotal += mapBytes(i);
+    }
+    if (arena == nullptr) {
+        arena = (uint8_t*)malloc(weightBytes + mapTotal);
+        if (arena == nullptr) {
+            return false;
+        }
+    }
+
+    int8_t* weights = (int8_t*)arena;
+    for (int i = 0; i < PERSON_LAYERS; i++) {
+        ConvLayer& layer = layers[i];
+        layer.inC     = mapC(i);
+        layer.outC    = PERSON_CHANNELS[i];
+        layer.weights = weights;
+
+        size_t count = (size_t)9 * layer.inC * layer.outC;
+        if (!reader.take(layer.weights, count) ||
+            !reader.take(layer.bias, sizeof(int32_t) * layer.outC) ||
+            !reader.take(layer.multiplier, sizeof(int32_t) * layer.outC) ||
+            !reader.take(layer.shift, layer.outC)) {
+            return false;
+        }
+        weights += count;
+
+        for (int c = 0; c < layer.outC; c++) {
+            if (layer.shift[c] < 0 || layer.shift[c] > 31) return false;
+        }
+    }
+
+    int lastC = PERSON_CHANNELS[PERSON_LAYERS - 1];
+    if (!reader.take(logitWeights, lastC) || !reader.take(&logitBias, sizeof(logitBias)) || reader.p != reader.end) {
+        return false;
+    }
+
+    /// --- borders are never written: the zero point, 128 for pixels & 0 for activations ---
+    uint8_t* map = arena + weightBytes;
+    for (int i = 0; i <= PERSON_LAYERS; i++) {
+        maps[i] = map;
+        memset(map, i == 0 ? 128 : 0, mapBytes(i));
+        map += mapBytes(i);
+    }
+
+    return true;
+}
+
+
+/// === load the model from the hot tier, or from the SD card root ===
+bool initPersonDetect() {
+    File file = hotFS().open(PERSON_MODEL_PATH, FILE_READ);
+    if (!file && &hotFS() != &SD_MMC) {
+        file = SD_MMC.open(PERSON_MODEL_PATH, FILE_READ);
+    }
+    if (!file) {
+        DBG_PRINTLN("No person model, every motion starts a full burst");
+        return false;
+    }
+
+    size_t   len  = file.size();
+    uint8_t* blob = (uint8_t*)malloc(len);
+    bool     ok   = blob != nullptr && file.read(blob, len) == len && loadPersonModel(blob, len);
+    free(blob);
+    file.close();
+
+    if (!ok) {
+        free(arena);
+        arena = nullptr;
+        error("Invalid person model, every motion starts a full burst", false);
+        return false;
+    }
+
+    DBG_PRINTLN("Person model loaded");
+    return true;
+}
+
+
+/// === check if a model is ready to gate surveillance ===
+bool personModelLoaded() {
+    return arena != nullptr;
+}
+
+
+/// === person score 0-100 of a PERSON_INPUT_W x PERSON_INPUT_H luma thumbnail, -1 without a model ===
+int personScore(const uint8_t* thumbnail) {
+    if (arena == nullptr) {
+        return -1;
+    }
+
+    /// --- copy the thumbnail into the interior of the padded input ---
+    for (int y = 0; y < PERSON_INPUT_H; y++) {
+        memcpy(maps[0] + (y + 1) * (PERSON_INPUT_W + 2) + 1, thumbnail + y * PERSON_INPUT_W, PERSON_INPUT_W);
+    }
+
+    for (int i = 0; i < PERSON_LAYERS; i++) {
+        int outPad = i + 1 < PERSON_LAYERS ? 1 : 0;
+        conv3x3s2(layers[i], maps[i], mapW(i), maps[i + 1], mapW(i + 1), mapH(i + 1), outPad);
+    }
+
+    /// --- global average pooling folded into the logit: the scale divides by the positions ---
+    const int      lastC     = PERSON_CHANNELS[PERSON_LAYERS - 1];
+    const int      positions = mapW(PERSON_LAYERS) * mapH(PERSON_LAYERS);
+    const uint8_t* features  = maps[PERSON_LAYERS];
+
+    int32_t logit = logitBias;
+    for (int c = 0; c < lastC; c++) {
+        int32_t sum = 0;
+        for (int p = 0; p < positions; p++) {
+            sum += features[p * lastC + c];
+        }
+        logit += sum * logitWeights[c];
+    }
+
+    float probability = 1.0f / (1.0f + expf(-logit * outputScale));
+    return (int)(probability * 100.0f + 0.5f);
+}
+
+
+/// === person score of a captured JPEG, -1 without a model or if it can't be parsed ===
+int personScoreJpeg(const uint8_t* jpeg, size_t len) {
+    static uint8_t thumbnail[PERSON_INPUT_W * PERSON_INPUT_H];
+
+    if (arena == nullptr) {
+        return -1;
+    }
+
+    uint32_t span = traceBegin();
+    int score = -1;
+    if (jpegLumaThumbnail(jpeg, len, thumbnail, PERSON_INPUT_W, PERSON_INPUT_H)) {
+        score = personScore(thumbnail);
+    }
+    traceEnd(TRACE_PERSON, span);
+
+    return score;
+}
@@ -0,0 +1,219 @@
+// === standard headers ===
+// --- WiFi power save & TX power ---
+#include <WiFi.h>
+
+// --- microsecond timer, kept running through light sleep ---
+#include <esp_timer.h>
+
+// --- FreeRTOS mutexes ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "power_profile.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "idle.h"
+
+
+// Each main phase of a wake runs with its own CPU frequency, WiFi power save
+// mode & TX power. TLS handshakes, JPEG work & bulk uploads get 240 MHz & the
+// radio always on, while standby & the reports queued before deep sleep run
+// at 80 MHz, the lowest frequency WiFi keeps working at, in modem sleep. Boot
+// runs at the core's 240 MHz until WiFi is up. Phases are switched by the main
+// loop at the boundaries between actions; a phase entered from another
+// returns to it when it ends, so a ring during surveillance goes back to
+// surveillance. Other tasks hold a phase for the length of an action, e.g.
+// the notify task for a Telegram send; holds are counted per phase & the
+// profile drawing the most current of the loop's phase & every held one
+// applies. Time spent in each phase, split into awake & light sleep, is
+// counted for the whole wake & published before deep sleep with the energy it
+// took, estimated from each profile's current.
+
+
+// === profiles, indexed by phase ===
+struct PowerProfile {
+    const char*    name;
+    uint32_t       cpuMhz;
+    wifi_ps_type_t powerSave;
+    wifi_power_t   txPower;
+    /// --- board current awake in mA for the published estimate, replace with meter readings of the board ---
+    float          current;
+};
+
+static const PowerProfile profiles[POWER_PHASE_COUNT] = {
+    { "arm",           80, WIFI_PS_MIN_MODEM, WIFI_POWER_15dBm,    70.0f },
+    { "surveillance", 240, WIFI_PS_MIN_MODEM, WIFI_POWER_15dBm,   180.0f },
+    { "notify",       240, WIFI_PS_NONE,      WIFI_POWER_17dBm,   210.0f },
+    { "upload",       240, WIFI_PS_NONE,      WIFI_POWER_19_5dBm, 240.0f },
+    { "sleep",         80, WIFI_PS_MIN_MODEM, WIFI_POWER_15dBm,    80.0f },
+};
+
+
+// === statistics, boot counts as arm ===
+struct PhaseStats {
+    int64_t  us;
+    int64_t  sleptUs;
+    uint32_t entries;
+};
+
+static PhaseStats stats[POWER_PHASE_COUNT] = {};
+
+/// --- phase set by the loop, & the phase applied once holds of other tasks are counted in ---
+static PowerPhase current    = POWER_ARM;
+static PowerPhase applied    = POWER_ARM;
+static int64_t    phaseSince = 0;
+static int64_t    sleptSince = 0;
+static bool       powerReady = false;
+
+/// --- holds of each phase by other tasks ---
+static int holds[POWER_PHASE_COUNT] = {};
+
+/// --- serialises switches of the loop & of holding tasks ---
+static SemaphoreHandle_t powerLock = nullptr;
+
+
+/// === add the time since the last switch to the applied phase ===
+static void closePhase() {
+    int64_t now   = esp_timer_get_time();
+    int64_t slept = idleSleptUs();
+
+    stats[applied].us      += now - phaseSince;
+    stats[applied].sleptUs += slept - sleptSince;
+
+    phaseSince = now;
+    sleptSince = slept;
+}
+
+
+/// === switch CPU frequency & WiFi power settings, the frequency only if it changes ===
+static void applyProfile(const PowerProfile& profile) {
+    if (getCpuFrequencyMhz() != profile.cpuMhz) {
+        setCpuFrequencyMhz(profile.cpuMhz);
+    }
+    WiFi.setSleep(profile.powerSave);
+    WiFi.setTxPower(profile.txPower);
+}
+
+
+/// === apply the loop's phase or a held one drawing more current, caller holds powerLock ===
+static void applyPhase() {
+    PowerPhase phase = current;
+    for (int i = 0; i < POWER_PHASE_COUNT; i++) {
+        if (holds[i] > 0 && profiles[i].current > profiles[phase].current) {
+            phase = (PowerPhase)i;
+        }
+    }
+    if (phase == applied) {
+        return;
+    }
+
+    closePhase();
+    applied = phase;
+    stats[applied].entries++;
+    applyProfile(profiles[applied]);
+
+    DBG_PRINTF("Power phase %s, %u MHz\n", profiles[applied].name, getCpuFrequencyMhz());
+}
+
+
+/// === start in the arm profile once WiFi is up, the power settings need the WiFi driver ===
+void initPowerProfiles() {
+    if (powerLock == nullptr) {
+        powerLock = xSemaphoreCreateMutex();
+    }
+
+    current = POWER_ARM;
+    applied = POWER_ARM;
+    stats[applied].entries++;
+    applyProfile(profiles[applied]);
+    powerReady = true;
+}
+
+
+/// === switch to the profile of a phase, returns the phase left to switch back to ===
+PowerPhase enterPowerPhase(PowerPhase phase) {
+    PowerPhase previous = current;
+    if (!powerReady || phase == current) {
+        return previous;
+    }
+
+    xSemaphoreTake(powerLock, portMAX_DELAY);
+    current = phase;
+    applyPhase();
+    xSemaphoreGive(powerLock);
+
+    return previous;
+}
+
+
+/// === keep at least a phase's profile until released, for actions of other tasks ===
+void holdPowerPhase(PowerPhase phase) {
+    if (!powerReady) {
+        return;
+    }
+
+    xSemaphoreTake(powerLock, portMAX_DELAY);
+    holds[phase]++;
+    applyPhase();
+    xSemaphoreGive(powerLock);
+}
+
+
+/// === end a hold, the loop's phase applies again once no task holds a hungrier one ===
+void releasePowerPhase(PowerPhase phase) {
+    if (!powerReady) {
+        return;
+    }
+
+    xSemaphoreTake(powerLock, portMAX_DELAY);
+    if (holds[phase] > 0) {
+        holds[phase]--;
+    }
+    applyPhase();
+    xSemaphoreGive(powerLock);
+}
+
+
+/// === phase the wake is in ===
+PowerPhase powerPhase() {
+    return current;
+}
+
+
+/// === publish time, light sleep, entries & estimated energy of each phase entered this wake ===
+void publishPowerStats() {
+    if (!powerReady) {
+        return;
+    }
+
+    xSemaphoreTake(powerLock, portMAX_DELAY);
+    closePhase();
+    xSemaphoreGive(powerLock);
+
+    for (int i = 0; i < POWER_PHASE_COUNT; i++) {
+        if (stats[i].entries == 0) {
+            continue;
+        }
+
+        /// --- mA over us to uAh, light sleep at the idle estimate ---
+        int64_t awakeUs = stats[i].us - stats[i].sleptUs;
+        float   uah     = (awakeUs * profiles[i].current + stats[i].sleptUs * idleSleepCurrent) / 3.6e6f;
+
+        publishMQTT((String("doorbell/power/") + profiles[i].name).c_str(),
+            "{\"ms\":" + String((uint32_t)(stats[i].us / 1000)) +
+            ",\"slept_ms\":" + String((uint32_t)(stats[i].sleptUs / 1000)) +
+            ",\"n\":" + String(stats[i].entries) +
+            ",\"mhz\":" + String(profiles[i].cpuMhz) +
+            ",\"uah\":" + String(uah, 1) + "}");
+    }
+}
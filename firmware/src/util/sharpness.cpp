@@ -0,0 +1,471 @@
+// === project headers ===
+// --- corresponding header ---
+#include "sharpness.h"
+
+
+// Blur removes high spatial frequencies, which in a JPEG are the quantised AC
+// coefficients. Frames of one burst share frame size & quality, so the summed
+// AC magnitude of the luma blocks ranks them by sharpness without an IDCT:
+// only the Huffman-coded scan is walked, chroma blocks are decoded & skipped.
+//
+// The DC coefficient of a block is 8x its mean level, so the same walk also
+// yields a 1/8 scale luma image for the person classifier.
+
+
+// === Huffman tables ===
+/// --- codes up to this many bits resolve with a single table lookup ---
+const int HUFF_FAST_BITS = 9;
+
+struct HuffTable {
+    /// --- (code length << 8) | symbol, 0 when the code is longer than HUFF_FAST_BITS ---
+    uint16_t fast[1 << HUFF_FAST_BITS];
+    /// --- canonical decoding for longer codes ---
+    int32_t  maxCode[18];
+    int32_t  valOffset[17];
+    uint8_t  symbols[256];
+    bool     defined;
+};
+
+/// --- component of the frame header ---
+struct JpegComponent {
+    uint8_t id;
+    uint8_t h;
+    uint8_t v;
+    uint8_t quantTable;
+    uint8_t dcTable;
+    uint8_t acTable;
+};
+
+/// --- decoder state, kept in a struct so the kernel needs no heap ---
+struct JpegScan {
+    const uint8_t* data;
+    const uint8_t* end;
+    uint64_t       bits;
+    int            count;
+    bool           marker;
+
+    HuffTable      dc[4];
+    HuffTable      ac[4];
+    JpegComponent  comps[3];
+    int            compCount;
+    int            scanComps[3];
+    int            scanCount;
+    uint16_t       width;
+    uint16_t       height;
+    uint16_t       restartInterval;
+    /// --- DC step of each quantisation table ---
+    uint16_t       dcQuant[4];
+
+    /// --- block layout of the scan ---
+    int            lumaCols;
+    int            lumaRows;
+    int            mcus;
+    int            mcuCols;
+    int            blocksPerMcu[3];
+};
+
+
+/// === build the lookup & canonical tables of a DHT segment ===
+static bool buildHuffTable(HuffTable& table, const uint8_t* counts, const uint8_t* symbols, int total) {
+    memset(table.fast, 0, sizeof(table.fast));
+    memcpy(table.symbols, symbols, total);
+
+    int code = 0, index = 0;
+    for (int len = 1; len <= 16; len++) {
+        table.valOffset[len] = index - code;
+        for (int i = 0; i < counts[len - 1]; i++, index++, code++) {
+            /// --- every HUFF_FAST_BITS-bit pattern starting with this code maps to it ---
+            if (len <= HUFF_FAST_BITS) {
+                int shift = HUFF_FAST_BITS - len;
+                for (int fill = 0; fill < (1 << shift); fill++) {
+                    table.fast[(code << shift) | fill] = (uint16_t)((len << 8) | symbols[index]);
+                }
+            }
+        }
+        table.maxCode[len] = counts[len - 1] ? code - 1 : -1;
+        if (code > (1 << len)) {
+            return false;
+        }
+        code <<= 1;
+    }
+    table.maxCode[17] = INT32_MAX;
+
+    table.defined = true;
+    return true;
+}
+
+
+// === bit reader ===
+/// === top up the bit buffer, stopping at a marker & padding with zeros ===
+static inline void refill(JpegScan& scan) {
+    while (scan.count <= 56) {
+        uint32_t byte = 0;
+        if (!scan.marker && scan.data < scan.end) {
+            byte = *scan.data;
+            if (byte == 0xFF) {
+                /// --- 0xFF00 is a stuffed 0xFF, anything else is a marker ---
+                if (scan.data + 1 < scan.end && scan.data[1] == 0x00) {
+                    scan.data += 2;
+                }
+                else {
+                    scan.marker = true;
+                    byte = 0;
+                }
+            }
+            else {
+                scan.data++;
+            }
+        }
+        scan.bits |= (uint64_t)byte << (56 - scan.count);
+        scan.count += 8;
+    }
+}
+
+static inline uint32_t getBits(JpegScan& scan, int n) {
+    if (scan.count < n) refill(scan);
+    uint32_t value = (uint32_t)(scan.bits >> (64 - n));
+    scan.bits <<= n;
+    scan.count -= n;
+    return value;
+}
+
+/// === decode one Huffman symbol, -1 on an invalid code ===
+static inline int decodeSymbol(JpegScan& scan, const HuffTable& table) {
+    if (scan.count < 16) refill(scan);
+
+    uint16_t entry = table.fast[scan.bits >> (64 - HUFF_FAST_BITS)];
+    if (entry != 0) {
+        int len = entry >> 8;
+        scan.bits <<= len;
+        scan.count -= len;
+        return entry & 0xFF;
+    }
+
+    /// --- slow path: walk the canonical code lengths ---
+    int len = HUFF_FAST_BITS + 1;
+    int32_t code = (int32_t)(scan.bits >> (64 - len));
+    while (code > table.maxCode[len]) {
+        len++;
+        if (len > 16) {
+            return -1;
+        }
+        code = (int32_t)(scan.bits >> (64 - len));
+    }
+    scan.bits <<= len;
+    scan.count -= len;
+    return table.symbols[code + table.valOffset[len]];
+}
+
+
+/// === walk one block, returning the summed magnitude of its AC coefficients ===
+static inline int32_t decodeBlock(JpegScan& scan, const HuffTable& dc, const HuffTable& ac, int32_t& dcDiff) {
+    int size = decodeSymbol(scan, dc);
+    if (size < 0 || size > 11) {
+        return -1;
+    }
+    dcDiff = 0;
+    if (size) {
+        int32_t value = (int32_t)getBits(scan, size);
+        dcDiff = (value >> (size - 1)) ? value : value - (1 << size) + 1;
+    }
+
+    int32_t energy = 0;
+    for (int k = 1; k < 64; k++) {
+        int rs = decodeSymbol(scan, ac);
+        if (rs < 0) {
+            return -1;
+        }
+
+        int run = rs >> 4;
+        size = rs & 15;
+        if (size == 0) {
+            /// --- end of block, or a run of 16 zeros ---
+            if (run != 15) break;
+            k += 15;
+            continue;
+        }
+
+        k += run;
+        uint32_t value = getBits(scan, size);
+        /// --- values below 2^(size-1) are negative, magnitude without the sign extension ---
+        energy += (value >> (size - 1)) ? value : (1u << size) - 1 - value;
+    }
+
+    return energy;
+}
+
+
+// === segment parsing ===
+static inline uint16_t readU16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+/// === parse markers up to the first scan, leaving scan.data at the entropy-coded data ===
+static bool parseHeaders(JpegScan& scan, const uint8_t* jpeg, size_t len) {
+    const uint8_t* p   = jpeg;
+    const uint8_t* end = jpeg + len;
+
+    if (len < 4 || p[0] != 0xFF || p[1] != 0xD8) {
+        return false;
+    }
+    p += 2;
+
+    while (p + 4 <= end) {
+        if (p[0] != 0xFF) {
+            return false;
+        }
+        uint8_t marker = p[1];
+        if (marker == 0xFF) {
+            p++;
+            continue;
+        }
+
+        uint16_t segLen = readU16(p + 2);
+        const uint8_t* seg = p + 4;
+        const uint8_t* segEnd = p + 2 + segLen;
+        if (segLen < 2 || segEnd > end) {
+            return false;
+        }
+
+        switch (marker) {
+            /// --- baseline & extended sequential frames only ---
+            case 0xC0:
+            case 0xC1: {
+                if (segLen < 8) return false;
+                scan.height    = readU16(seg + 1);
+                scan.width     = readU16(seg + 3);
+                scan.compCount = seg[5];
+                if (scan.compCount < 1 || scan.compCount > 3 || segLen < 8 + 3 * scan.compCount) return false;
+                for (int i = 0; i < scan.compCount; i++) {
+                    const uint8_t* c = seg + 6 + 3 * i;
+                    scan.comps[i] = { c[0], (uint8_t)(c[1] >> 4), (uint8_t)(c[1] & 15), (uint8_t)(c[2] & 3), 0, 0 };
+                    if (scan.comps[i].h < 1 || scan.comps[i].h > 4 || scan.comps[i].v < 1 || scan.comps[i].v > 4) return false;
+                }
+                break;
+            }
+
+            /// --- progressive, lossless & arithmetic coding are not produced by the camera ---
+            case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+            case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+                return false;
+
+            case 0xC4: {
+                const uint8_t* t = seg;
+                while (t + 17 <= segEnd) {
+                    int tableClass = t[0] >> 4, id = t[0] & 15;
+                    int total = 0;
+                    for (int i = 1; i <= 16; i++) total += t[i];
+                    if (id > 3 || tableClass > 1 || total > 256 || t + 17 + total > segEnd) return false;
+                    HuffTable& table = tableClass ? scan.ac[id] : scan.dc[id];
+                    if (!buildHuffTable(table, t + 1, t + 17, total)) return false;
+                    t += 17 + total;
+                }
+                break;
+            }
+
+            case 0xDB: {
+                /// --- only the DC step of each table is needed ---
+                const uint8_t* t = seg;
+                while (t + 65 <= segEnd) {
+                    int precision = t[0] >> 4, id = t[0] & 15;
+                    if (id > 3 || precision > 1 || t + 65 + 64 * precision > segEnd) return false;
+                    scan.dcQuant[id] = precision ? readU16(t + 1) : t[1];
+                    t += 65 + 64 * precision;
+                }
+                break;
+            }
+
+            case 0xDD:
+                if (segLen < 4) return false;
+                scan.restartInterval = readU16(seg);
+                break;
+
+            case 0xDA: {
+                scan.scanCount = seg[0];
+                if (scan.compCount == 0 || scan.scanCount < 1 || scan.scanCount > scan.compCount ||
+                    segLen < 6 + 2 * scan.scanCount) return false;
+                for (int i = 0; i < scan.scanCount; i++) {
+                    uint8_t id = seg[1 + 2 * i], tables = seg[2 + 2 * i];
+                    int comp = 0;
+                    while (comp < scan.compCount && scan.comps[comp].id != id) comp++;
+                    if (comp == scan.compCount) return false;
+                    scan.comps[comp].dcTable = tables >> 4;
+                    scan.comps[comp].acTable = tables & 15;
+                    if (scan.comps[comp].dcTable > 3 || scan.comps[comp].acTable > 3 ||
+                        !scan.dc[scan.comps[comp].dcTable].defined || !scan.ac[scan.comps[comp].acTable].defined) return false;
+                    scan.scanComps[i] = comp;
+                }
+                scan.data = segEnd;
+                scan.end  = end;
+                return true;
+            }
+
+            case 0xD9:
+                return false;
+        }
+
+        p = segEnd;
+    }
+
+    return false;
+}
+
+
+/// === skip the restart marker the bit reader stopped at ===
+static bool restart(JpegScan& scan) {
+    scan.bits   = 0;
+    scan.count  = 0;
+    scan.marker = false;
+
+    while (scan.data + 1 < scan.end && !(scan.data[0] == 0xFF && (scan.data[1] & 0xF8) == 0xD0)) {
+        scan.data++;
+    }
+    if (scan.data + 1 >= scan.end) {
+        return false;
+    }
+    scan.data += 2;
+    return true;
+}
+
+
+/// --- ~11 KB of tables is too much for a task stack, so the kernels are not reentrant ---
+static JpegScan scan;
+
+
+/// === parse a JPEG & lay out its blocks, false if it isn't a baseline JPEG ===
+static bool openScan(const uint8_t* jpeg, size_t len) {
+    memset(&scan, 0, sizeof(scan));
+
+    if (!parseHeaders(scan, jpeg, len) || scan.width == 0 || scan.height == 0) {
+        return false;
+    }
+
+    int hMax = 1, vMax = 1;
+    for (int i = 0; i < scan.compCount; i++) {
+        hMax = max(hMax, (int)scan.comps[i].h);
+        vMax = max(vMax, (int)scan.comps[i].v);
+    }
+
+    /// --- luma blocks covering the image, edge MCUs may carry padding blocks beyond it ---
+    const JpegComponent& luma = scan.comps[0];
+    scan.lumaCols = ((scan.width * luma.h + hMax - 1) / hMax + 7) / 8;
+    scan.lumaRows = ((scan.height * luma.v + vMax - 1) / vMax + 7) / 8;
+
+    /// --- a single-component scan codes blocks one by one, otherwise in interleaved MCUs ---
+    if (scan.scanCount == 1) {
+        const JpegComponent& c = scan.comps[scan.scanComps[0]];
+        scan.mcuCols = ((scan.width * c.h + hMax - 1) / hMax + 7) / 8;
+        scan.mcus    = scan.mcuCols * (((scan.height * c.v + vMax - 1) / vMax + 7) / 8);
+        scan.blocksPerMcu[0] = 1;
+    }
+    else {
+        scan.mcuCols = (scan.width + 8 * hMax - 1) / (8 * hMax);
+        scan.mcus    = scan.mcuCols * ((scan.height + 8 * vMax - 1) / (8 * vMax));
+        for (int i = 0; i < scan.scanCount; i++) {
+            const JpegComponent& c = scan.comps[scan.scanComps[i]];
+            scan.blocksPerMcu[i] = c.h * c.v;
+        }
+    }
+
+    return true;
+}
+
+
+/// === decode the opened scan, calling visit(col, row, dc, energy) for every luma block inside the image ===
+template <typename Visit>
+static bool walkLumaBlocks(Visit visit) {
+    const JpegComponent& luma = scan.comps[0];
+    int32_t predictor[3] = {};
+
+    for (int mcu = 0; mcu < scan.mcus; mcu++) {
+        if (scan.restartInterval && mcu > 0 && mcu % scan.restartInterval == 0) {
+            if (!restart(scan)) {
+                return false;
+            }
+            predictor[0] = predictor[1] = predictor[2] = 0;
+        }
+
+        for (int i = 0; i < scan.scanCount; i++) {
+            int comp = scan.scanComps[i];
+            const HuffTable& dc = scan.dc[scan.comps[comp].dcTable];
+            const HuffTable& ac = scan.ac[scan.comps[comp].acTable];
+
+            for (int b = 0; b < scan.blocksPerMcu[i]; b++) {
+                int32_t dcDiff;
+                int32_t blockEnergy = decodeBlock(scan, dc, ac, dcDiff);
+                if (blockEnergy < 0) {
+                    return false;
+                }
+                /// --- DC is coded as the difference to the previous block of the component ---
+                predictor[i] += dcDiff;
+
+                /// --- the first frame component is luma ---
+                if (comp != 0) {
+                    continue;
+                }
+                int col = scan.scanCount == 1 ? mcu % scan.mcuCols : (mcu % scan.mcuCols) * luma.h + b % luma.h;
+                int row = scan.scanCount == 1 ? mcu / scan.mcuCols : (mcu / scan.mcuCols) * luma.v + b / luma.h;
+                if (col < scan.lumaCols && row < scan.lumaRows) {
+                    visit(col, row, predictor[i], blockEnergy);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/// === score a JPEG by the AC energy of its luma blocks ===
+uint32_t jpegSharpness(const uint8_t* jpeg, size_t len) {
+    if (!openScan(jpeg, len)) {
+        return 0;
+    }
+
+    uint64_t energy     = 0;
+    uint32_t lumaBlocks = 0;
+
+    bool ok = walkLumaBlocks([&](int col, int row, int32_t dc, int32_t blockEnergy) {
+        energy += blockEnergy;
+        lumaBlocks++;
+    });
+
+    return ok && lumaBlocks ? (uint32_t)(energy * 16 / lumaBlocks) : 0;
+}
+
+
+/// === area-average the block means of a JPEG's luma into an outW x outH thumbnail ===
+bool jpegLumaThumbnail(const uint8_t* jpeg, size_t len, uint8_t* out, int outW, int outH) {
+    /// --- sums per output pixel, sized for the classifier input ---
+    static uint32_t sums[JPEG_THUMBNAIL_MAX];
+    static uint16_t counts[JPEG_THUMBNAIL_MAX];
+
+    if (outW * outH > JPEG_THUMBNAIL_MAX || !openScan(jpeg, len) ||
+        scan.lumaCols < outW || scan.lumaRows < outH) {
+        return false;
+    }
+
+    memset(sums, 0, sizeof(uint32_t) * outW * outH);
+    memset(counts, 0, sizeof(uint16_t) * outW * outH);
+
+    /// --- block mean level = dequantised DC / 8 + 128, unquantised if the frame has no DQT ---
+    int32_t quant = scan.dcQuant[scan.comps[0].quantTable];
+    if (quant == 0) quant = 1;
+
+    int lumaCols = scan.lumaCols, lumaRows = scan.lumaRows;
+    bool ok = walkLumaBlocks([&](int col, int row, int32_t dc, int32_t blockEnergy) {
+        int level = 128 + ((dc * quant + 4) >> 3);
+        int cell  = (row * outH / lumaRows) * outW + col * outW / lumaCols;
+        sums[cell]   += constrain(level, 0, 255);
+        counts[cell] += 1;
+    });
+    if (!ok) {
+        return false;
+    }
+
+    for (int i = 0; i < outW * outH; i++) {
+        out[i] = (uint8_t)((sums[i] + counts[i] / 2) / counts[i]);
+    }
+
+    return true;
+}
\ No newline at end of file
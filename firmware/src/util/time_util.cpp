@@ -1,8 +1,6 @@
 // === standard headers ===
 // --- system time functions --
 #include <time.h>
-// --- ESP32 sleep modes ---
-#include <esp_sleep.h>
 
 
 // === project headers ===
@@ -13,12 +11,17 @@
 #include "settings.h"
 
 // --- utilities ---
+#include "activity.h"
 #include "debug.h"
 #include "error.h"
 
 
 /// === sync with current local time ===
 void initTime() {
+    /// --- unsynced clock before the sync, so state stamped with it can follow the jump ---
+    time_t        unsyncedAt = time(nullptr);
+    unsigned long startedAt  = millis();
+
     /// --- configure time --- 
     configTime(gmtOffset_sec, daylightOffset_sec, ntpServer);
 
@@ -40,6 +43,9 @@ void initTime() {
         error("Failed to obtain time", false);
     }
 
+    /// --- no-op while still unsynced ---
+    rebaseActivity(unsyncedAt + (millis() - startedAt) / 1000, time(nullptr));
+
     /// --- debug: print local time ---
     char timeNow[40];
     strftime(timeNow, sizeof(timeNow), "%Y-%m-%d_%H-%M-%S", &timeinfo);
@@ -62,14 +68,13 @@ String getCurrentDateTime() {
 }
 
 
-/// === schedule a random wake-up time for overnight cloud upload ===
-void scheduleRandomTimerWake() {
+/// === upload window in progress or next to come, false without a synced clock ===
+bool nextUploadWindow(time_t& uploadStartTs, time_t& uploadEndTs) {
 
     /// --- get current local time ---
     struct tm timeinfo;
     if (!getLocalTime(&timeinfo)) {
-        error("Cannot schedule upload wake (no time)", false);
-        return;
+        return false;
     }
 
     /// --- convert current time to epoch seconds ---
@@ -80,14 +85,14 @@ void scheduleRandomTimerWake() {
     uploadStart.tm_hour = UPLOAD_START_HOUR;
     uploadStart.tm_min  = 0;
     uploadStart.tm_sec  = 0;
-    time_t uploadStartTs = mktime(&uploadStart);
+    uploadStartTs = mktime(&uploadStart);
 
     /// --- build end of today's upload window ---
     struct tm uploadEnd = timeinfo;
     uploadEnd.tm_hour = UPLOAD_END_HOUR;
     uploadEnd.tm_min  = 0;
     uploadEnd.tm_sec  = 0;
-    time_t uploadEndTs = mktime(&uploadEnd);
+    uploadEndTs = mktime(&uploadEnd);
 
     /// --- handle window spanning midnight ---
     if (UPLOAD_START_HOUR > UPLOAD_END_HOUR) {
@@ -101,44 +106,16 @@ void scheduleRandomTimerWake() {
         }
     }
 
-    /// --- if currently inside upload window, start from NOW ---
-    if (now >= uploadStartTs && now < uploadEndTs) {
-        uploadStartTs = now;
-    }
-    /// --- otherwise, if already past today's window, move to tomorrow ---
-    else if (now >= uploadEndTs) {
+    /// --- if already past today's window, move to tomorrow ---
+    if (now >= uploadEndTs) {
         uploadStartTs += 24 * 3600;
         uploadEndTs   += 24 * 3600;
     }
 
-    /// --- calculate remaining window length ---
-    uint32_t windowSeconds = difftime(uploadEndTs, uploadStartTs);
-
-    if (windowSeconds == 0) {
-        error("Upload window length is zero", false);
-        return;
-    }
-
-    /// --- generate random offset inside window ---
-    uint32_t randomOffset = esp_random() % windowSeconds;
-
-    /// --- final scheduled wake-up time ---
-    time_t wakeTime = uploadStartTs + randomOffset;
-
-    /// --- compute sleep duration from now ---
-    uint64_t sleepSeconds = difftime(wakeTime, now);
-
-    /// --- debug output ---
-    DBG_PRINT("Scheduling upload wake in ");
-    DBG_PRINT(sleepSeconds);
-    DBG_PRINTLN(" seconds");
-
-    /// --- configure deep sleep timer wake-up ---
-    esp_sleep_enable_timer_wakeup(sleepSeconds * 1000000ULL);
+    return true;
 }
 
 
-
 /// === check if right time to upload ===
 bool timeToUpload() {
     /// --- get current time ---
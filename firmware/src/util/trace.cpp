@@ -0,0 +1,137 @@
+// === standard headers ===
+// --- high resolution timer ---
+#include <esp_timer.h>
+
+// --- FreeRTOS mutexes ---
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "trace.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- utilities ---
+#include "debug.h"
+
+
+// === trace ring buffer, kept in RTC memory so it survives deep sleep ===
+RTC_DATA_ATTR static TraceRecord traceRing[TRACE_BUFFER_SIZE];
+RTC_DATA_ATTR static int         traceHead  = 0;
+RTC_DATA_ATTR static int         traceCount = 0;
+
+/// --- spans ever recorded, the ring holds the last traceCount of them ---
+RTC_DATA_ATTR static uint32_t    traceWritten = 0;
+
+/// --- wake counter, tells spans from different boots apart ---
+RTC_DATA_ATTR static uint8_t     traceWake  = 0;
+
+/// --- guards the ring indices, tracepoints may run on any task ---
+static portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+
+
+// === export format ===
+/// --- "GBTR" magic, version, record size & record count precede the records ---
+const uint8_t TRACE_FORMAT_VERSION = 1;
+const int     TRACE_HEADER_LEN     = 8;
+
+
+/// === start a new wake in the trace ===
+void initTrace() {
+    traceWake++;
+}
+
+
+/// === timestamp marking the start of a span ===
+uint32_t traceBegin() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+
+/// === record a completed span, overwriting the oldest when full ===
+void traceEnd(TracePhase phase, uint32_t beginUs) {
+    uint32_t endUs = (uint32_t)esp_timer_get_time();
+
+    portENTER_CRITICAL(&traceMux);
+    TraceRecord& record = traceRing[(traceHead + traceCount) % TRACE_BUFFER_SIZE];
+    record.phase    = phase;
+    record.wake     = traceWake;
+    record.reserved = 0;
+    record.beginUs  = beginUs;
+    record.endUs    = endUs;
+
+    traceWritten++;
+
+    if (traceCount < TRACE_BUFFER_SIZE) {
+        traceCount++;
+    }
+    else {
+        traceHead = (traceHead + 1) % TRACE_BUFFER_SIZE;
+    }
+    portEXIT_CRITICAL(&traceMux);
+}
+
+
+/// === publish the ring buffer as one binary message on doorbell/trace ===
+bool flushTraceToMQTT() {
+    if (mqttLock == nullptr || !mqttConnected()) {
+        return false;
+    }
+
+    /// --- snapshot the ring so tracepoints are not blocked by the network ---
+    static TraceRecord records[TRACE_BUFFER_SIZE];
+    portENTER_CRITICAL(&traceMux);
+    int      count       = traceCount;
+    uint32_t snapshotEnd = traceWritten;
+    for (int i = 0; i < count; i++) {
+        records[i] = traceRing[(traceHead + i) % TRACE_BUFFER_SIZE];
+    }
+    portEXIT_CRITICAL(&traceMux);
+
+    if (count == 0) {
+        return true;
+    }
+
+    uint8_t header[TRACE_HEADER_LEN] = {
+        'G', 'B', 'T', 'R',
+        TRACE_FORMAT_VERSION,
+        sizeof(TraceRecord),
+        (uint8_t)(count & 0xFF),
+        (uint8_t)(count >> 8)
+    };
+    size_t bodyLen = count * sizeof(TraceRecord);
+
+    /// --- the client is left alone while the MQTT task reconnects ---
+    if (xSemaphoreTake(mqttLock, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    if (!mqttConnected()) {
+        xSemaphoreGive(mqttLock);
+        return false;
+    }
+
+    bool ok = mqtt.beginPublish("doorbell/trace", TRACE_HEADER_LEN + bodyLen, false) &&
+              mqtt.write(header, TRACE_HEADER_LEN) == TRACE_HEADER_LEN &&
+              mqtt.write((const uint8_t*)records, bodyLen) == bodyLen &&
+              mqtt.endPublish();
+
+    xSemaphoreGive(mqttLock);
+
+    /// --- drop only the exported records still in the ring, spans that overwrote some of them meanwhile are kept ---
+    if (ok) {
+        portENTER_CRITICAL(&traceMux);
+        uint32_t oldest   = traceWritten - traceCount;
+        int      exported = snapshotEnd > oldest ? (int)min((uint32_t)traceCount, snapshotEnd - oldest) : 0;
+        traceHead = (traceHead + exported) % TRACE_BUFFER_SIZE;
+        traceCount -= exported;
+        portEXIT_CRITICAL(&traceMux);
+    }
+    else {
+        DBG_PRINTLN("Trace flush failed");
+    }
+
+    return ok;
+}
\ No newline at end of file
@@ -0,0 +1,221 @@
+// === standard headers ===
+// --- system time functions ---
+#include <time.h>
+
+// --- ESP32 sleep modes ---
+#include <esp_sleep.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "upload_scheduler.h"
+
+// --- configuration ---
+#include "settings.h"
+
+// --- network ---
+#include "mqtt.h"
+
+// --- services ---
+#include "fleet.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "error.h"
+#include "time_util.h"
+#include "capture_session.h"
+
+
+// The upload wake is a fleet lease when one can be had, sized by the same
+// estimates below, & planned from the backlog otherwise instead of drawn at
+// random. The backlog in bytes is the pending captures times the average
+// capture size, & its drain time follows from the measured upload throughput
+// plus the boot cost of each timer wake. A backlog that takes longer than
+// uploadWakeBudget is split over several wakes; the first is placed at random
+// in its share of the window's slack, so the drain still ends inside the
+// window & the uplink load is spread as before. A leased wake is bounded by
+// its lease, so only planned wakes stop at their budget. The plan is redone
+// before every deep sleep with what is left. Throughput, capture size & wake
+// cost are running estimates over every drain. When a night ends its drained
+// bytes are compared with the planned ones, & a night falling short makes the
+// following plans start earlier.
+
+
+// === running estimates, carried over deep sleep ===
+RTC_DATA_ATTR static float    drainRate    = uploadDefaultRate;
+RTC_DATA_ATTR static uint32_t fileSize     = uploadDefaultFileSize;
+RTC_DATA_ATTR static uint32_t wakeOverhead = uploadDefaultOverhead;
+
+/// --- share of the planned bytes recent nights drained, scales the planned throughput ---
+RTC_DATA_ATTR static float completion = 1.0f;
+
+
+// === the night being planned, identified by the end of its window ===
+RTC_DATA_ATTR static uint32_t nightEnd     = 0;
+RTC_DATA_ATTR static uint32_t nightPlanned = 0;
+RTC_DATA_ATTR static uint32_t nightRate    = 0;
+RTC_DATA_ATTR static uint32_t nightBytes   = 0;
+RTC_DATA_ATTR static uint32_t nightMs      = 0;
+RTC_DATA_ATTR static bool     nightLeft    = false;
+
+
+/// --- the wake was planned here & not leased from the fleet, so uploadWakeBudget applies ---
+RTC_DATA_ATTR static bool budgetedWake = true;
+
+
+// === drains of this wake ===
+static unsigned long drainStart = 0;
+static unsigned long wakeDrained = 0;
+static time_t        drainUntil  = 0;
+
+
+/// === estimated bytes waiting on the SD card ===
+static uint32_t backlogBytes() {
+    return min((uint64_t)pendingCaptures() * fileSize, (uint64_t)UINT32_MAX);
+}
+
+
+/// === throughput a plan counts on, in bytes/s ===
+static float plannedRate() {
+    return max(1.0f, drainRate * completion);
+}
+
+
+/// === plan the night of a window, reporting the previous night once a new one is planned ===
+static void planNight(time_t start, time_t end) {
+    bool fresh = (uint32_t)end != nightEnd;
+
+    if (fresh && nightEnd != 0 && nightPlanned > 0) {
+        float drained = min(1.0f, (float)nightBytes / nightPlanned);
+        completion = constrain(completion + (drained - completion) * uploadEstimateGain, 0.25f, 1.0f);
+
+        publishMQTT("doorbell/upload/night",
+            "{\"planned\":" + String(nightPlanned) +
+            ",\"drained\":" + String(nightBytes) +
+            ",\"planned_bps\":" + String(nightRate) +
+            ",\"bps\":" + String((uint32_t)(nightBytes * 1000ULL / max(1UL, (unsigned long)nightMs))) +
+            ",\"left\":" + String(nightLeft ? 1 : 0) + "}");
+    }
+
+    if (fresh) {
+        nightEnd   = end;
+        nightBytes = 0;
+        nightMs    = 0;
+        nightLeft  = false;
+    }
+
+    /// --- what the window can take of the backlog, following the backlog until the window opens ---
+    time_t now = time(nullptr);
+    if (fresh || now < start) {
+        uint32_t window = end - max(now, start);
+        nightRate    = plannedRate();
+        nightPlanned = min((float)backlogBytes(), (float)nightRate * window);
+    }
+}
+
+
+/// === start timing a drain, called once the drain is about to upload ===
+void beginUploadDrain() {
+    drainStart = millis() | 1;
+
+    /// --- the boot of a timer wake is part of every planned wake ---
+    if (wakeDrained == 0 && esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER) {
+        wakeOverhead += ((float)millis() - wakeOverhead) * uploadEstimateGain;
+    }
+
+    /// --- drains end with the window they started in ---
+    time_t start;
+    if (!nextUploadWindow(start, drainUntil) || time(nullptr) < start) {
+        drainUntil = 0;
+        return;
+    }
+    planNight(start, drainUntil);
+}
+
+
+/// === fold a drain into the estimates & tonight's tally ===
+void endUploadDrain(uint32_t files, uint32_t bytes, bool imagesLeft) {
+    unsigned long ms = drainStart ? millis() - drainStart : 0;
+    drainStart   = 0;
+    wakeDrained += ms;
+
+    /// --- a drain of a file or two is all latency, it says little about throughput ---
+    if (files >= 2 && ms > 0) {
+        drainRate += (bytes * 1000.0f / ms - drainRate) * uploadEstimateGain;
+        fileSize  += ((float)bytes / files - fileSize) * uploadEstimateGain;
+    }
+
+    if (drainUntil != 0) {
+        nightBytes += bytes;
+        nightMs    += ms;
+        nightLeft   = imagesLeft;
+    }
+}
+
+
+/// === check this wake may keep draining, within the budget of a planned wake & the window ===
+bool uploadBudgetLeft() {
+    unsigned long used = wakeDrained + (drainStart ? millis() - drainStart : 0);
+    if (budgetedWake && used >= uploadWakeBudget * 1000UL) {
+        return false;
+    }
+    return drainStart == 0 || drainUntil == 0 || time(nullptr) < drainUntil;
+}
+
+
+/// === seconds the backlog takes to drain at the planned throughput, including a wake's boot ===
+uint32_t uploadSecondsNeeded() {
+    return backlogBytes() / plannedRate() + wakeOverhead / 1000;
+}
+
+
+/// === lease fleet slots, or plan the wakes that drain the backlog inside the window, & set the timer to the next, false without a clock ===
+bool scheduleUploadWake() {
+    /// --- a lease is sized from uploadSecondsNeeded() & ends the drain itself ---
+    if (scheduleFleetUploadWake()) {
+        budgetedWake = false;
+        return true;
+    }
+    budgetedWake = true;
+
+    time_t start, end;
+    if (!nextUploadWindow(start, end)) {
+        error("Cannot schedule upload wake (no time)", false);
+        return false;
+    }
+
+    /// --- too close to the end of tonight's window, plan tomorrow's ---
+    time_t now  = time(nullptr);
+    time_t from = max(start, now + (time_t)uploadRetryDelay);
+    if (from >= end) {
+        start += 24 * 3600;
+        end   += 24 * 3600;
+        from   = start;
+    }
+    planNight(start, end);
+
+    /// --- time the backlog needs, split into wakes of at most uploadWakeBudget ---
+    uint32_t bytes  = backlogBytes();
+    uint32_t drainS = bytes / plannedRate();
+    uint32_t wakes  = max(1UL, (drainS + uploadWakeBudget - 1) / uploadWakeBudget);
+    uint32_t needS  = drainS + wakes * (wakeOverhead / 1000);
+
+    /// --- the first wake lands anywhere in its share of the slack, later ones are planned after it ---
+    uint32_t windowS = end - from;
+    uint32_t slack   = windowS > needS ? windowS - needS : 0;
+    time_t   wakeAt  = from + (slack > 0 ? esp_random() % (slack / wakes + 1) : 0);
+
+    uint64_t sleepSeconds = wakeAt - now;
+    DBG_PRINTF("Backlog %u bytes in %u wakes, %u s of %u s, next upload wake in %u s\n",
+               bytes, wakes, needS, windowS, (uint32_t)sleepSeconds);
+
+    publishMQTT("doorbell/upload/plan",
+        "{\"bytes\":" + String(bytes) +
+        ",\"bps\":" + String((uint32_t)plannedRate()) +
+        ",\"wakes\":" + String(wakes) +
+        ",\"need_s\":" + String(needS) +
+        ",\"wake_in\":" + String((uint32_t)sleepSeconds) + "}");
+
+    esp_sleep_enable_timer_wakeup(sleepSeconds * 1000000ULL);
+    return true;
+}
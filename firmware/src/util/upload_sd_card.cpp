@@ -0,0 +1,333 @@
+// === standard headers ===
+// --- SD card access via SD_MMC interface ---
+#include <SD_MMC.h>
+
+
+// === project headers ===
+// --- corresponding header ---
+#include "upload_sd_card.h"
+
+// --- configuration ---
+#include "settings.h"
+#include "pins.h"
+
+// --- hardware ---
+#include "mcp23017.h"
+#include "hot_tier.h"
+
+// --- services ---
+#include "upload_engine.h"
+#include "fleet.h"
+
+// --- utilities ---
+#include "debug.h"
+#include "capture_session.h"
+#include "upload_scheduler.h"
+#include "journal.h"
+
+
+// === upload manifest ===
+// Paths uploaded but not yet deleted or retired are remembered as 64-bit
+// FNV-1a hashes, so a drain interrupted mid directory doesn't upload them
+// again. The hashes are kept sorted in RAM for a binary search per file &
+// appended to the hot tier uploadManifestBatch at a time, and whenever the
+// drain stops. The manifest only covers the directory being uploaded, it is
+// cleared once the directory is done, so uploadManifestMax bounds it; files
+// past that are uploaded again after an interruption rather than skipped.
+
+/// --- hashes on the hot tier, 8 bytes each in the order they were uploaded ---
+static const char* manifestPath = "/upload_manifest.bin";
+
+/// --- one path per line, written by older firmware ---
+static const char* legacyManifestPath = "/upload_manifest.txt";
+
+static uint64_t manifest[uploadManifestMax];
+static int      manifestCount = 0;
+
+/// --- recorded in RAM but not yet written ---
+static uint64_t manifestBatch[uploadManifestBatch];
+static int      manifestBatchCount = 0;
+
+
+// === drain statistics, journalled when the drain ends ===
+static uint16_t drainFiles = 0;
+static uint32_t drainBytes = 0;
+
+
+/// === FNV-1a hash of a path ===
+static uint64_t hashPath(const String& path) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < path.length(); i++) {
+        hash = (hash ^ (uint8_t)path[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+/// === position of hash in the sorted manifest, or where it would go ===
+static int manifestSlot(uint64_t hash) {
+    int lo = 0, hi = manifestCount;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (manifest[mid] < hash) lo = mid + 1;
+        else                      hi = mid;
+    }
+    return lo;
+}
+
+
+/// === check a path was uploaded by this or an interrupted drain ===
+static bool inManifest(const String& path) {
+    uint64_t hash = hashPath(path);
+    int slot = manifestSlot(hash);
+    return slot < manifestCount && manifest[slot] == hash;
+}
+
+
+/// === add a hash to the sorted manifest, false if it is full or already there ===
+static bool insertManifest(uint64_t hash) {
+    int slot = manifestSlot(hash);
+    if (manifestCount == uploadManifestMax || (slot < manifestCount && manifest[slot] == hash)) {
+        return false;
+    }
+    memmove(manifest + slot + 1, manifest + slot, sizeof(uint64_t) * (manifestCount - slot));
+    manifest[slot] = hash;
+    manifestCount++;
+    return true;
+}
+
+
+/// === write the recorded hashes not yet on the hot tier ===
+static void flushManifest() {
+    if (manifestBatchCount == 0) {
+        return;
+    }
+    File file = hotFS().open(manifestPath, FILE_APPEND);
+    if (file) {
+        file.write((const uint8_t*)manifestBatch, sizeof(uint64_t) * manifestBatchCount);
+        file.close();
+    }
+    manifestBatchCount = 0;
+}
+
+
+/// === record an uploaded file before deleting or retiring it ===
+static void appendManifest(const String& path) {
+    uint64_t hash = hashPath(path);
+    if (!insertManifest(hash)) {
+        return;
+    }
+    manifestBatch[manifestBatchCount++] = hash;
+    if (manifestBatchCount == uploadManifestBatch) {
+        flushManifest();
+    }
+}
+
+
+/// === load the manifest, picking up the path list of older firmware ===
+static void loadManifest() {
+    manifestCount      = 0;
+    manifestBatchCount = 0;
+
+    File file = hotFS().open(manifestPath, FILE_READ);
+    if (file) {
+        uint64_t hash;
+        while (file.read((uint8_t*)&hash, sizeof(hash)) == sizeof(hash)) {
+            insertManifest(hash);
+        }
+        file.close();
+    }
+
+    File legacy = hotFS().open(legacyManifestPath, FILE_READ);
+    if (legacy) {
+        while (legacy.available()) {
+            String path = legacy.readStringUntil('\n');
+            if (path.length() > 0) {
+                appendManifest(path);
+            }
+        }
+        legacy.close();
+        flushManifest();
+        hotFS().remove(legacyManifestPath);
+    }
+}
+
+
+/// === forget every recorded path ===
+static void clearManifest() {
+    hotFS().remove(manifestPath);
+    manifestCount      = 0;
+    manifestBatchCount = 0;
+}
+
+
+/// === record a finished upload, false if it failed ===
+static bool finishUpload(const UploadResult& result, bool deleteEach) {
+    if (!result.ok) {
+        DBG_PRINTLN("Upload failed " + String(result.path));
+        return false;
+    }
+
+    drainFiles++;
+    drainBytes += result.bytes;
+
+    /// --- record file, sessions are deleted whole once complete ---
+    appendManifest(result.path);
+    if (deleteEach) {
+        DBG_PRINTLN("Upload OK deleting " + String(result.path) + " from SD card");
+        SD_MMC.remove(result.path);
+    }
+    return true;
+}
+
+
+/// === upload every JPEG in dir, false if stopped by a failed upload, motion or the end of the upload slot ===
+static bool uploadDirectory(const String& dir, bool deleteEach) {
+    File root = SD_MMC.open(dir);
+    if (!root || !root.isDirectory()) {
+        DBG_PRINTLN("ERROR: SD open failed " + dir);
+        return false;
+    }
+
+    String prefix = dir == "/" ? String("/") : dir + "/";
+
+    /// --- open next available file ---
+    File file = root.openNextFile();
+
+    int  inFlight = 0;
+    bool stopped  = false;
+
+    /// --- keep the upload queue full while files are left, then collect the uploads still running ---
+    while ((file && !stopped) || inFlight > 0) {
+        if (file && !stopped) {
+            /// --- skip folders, non-JPEGs & the last ring capture ---
+            String filename = file.name();
+            String path = prefix + filename;
+            if (file.isDirectory() || !filename.endsWith(".jpg") || filename == "IMG_" + lastRingCaptureFilename + ".jpg") {
+                file = root.openNextFile();
+                continue;
+            }
+
+            /// --- already uploaded by an interrupted drain ---
+            if (inManifest(path)) {
+                if (deleteEach) {
+                    DBG_PRINTLN("Already uploaded, deleting " + path + " from SD card");
+                    SD_MMC.remove(path);
+                }
+                file = root.openNextFile();
+                continue;
+            }
+
+            /// --- queue the file & move on, a full queue waits for a result below ---
+            UploadSubmit submitted = submitUpload(path);
+            if (submitted != UPLOAD_QUEUE_FULL) {
+                if (submitted == UPLOAD_QUEUED) {
+                    inFlight++;
+                }
+                file = root.openNextFile();
+                continue;
+            }
+        }
+
+        UploadResult result;
+        if (nextUploadResult(result, 100)) {
+            inFlight--;
+            if (!finishUpload(result, deleteEach) && !stopped) {
+                DBG_PRINTLN("Upload failed, stopping uploads");
+                stopped = true;
+                inFlight -= cancelUploads();
+            }
+        }
+
+        /// --- stop if motion detected, uploads already running are finished ---
+        if (!stopped && mcp.digitalRead(PIR_PIN) == HIGH) {
+            DBG_PRINTLN("Motion detected, stopping uploads");
+            stopped = true;
+            inFlight -= cancelUploads();
+        }
+
+        /// --- stop at the end of the leased slots unless the next slot is free ---
+        if (!stopped && !fleetMayUpload()) {
+            DBG_PRINTLN("Upload slot ended, stopping uploads");
+            stopped = true;
+            inFlight -= cancelUploads();
+        }
+
+        /// --- stop once this wake drained for its share of the plan or the window closes ---
+        if (!stopped && !uploadBudgetLeft()) {
+            DBG_PRINTLN("Upload budget of this wake used, stopping uploads");
+            stopped = true;
+            inFlight -= cancelUploads();
+        }
+    }
+
+    /// --- an interrupted drain resumes with every recorded upload ---
+    flushManifest();
+
+    return !stopped;
+}
+
+
+/// === path of the first session on the SD card, empty if there is none ===
+static String nextSession() {
+    File root = SD_MMC.open(SESSIONS_ROOT);
+    File entry = root ? root.openNextFile() : File();
+    while (entry) {
+        if (entry.isDirectory()) {
+            return String(SESSIONS_ROOT) + "/" + entry.name();
+        }
+        entry = root.openNextFile();
+    }
+    return String();
+}
+
+
+/// === journal the drain & reset last action endtime, returns imagesLeft ===
+static bool endDrain(bool imagesLeft) {
+    stopUploads();
+    journal(JOURNAL_UPLOAD, imagesLeft, drainFiles, drainBytes);
+    endUploadDrain(drainFiles, drainBytes, imagesLeft);
+    capturesUploaded(imagesLeft ? drainFiles : pendingCaptures());
+    lastActionTime = millis();
+    return imagesLeft;
+}
+
+
+/// === upload & delete all images (JPEG files) from SD card ===
+bool uploadAndDeleteAll() {
+    drainFiles = 0;
+    drainBytes = 0;
+
+    /// --- connections are opened by worker tasks that live for the drain ---
+    if (!startUploads()) {
+        lastActionTime = millis();
+        return true;
+    }
+    beginUploadDrain();
+
+    /// --- files a previous drain uploaded but was interrupted before deleting ---
+    loadManifest();
+
+    /// --- captures saved in the root before sessions existed are deleted one by one ---
+    if (!uploadDirectory("/", true)) {
+        return endDrain(true);
+    }
+    clearManifest();
+
+    /// --- sessions are uploaded in directory order & retired whole ---
+    String session = nextSession();
+    while (session.length() > 0) {
+        if (!uploadDirectory(session, false)) {
+            return endDrain(true);
+        }
+
+        retireSession(session);
+        clearManifest();
+
+        session = nextSession();
+    }
+
+    /// --- reset last action endtime to current time & finish uploading ---
+    DBG_PRINTLN("No images left to upload");
+    return endDrain(false);
+}
\ No newline at end of file
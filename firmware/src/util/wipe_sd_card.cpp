@@ -1,8 +1,3 @@
-// === standard headers ===
-// --- SD card access via SD_MMC interface ---
-#include <SD_MMC.h>
-
-
 // === project headers ===
 // --- corresponding header ---
 #include "wipe_sd_card.h"
@@ -18,9 +13,10 @@
 #include "debug.h"
 #include "error.h"
 #include "button_interrupt.h"
+#include "capture_session.h"
 
 
-/// === delete all images (JPEG files) from SD card ===
+/// === delete all captures from SD card ===
 void deleteAll() {
     bool shouldDelete = false;
 
@@ -32,7 +28,7 @@ void deleteAll() {
 
         /// --- if button pushed prepare to delete ---
         if (lastState == HIGH && currentState == LOW) {
-            shouldRing = true;
+            shouldDelete = true;
         }
 
         lastState = currentState;
@@ -57,36 +53,12 @@ void deleteAll() {
         /// --- reset the interrupt flag ---
         doorbellInterrupted = false;
 
-        /// --- open SD root directory ---
-        File root = SD_MMC.open("/");
-        if (!root || !root.isDirectory()) {
-            error("ERROR: SD root open failed", false);
-        }
-
-        /// --- open next available file in root ---
-        File file = root.openNextFile();
+        /// --- swap the session root, the files are deleted lazily by reclaimTrash() ---
+        mcp.digitalWrite(BLUE_LED_PIN, HIGH);
+        wipeSessions();
+        mcp.digitalWrite(BLUE_LED_PIN, LOW);
 
-        /// --- loop through files ---
-        while (file) {
-            delay(50);
-            mcp.digitalWrite(BLUE_LED_PIN, HIGH);
-
-            /// --- skip folders, non-JPEGs & the latest ring capture ---
-            String filename = file.name();
-            if (file.isDirectory() || !filename.endsWith(".jpg") || filename == "IMG_" + lastRingCaptureFilename + ".jpg") {
-                file = root.openNextFile();
-                continue;
-            }
-
-            /// --- delete file ---
-            DBG_PRINTLN("Upload OK deleting " + filename + " from SD card");
-            SD_MMC.remove("/" + filename);
-
-            /// --- open next available file in root ---
-            file = root.openNextFile();
-
-            mcp.digitalWrite(BLUE_LED_PIN, LOW);
-        }
+        DBG_PRINTLN("Captures wiped from SD card");
     }
 
 }
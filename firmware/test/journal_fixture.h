@@ -0,0 +1,102 @@
+#pragma once
+// === journal test fixture: a scratch SD card & an in-memory broker collecting exports ===
+//
+// Each suite is its own program, so RTC state starts out as after a power loss
+// & initJournal() recovers from whatever the suite put on the card.
+#include <unity.h>
+#include <Arduino.h>
+#include <SD_MMC.h>
+#include <esp_rom_crc.h>
+#include <filesystem>
+#include <vector>
+
+#include "mqtt.h"
+#include "journal.h"
+
+
+/// --- records published on doorbell/journal, in order ---
+inline std::vector<JournalRecord> exportedRecords;
+
+
+/// === empty SD card in a host directory of the suite ===
+inline void journalTestCard(const char* suite) {
+    String root = (std::filesystem::temp_directory_path() / suite).string().c_str();
+    std::error_code ec;
+    std::filesystem::remove_all(root.c_str(), ec);
+    SD_MMC.setHostRoot(root);
+    SD_MMC.begin("/sdcard", true);
+}
+
+
+/// === intact record with its CRC, as journal() writes it ===
+inline JournalRecord journalTestRecord(uint32_t seq) {
+    JournalRecord record = {};
+    record.seq   = seq;
+    record.time  = 1700000000 + seq;
+    record.event = JOURNAL_MOTION;
+    record.value = seq * 7;
+    record.crc   = esp_rom_crc32_le(0, (const uint8_t*)&record, offsetof(JournalRecord, crc));
+    return record;
+}
+
+
+/// === append count records from seq to a journal file ===
+inline void journalTestAppend(const char* path, uint32_t seq, uint32_t count) {
+    File file = SD_MMC.open(path, FILE_APPEND);
+    for (uint32_t i = 0; i < count; i++) {
+        JournalRecord record = journalTestRecord(seq + i);
+        file.write((const uint8_t*)&record, sizeof(record));
+    }
+    file.close();
+}
+
+
+/// === overwrite bytes at an offset of a file, e.g. to break a record's CRC ===
+inline void journalTestPatch(const char* path, size_t offset, const void* bytes, size_t len) {
+    FILE* file = fopen((SD_MMC.hostRoot() + path).c_str(), "r+b");
+    fseek(file, offset, SEEK_SET);
+    fwrite(bytes, 1, len, file);
+    fclose(file);
+}
+
+
+/// === export position as stored on the card, 0 if there is none ===
+inline uint32_t journalTestExportedSeq() {
+    uint32_t seq = 0;
+    File file = SD_MMC.open(JOURNAL_EXPORTED_PATH, FILE_READ);
+    if (file) {
+        file.read((uint8_t*)&seq, sizeof(seq));
+        file.close();
+    }
+    return seq;
+}
+
+
+/// === start the MQTT task against the in-memory broker & wait for it to connect, the first test of a suite ===
+inline void testBrokerConnects() {
+    mqtt.fakeOnPublish = [](const String& topic, const uint8_t* payload, size_t len) {
+        if (topic != "doorbell/journal") {
+            return;
+        }
+        size_t count = payload[6] | (payload[7] << 8);
+        const JournalRecord* records = (const JournalRecord*)(payload + 8);
+        exportedRecords.insert(exportedRecords.end(), records, records + count);
+    };
+    PubSubClient::fakeBrokerUp = true;
+    initMQTT();
+
+    for (int i = 0; i < 100 && !mqttConnected(); i++) {
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    TEST_ASSERT_TRUE_MESSAGE(mqttConnected(), "in-memory broker");
+}
+
+
+/// === sequence numbers of the exported records ===
+inline std::vector<uint32_t> exportedSeqs() {
+    std::vector<uint32_t> seqs;
+    for (const JournalRecord& record : exportedRecords) {
+        seqs.push_back(record.seq);
+    }
+    return seqs;
+}
\ No newline at end of file
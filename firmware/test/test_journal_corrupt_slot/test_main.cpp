@@ -0,0 +1,84 @@
+// === range reads over a journal with corrupt slots in the middle ===
+#include "../journal_fixture.h"
+
+
+/// --- 100 records, slot 50 is the binary search's first probe ---
+const uint32_t RECORDS   = 100;
+const uint32_t CORRUPT[] = { 40, 50 };
+
+
+void setUp() {
+    exportedRecords.clear();
+}
+
+void tearDown() {}
+
+
+/// === every intact record from seq on, in order ===
+static std::vector<uint32_t> intactFrom(uint32_t seq, uint32_t count) {
+    std::vector<uint32_t> seqs;
+    for (; seq < RECORDS && seqs.size() < count; seq++) {
+        if (seq != CORRUPT[0] && seq != CORRUPT[1]) {
+            seqs.push_back(seq);
+        }
+    }
+    return seqs;
+}
+
+
+static void assertExported(const std::vector<uint32_t>& expected) {
+    std::vector<uint32_t> seqs = exportedSeqs();
+    TEST_ASSERT_EQUAL(expected.size(), seqs.size());
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected.data(), seqs.data(), expected.size());
+}
+
+
+/// === the export resumes at the stored position & skips corrupt slots ===
+static void testExportSkipsCorruptSlots() {
+    TEST_ASSERT_EQUAL(RECORDS - 30 - 2, exportJournal(RECORDS));
+    assertExported(intactFrom(30, RECORDS));
+    TEST_ASSERT_EQUAL_UINT32(RECORDS, journalTestExportedSeq());
+}
+
+
+/// === a range starting on a corrupt slot begins at the next intact record ===
+static void testRangeFromCorruptSlot() {
+    requestJournalRange(40, 5);
+    serviceJournal();
+    assertExported(intactFrom(40, 5));
+}
+
+
+/// === the binary search passes over a corrupt probe both ways ===
+static void testRangeAroundCorruptProbe() {
+    for (uint32_t from : { 10u, 49u, 50u, 51u, 90u }) {
+        exportedRecords.clear();
+        requestJournalRange(from, 3);
+        serviceJournal();
+        assertExported(intactFrom(from, 3));
+    }
+}
+
+
+int main() {
+    journalTestCard("guardianbell_test_corrupt_slot");
+    journalTestAppend(JOURNAL_PATH, 0, RECORDS);
+    for (uint32_t slot : CORRUPT) {
+        uint32_t value = 0xDEADBEEF;
+        journalTestPatch(JOURNAL_PATH, slot * sizeof(JournalRecord) + offsetof(JournalRecord, value), &value, sizeof(value));
+    }
+
+    uint32_t exported = 30;
+    File file = SD_MMC.open(JOURNAL_EXPORTED_PATH, FILE_WRITE);
+    file.write((const uint8_t*)&exported, sizeof(exported));
+    file.close();
+
+    initJournal();
+
+    UNITY_BEGIN();
+    RUN_TEST(testBrokerConnects);
+    RUN_TEST(testExportSkipsCorruptSlots);
+    RUN_TEST(testRangeFromCorruptSlot);
+    RUN_TEST(testRangeAroundCorruptProbe);
+    return UNITY_END();
+}
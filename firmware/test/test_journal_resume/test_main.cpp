@@ -0,0 +1,65 @@
+// === export position & sequence carried across a power loss ===
+#include "../journal_fixture.h"
+
+
+/// --- 50 records on the card, the first 20 exported before the power loss ---
+const uint32_t RECORDS  = 50;
+const uint32_t EXPORTED = 20;
+
+
+void setUp() {
+    exportedRecords.clear();
+}
+
+void tearDown() {}
+
+
+/// === records journalled before the power loss are still exported, a batch at a time ===
+static void testResumesExport() {
+    TEST_ASSERT_EQUAL(10, exportJournal(10));
+    TEST_ASSERT_EQUAL_UINT32(EXPORTED, exportedRecords.front().seq);
+    TEST_ASSERT_EQUAL_UINT32(EXPORTED + 9, exportedRecords.back().seq);
+    TEST_ASSERT_EQUAL_UINT32(EXPORTED + 10, journalTestExportedSeq());
+
+    exportedRecords.clear();
+    TEST_ASSERT_EQUAL(RECORDS - EXPORTED - 10, exportJournal(100));
+    TEST_ASSERT_EQUAL_UINT32(EXPORTED + 10, exportedRecords.front().seq);
+    TEST_ASSERT_EQUAL_UINT32(RECORDS - 1, exportedRecords.back().seq);
+    TEST_ASSERT_EQUAL_UINT32(RECORDS, journalTestExportedSeq());
+
+    /// --- nothing is sent twice ---
+    TEST_ASSERT_EQUAL(0, exportJournal(100));
+}
+
+
+/// === new events continue a buffer past the last record on the card & export next ===
+static void testContinuesSequence() {
+    journal(JOURNAL_BOOT, 1);
+    journal(JOURNAL_SLEEP, 0);
+    TEST_ASSERT_TRUE(flushJournal());
+
+    TEST_ASSERT_EQUAL(2, exportJournal(100));
+    TEST_ASSERT_EQUAL_UINT32(RECORDS + JOURNAL_BUFFER_SIZE, exportedRecords[0].seq);
+    TEST_ASSERT_EQUAL_UINT32(RECORDS + JOURNAL_BUFFER_SIZE + 1, exportedRecords[1].seq);
+    TEST_ASSERT_EQUAL_UINT32(RECORDS + JOURNAL_BUFFER_SIZE + 2, journalTestExportedSeq());
+}
+
+
+int main() {
+    journalTestCard("guardianbell_test_resume");
+    journalTestAppend(JOURNAL_OLD_PATH, 0, 30);
+    journalTestAppend(JOURNAL_PATH, 30, RECORDS - 30);
+
+    uint32_t exported = EXPORTED;
+    File file = SD_MMC.open(JOURNAL_EXPORTED_PATH, FILE_WRITE);
+    file.write((const uint8_t*)&exported, sizeof(exported));
+    file.close();
+
+    initJournal();
+
+    UNITY_BEGIN();
+    RUN_TEST(testBrokerConnects);
+    RUN_TEST(testResumesExport);
+    RUN_TEST(testContinuesSequence);
+    return UNITY_END();
+}
@@ -0,0 +1,52 @@
+// === records of a flush the card cut short are written again, once ===
+#include "../journal_fixture.h"
+
+
+const int EVENTS = 5;
+
+
+void setUp() {}
+
+void tearDown() {}
+
+
+/// === a short write fails the flush & leaves the unwritten records buffered ===
+static void testShortWriteFails() {
+    for (int i = 0; i < EVENTS; i++) {
+        journal(JOURNAL_MOTION, 0, i);
+    }
+
+    /// --- two records & half of the third reach the card ---
+    FS::fakeWriteBudget = 2 * sizeof(JournalRecord) + sizeof(JournalRecord) / 2;
+    TEST_ASSERT_FALSE(flushJournal());
+    FS::fakeWriteBudget = -1;
+}
+
+
+/// === the next flush pads the torn slot & writes only what was lost ===
+static void testRetryWritesTheRest() {
+    TEST_ASSERT_TRUE(flushJournal());
+
+    /// --- two stored, one torn & padded, three written again ---
+    File file = SD_MMC.open(JOURNAL_PATH, FILE_READ);
+    TEST_ASSERT_EQUAL_UINT32((EVENTS + 1) * sizeof(JournalRecord), file.size());
+    file.close();
+
+    TEST_ASSERT_EQUAL(EVENTS, exportJournal(100));
+    for (int i = 0; i < EVENTS; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i, exportedRecords[i].seq);
+        TEST_ASSERT_EQUAL_UINT16(i, exportedRecords[i].arg);
+    }
+}
+
+
+int main() {
+    journalTestCard("guardianbell_test_short_write");
+    initJournal();
+
+    UNITY_BEGIN();
+    RUN_TEST(testBrokerConnects);
+    RUN_TEST(testShortWriteFails);
+    RUN_TEST(testRetryWritesTheRest);
+    return UNITY_END();
+}
@@ -0,0 +1,66 @@
+// === journal recovery from a write torn by power loss ===
+#include "../journal_fixture.h"
+
+
+/// --- ten intact records & the first 7 bytes of the eleventh ---
+const uint32_t INTACT = 10;
+const size_t   TORN   = 7;
+
+
+void setUp() {}
+
+void tearDown() {}
+
+
+/// === the torn slot is padded & the sequence continues a buffer past the last intact record ===
+static void testRecoversPastTornTail() {
+    initJournal();
+
+    File file = SD_MMC.open(JOURNAL_PATH, FILE_READ);
+    TEST_ASSERT_EQUAL_UINT32((INTACT + 1) * sizeof(JournalRecord), file.size());
+    file.close();
+
+    journal(JOURNAL_RING, 1);
+    TEST_ASSERT_TRUE(flushJournal());
+
+    file = SD_MMC.open(JOURNAL_PATH, FILE_READ);
+    TEST_ASSERT_EQUAL_UINT32((INTACT + 2) * sizeof(JournalRecord), file.size());
+    file.close();
+}
+
+
+/// === a fresh export starts at the recovered sequence, the records before it are only read on request ===
+static void testExportsAfterRecovery() {
+    TEST_ASSERT_EQUAL(1, exportJournal(100));
+    TEST_ASSERT_EQUAL_UINT32(INTACT + JOURNAL_BUFFER_SIZE, exportedRecords[0].seq);
+    TEST_ASSERT_EQUAL_UINT8(JOURNAL_RING, exportedRecords[0].event);
+    TEST_ASSERT_EQUAL_UINT32(INTACT + JOURNAL_BUFFER_SIZE + 1, journalTestExportedSeq());
+
+    /// --- the padding fails its CRC & is skipped ---
+    exportedRecords.clear();
+    requestJournalRange(0, 100);
+    serviceJournal();
+
+    std::vector<uint32_t> seqs = exportedSeqs();
+    TEST_ASSERT_EQUAL(INTACT + 1, seqs.size());
+    for (uint32_t i = 0; i < INTACT; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i, seqs[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(INTACT + JOURNAL_BUFFER_SIZE, seqs[INTACT]);
+}
+
+
+int main() {
+    journalTestCard("guardianbell_test_torn_tail");
+    journalTestAppend(JOURNAL_PATH, 0, INTACT + 1);
+    File file = SD_MMC.open(JOURNAL_PATH, FILE_READ);
+    size_t full = file.size();
+    file.close();
+    std::filesystem::resize_file((SD_MMC.hostRoot() + JOURNAL_PATH).c_str(), full - sizeof(JournalRecord) + TORN);
+
+    UNITY_BEGIN();
+    RUN_TEST(testBrokerConnects);
+    RUN_TEST(testRecoversPastTornTail);
+    RUN_TEST(testExportsAfterRecovery);
+    return UNITY_END();
+}
@@ -0,0 +1,362 @@
+// === cloud side: spooled files uploaded to Cloudinary over one kept-alive TLS connection ===
+//
+// The request mirrors postImageToCloudinary() in the firmware, so a file gets
+// the same public id whichever path it took. Files are sent oldest first, at
+// most rateKbps on average; a failed upload backs off exponentially up to
+// backoffMax seconds & leaves the file in the spool, while one Cloudinary
+// refuses outright is moved to <spool>/rejected for a look by hand.
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gateway.h"
+
+namespace fs = std::filesystem;
+
+
+/// === seconds a request may take before the connection is dropped ===
+static const int requestTimeout = 60;
+
+
+class CloudConnection {
+public:
+    explicit CloudConnection(const Options& options) : options_(options) {}
+
+    ~CloudConnection() {
+        disconnect();
+        if (ctx_) {
+            SSL_CTX_free(ctx_);
+        }
+    }
+
+    int upload(const fs::path& path, const std::string& name);
+
+private:
+    bool connect();
+    void disconnect();
+    bool writeAll(const void* data, size_t len);
+    int  readResponse();
+    bool readLine(std::string& line);
+
+    const Options& options_;
+    SSL_CTX*       ctx_ = nullptr;
+    SSL*           ssl_ = nullptr;
+    int            fd_  = -1;
+    std::string    pending_;
+};
+
+
+bool CloudConnection::connect() {
+    if (!ctx_) {
+        ctx_ = SSL_CTX_new(TLS_client_method());
+        SSL_CTX_set_default_verify_paths(ctx_);
+        SSL_CTX_set_verify(ctx_, options_.insecure ? SSL_VERIFY_NONE : SSL_VERIFY_PEER, nullptr);
+    }
+
+    addrinfo hints = {};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    std::string port = std::to_string(options_.cloudPort);
+    if (getaddrinfo(options_.cloudHost.c_str(), port.c_str(), &hints, &found) != 0) {
+        return false;
+    }
+    for (addrinfo* a = found; a && fd_ < 0; a = a->ai_next) {
+        fd_ = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd_ >= 0 && ::connect(fd_, a->ai_addr, a->ai_addrlen) != 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    timeval timeout = { requestTimeout, 0 };
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    ssl_ = SSL_new(ctx_);
+    SSL_set_fd(ssl_, fd_);
+    SSL_set_tlsext_host_name(ssl_, options_.cloudHost.c_str());
+    if (!options_.insecure) {
+        X509_VERIFY_PARAM_set1_host(SSL_get0_param(ssl_), options_.cloudHost.c_str(), 0);
+    }
+    if (SSL_connect(ssl_) != 1) {
+        ERR_print_errors_fp(stderr);
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+
+void CloudConnection::disconnect() {
+    if (ssl_) {
+        SSL_free(ssl_);
+        ssl_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+    pending_.clear();
+}
+
+
+bool CloudConnection::writeAll(const void* data, size_t len) {
+    const char* p = (const char*)data;
+    while (len > 0) {
+        int n = SSL_write(ssl_, p, (int)std::min<size_t>(len, 1 << 20));
+        if (n <= 0) {
+            return false;
+        }
+        p   += n;
+        len -= n;
+    }
+    return true;
+}
+
+
+bool CloudConnection::readLine(std::string& line) {
+    char chunk[4096];
+    size_t end;
+    while ((end = pending_.find("\r\n")) == std::string::npos) {
+        int n = SSL_read(ssl_, chunk, sizeof(chunk));
+        if (n <= 0) {
+            return false;
+        }
+        pending_.append(chunk, n);
+    }
+    line = pending_.substr(0, end);
+    pending_.erase(0, end + 2);
+    return true;
+}
+
+
+/// === HTTP status of the response, its body is read & dropped so the connection can be reused ===
+int CloudConnection::readResponse() {
+    std::string line;
+    if (!readLine(line)) {
+        return 0;
+    }
+    size_t space  = line.find(' ');
+    int    status = space == std::string::npos ? 0 : atoi(line.c_str() + space + 1);
+
+    long length    = -1;
+    bool keepAlive = true;
+    bool chunked   = false;
+    while (readLine(line) && !line.empty()) {
+        std::string header = line;
+        std::transform(header.begin(), header.end(), header.begin(), ::tolower);
+        if (header.rfind("content-length:", 0) == 0) {
+            length = atol(header.c_str() + 15);
+        }
+        else if (header.rfind("connection:", 0) == 0 && header.find("close") != std::string::npos) {
+            keepAlive = false;
+        }
+        else if (header.rfind("transfer-encoding:", 0) == 0 && header.find("chunked") != std::string::npos) {
+            chunked = true;
+        }
+    }
+
+    /// --- drain the body, a chunked one chunk by chunk ---
+    char chunk[4096];
+    auto drain = [&](long bytes) {
+        long buffered = std::min<long>(bytes, pending_.size());
+        pending_.erase(0, buffered);
+        bytes -= buffered;
+        while (bytes > 0) {
+            int n = SSL_read(ssl_, chunk, (int)std::min<long>(bytes, sizeof(chunk)));
+            if (n <= 0) {
+                return false;
+            }
+            bytes -= n;
+        }
+        return true;
+    };
+
+    bool drained = true;
+    if (chunked) {
+        long size;
+        do {
+            drained = readLine(line);
+            size = drained ? strtol(line.c_str(), nullptr, 16) : 0;
+            drained = drained && drain(size) && readLine(line);
+        } while (drained && size > 0);
+    }
+    else if (length >= 0) {
+        drained = drain(length);
+    }
+    else {
+        keepAlive = false;
+    }
+
+    if (!drained || !keepAlive) {
+        disconnect();
+    }
+    return status;
+}
+
+
+/// === POST one file, returns the HTTP status or 0 if the connection failed ===
+int CloudConnection::upload(const fs::path& path, const std::string& name) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file.eof() && file.fail()) {
+        return 0;
+    }
+
+    std::string boundary = "----GatewayCloudinaryBoundary";
+    std::string head =
+        "--" + boundary + "\r\n"
+        "Content-Disposition: form-data; name=\"upload_preset\"\r\n\r\n" +
+        options_.preset + "\r\n" +
+
+        "--" + boundary + "\r\n"
+        "Content-Disposition: form-data; name=\"public_id\"\r\n\r\n" +
+        name + "\r\n" +
+
+        "--" + boundary + "\r\n"
+        "Content-Disposition: form-data; name=\"file\"; filename=\"" + name + "\"\r\n"
+        "Content-Type: image/jpeg\r\n\r\n";
+    std::string tail = "\r\n--" + boundary + "--\r\n";
+
+    std::string request =
+        "POST /v1_1/" + options_.cloudName + "/image/upload HTTP/1.1\r\n"
+        "Host: " + options_.cloudHost + "\r\n"
+        "Content-Type: multipart/form-data; boundary=" + boundary + "\r\n"
+        "Content-Length: " + std::to_string(head.size() + data.size() + tail.size()) + "\r\n"
+        "Connection: keep-alive\r\n\r\n" + head;
+
+    /// --- a kept-alive connection may have been closed by the server meanwhile, retry once on a fresh one ---
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = ssl_ != nullptr;
+        if (!reused && !connect()) {
+            return 0;
+        }
+        int status = 0;
+        if (writeAll(request.data(), request.size()) && writeAll(data.data(), data.size()) &&
+            writeAll(tail.data(), tail.size())) {
+            status = readResponse();
+        }
+        if (status != 0) {
+            return status;
+        }
+        disconnect();
+        if (!reused) {
+            break;
+        }
+    }
+    return 0;
+}
+
+
+/// === spooled files, oldest first, temporary & rejected files skipped ===
+static std::vector<fs::path> spooledFiles(const std::string& root) {
+    std::vector<std::pair<fs::file_time_type, fs::path>> files;
+    std::error_code ec;
+    for (const auto& unit : fs::directory_iterator(root, ec)) {
+        if (!unit.is_directory() || unit.path().filename() == "rejected") {
+            continue;
+        }
+        for (const auto& entry : fs::directory_iterator(unit.path(), ec)) {
+            if (entry.is_regular_file() && entry.path().filename().string()[0] != '.') {
+                files.emplace_back(entry.last_write_time(ec), entry.path());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<fs::path> paths;
+    for (auto& file : files) {
+        paths.push_back(file.second);
+    }
+    return paths;
+}
+
+
+/// === sleep up to seconds or until the gateway stops, with onStore also until a file is stored ===
+static void pause(Spool& spool, double seconds, bool onStore) {
+    std::unique_lock<std::mutex> guard(spool.lock);
+    uint64_t seen = spool.generation;
+    spool.stored.wait_for(guard, std::chrono::duration<double>(seconds),
+                          [&]() { return !running || (onStore && spool.generation != seen); });
+}
+
+
+void forwardSpool(const Options& options, Spool& spool) {
+    CloudConnection cloud(options);
+    fs::create_directories(fs::path(options.spool) / "rejected");
+
+    double   backoff   = 0;
+    uint64_t forwarded = 0;
+    uint64_t bytes     = 0;
+
+    while (running) {
+        std::vector<fs::path> files = spooledFiles(options.spool);
+        if (files.empty()) {
+            pause(spool, 5, true);
+            continue;
+        }
+
+        for (const fs::path& path : files) {
+            if (!running) {
+                break;
+            }
+
+            std::error_code ec;
+            uintmax_t size  = fs::file_size(path, ec);
+            auto      start = std::chrono::steady_clock::now();
+            std::string name = path.filename().string();
+            int status = cloud.upload(path, name);
+
+            if (status == 200) {
+                fs::remove(path, ec);
+                forwarded++;
+                bytes += size;
+                backoff = 0;
+            }
+            else if (status >= 400 && status < 500 && status != 408 && status != 429) {
+                /// --- retrying won't help, keep the file for a look by hand ---
+                fprintf(stderr, "%s refused with HTTP %d, moved to rejected/\n", path.c_str(), status);
+                fs::rename(path, fs::path(options.spool) / "rejected" /
+                           (path.parent_path().filename().string() + "_" + name), ec);
+            }
+            else {
+                backoff = std::min<double>(std::max(1.0, backoff * 2), options.backoffMax);
+                fprintf(stderr, "upload of %s failed (HTTP %d), retrying in %.0f s\n", path.c_str(), status, backoff);
+                pause(spool, backoff, false);
+                break;
+            }
+
+            /// --- pace the uplink, the file took at least its share of rateKbps ---
+            if (options.rateKbps > 0) {
+                double due  = size * 8.0 / (options.rateKbps * 1000.0);
+                double took = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (due > took) {
+                    std::this_thread::sleep_for(std::chrono::duration<double>(due - took));
+                }
+            }
+        }
+    }
+
+    printf("forwarded %llu files, %llu bytes, %zu left in the spool\n",
+           (unsigned long long)forwarded, (unsigned long long)bytes, spooledFiles(options.spool).size());
+    fflush(stdout);
+}
@@ -0,0 +1,49 @@
+#pragma once
+// === shared state of the receiver & the forwarder ===
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+struct Options {
+    /// --- device side ---
+    uint16_t    port     = 7070;
+    uint16_t    window   = 8;
+    uint32_t    maxFile  = 8 << 20;
+    std::string spool    = "spool";
+    std::string token;
+
+    /// --- cloud side ---
+    bool        forward    = true;
+    std::string cloudName;
+    std::string preset;
+    std::string cloudHost  = "api.cloudinary.com";
+    uint16_t    cloudPort  = 443;
+    bool        insecure   = false;
+    uint32_t    rateKbps   = 0;
+    uint32_t    backoffMax = 300;
+};
+
+
+/// === files land in <spool>/<unit>/<name>, the receiver wakes the forwarder for each ===
+struct Spool {
+    std::mutex              lock;
+    std::condition_variable stored;
+    uint64_t                generation = 0;
+
+    void notify() {
+        std::lock_guard<std::mutex> guard(lock);
+        generation++;
+        stored.notify_all();
+    }
+};
+
+/// --- cleared by SIGINT & SIGTERM ---
+extern std::atomic<bool> running;
+
+/// --- accept doorbell connections until stopped, false if the port can't be opened ---
+bool serveDevices(const Options& options, Spool& spool);
+
+/// --- upload spooled files to Cloudinary at its own pace until stopped ---
+void forwardSpool(const Options& options, Spool& spool);
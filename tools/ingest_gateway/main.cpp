@@ -0,0 +1,103 @@
+// === LAN ingest gateway for GuardianBell doorbells ===
+//
+// Doorbells stream their SD backlog here over one TCP connection (protocol.h)
+// instead of opening a TLS session to Cloudinary per file. Each file is
+// synced into the spool before it is acknowledged, & a forwarder thread
+// uploads the spool to Cloudinary at its own pace.
+//
+//   ingest_gateway --token TOKEN --cloud-name NAME --preset PRESET [--port 7070] [--spool DIR]
+//                  [--window N] [--max-file BYTES] [--rate KBITS] [--backoff-max S]
+//                  [--cloud-host HOST] [--cloud-port PORT] [--insecure] [--no-forward]
+//
+// Token, cloud name & preset default to $INGEST_TOKEN, $CLOUDINARY_CLOUD_NAME &
+// $CLOUDINARY_UPLOAD_PRESET. Only doorbells sending the token (INGEST_TOKEN in
+// their secrets.cpp) are served.
+#include <signal.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include "gateway.h"
+#include "protocol.h"
+
+std::atomic<bool> running{true};
+
+static Spool spool;
+
+
+/// --- the accept loop notices within half a second & wakes the forwarder ---
+static void stop(int) {
+    running = false;
+}
+
+
+static int usage(const char* program) {
+    fprintf(stderr,
+        "usage: %s --token TOKEN --cloud-name NAME --preset PRESET [--port 7070] [--spool DIR]\n"
+        "          [--window N] [--max-file BYTES] [--rate KBITS] [--backoff-max S]\n"
+        "          [--cloud-host HOST] [--cloud-port PORT] [--insecure] [--no-forward]\n", program);
+    return 2;
+}
+
+
+int main(int argc, char** argv) {
+    Options options;
+    if (const char* token = getenv("INGEST_TOKEN"))             options.token = token;
+    if (const char* name = getenv("CLOUDINARY_CLOUD_NAME"))    options.cloudName = name;
+    if (const char* preset = getenv("CLOUDINARY_UPLOAD_PRESET")) options.preset = preset;
+
+    for (int i = 1; i < argc; i++) {
+        std::string flag  = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if      (flag == "--insecure")                  options.insecure = true;
+        else if (flag == "--no-forward")                options.forward  = false;
+        else if (!value)                                return usage(argv[0]);
+        else if (flag == "--token")       options.token      = argv[++i];
+        else if (flag == "--port")        options.port       = atoi(argv[++i]);
+        else if (flag == "--spool")       options.spool      = argv[++i];
+        else if (flag == "--window")      options.window     = atoi(argv[++i]);
+        else if (flag == "--max-file")    options.maxFile    = strtoul(argv[++i], nullptr, 10);
+        else if (flag == "--rate")        options.rateKbps   = strtoul(argv[++i], nullptr, 10);
+        else if (flag == "--backoff-max") options.backoffMax = strtoul(argv[++i], nullptr, 10);
+        else if (flag == "--cloud-name")  options.cloudName  = argv[++i];
+        else if (flag == "--preset")      options.preset     = argv[++i];
+        else if (flag == "--cloud-host")  options.cloudHost  = argv[++i];
+        else if (flag == "--cloud-port")  options.cloudPort  = atoi(argv[++i]);
+        else                                            return usage(argv[0]);
+    }
+
+    if (options.window == 0 || options.token.empty() || options.token.size() > INGEST_TOKEN_LEN ||
+        (options.forward && (options.cloudName.empty() || options.preset.empty()))) {
+        return usage(argv[0]);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.spool, ec);
+    if (ec) {
+        fprintf(stderr, "can't create spool %s: %s\n", options.spool.c_str(), ec.message().c_str());
+        return 1;
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    signal(SIGPIPE, SIG_IGN);
+
+    std::thread forwarder;
+    if (options.forward) {
+        forwarder = std::thread(forwardSpool, std::cref(options), std::ref(spool));
+    }
+
+    bool served = serveDevices(options, spool);
+    running = false;
+    spool.notify();
+
+    if (forwarder.joinable()) {
+        forwarder.join();
+    }
+    return served ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#pragma once
+// === binary upload protocol, mirrors firmware/include/ingest_client.h ===
+//
+// every frame is  u32 length | u8 type | body[length - 1], little endian
+//   HELLO    device -> gateway  "GBIG" | u8 version | char unit[6] | u8 token length | token
+//   WELCOME  gateway -> device  u8 version | u16 window | u32 largest file
+//   FILE     device -> gateway  u32 seq | u16 name length | name | data | u32 crc32 of data
+//   ACK      gateway -> device  u32 seq | u8 status, in FILE order once the file is on disk
+//
+// a HELLO without the shared token is closed without a WELCOME
+#include <cstddef>
+#include <cstdint>
+
+const uint8_t INGEST_VERSION = 2;
+
+enum IngestFrame : uint8_t {
+    INGEST_HELLO   = 0x01,
+    INGEST_FILE    = 0x02,
+    INGEST_WELCOME = 0x81,
+    INGEST_ACK     = 0x82,
+};
+
+enum IngestStatus : uint8_t {
+    INGEST_STORED       = 0,
+    INGEST_BAD_CRC      = 1,
+    INGEST_REJECTED     = 2,
+    INGEST_SPOOL_FAILED = 3,
+};
+
+const size_t INGEST_UNIT_LEN = 6;
+const size_t INGEST_NAME_LEN = 64;
+const size_t INGEST_TOKEN_LEN = 32;
+
+/// --- HELLO fields before the token: type, magic, version, unit & token length ---
+const uint32_t INGEST_HELLO_LEN = 1 + 4 + 1 + INGEST_UNIT_LEN + 1;
+
+/// --- FILE fields around the data: type, seq, name length & the CRC trailer ---
+const uint32_t INGEST_FILE_OVERHEAD = 1 + 4 + 2 + 4;
+
+
+/// === little endian fields ===
+inline void putU16(uint8_t* p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+inline void putU32(uint8_t* p, uint32_t v) {
+    putU16(p, v);
+    putU16(p + 2, v >> 16);
+}
+
+inline uint16_t getU16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+inline uint32_t getU32(const uint8_t* p) {
+    return getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+
+/// === CRC-32 (IEEE, reflected) like esp_rom_crc32_le, crc = 0 starts a new checksum ===
+inline uint32_t crc32Update(uint32_t crc, const uint8_t* buf, size_t len) {
+    static uint32_t table[256];
+    static bool     ready = [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; bit++) {
+                c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1)));
+            }
+            table[i] = c;
+        }
+        return true;
+    }();
+    (void)ready;
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
@@ -0,0 +1,365 @@
+// === doorbell side: one thread per connection, files fsynced into the spool before the ack ===
+//
+// Acks are collected while more of the stream is already buffered & written
+// in one send right before the next read would block, so a device pipelining
+// a window of files gets them back in a few segments instead of one per file.
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gateway.h"
+#include "protocol.h"
+
+
+/// === seconds a device may stay silent mid-stream ===
+static const int idleTimeout = 60;
+
+
+class DeviceConnection {
+public:
+    DeviceConnection(int fd, const Options& options, Spool& spool)
+        : fd_(fd), options_(options), spool_(spool), buf_(65536) {}
+
+    ~DeviceConnection() {
+        close(fd_);
+    }
+
+    void serve();
+
+private:
+    bool fill();
+    bool readExact(uint8_t* dst, size_t len);
+    bool skip(uint64_t len);
+    bool flushAcks();
+    bool hello();
+    bool receiveFile(uint32_t length);
+    uint8_t store(uint32_t length, const std::string& name);
+    void ack(uint32_t seq, uint8_t status);
+
+    int            fd_;
+    const Options& options_;
+    Spool&         spool_;
+
+    std::vector<uint8_t> buf_;
+    size_t               pos_ = 0;
+    size_t               len_ = 0;
+    std::vector<uint8_t> acks_;
+
+    std::string unit_;
+    std::string dir_;
+    uint32_t    files_ = 0;
+    uint64_t    bytes_ = 0;
+};
+
+
+/// === refill the read buffer, acks waiting are sent first since the device may wait on them ===
+bool DeviceConnection::fill() {
+    if (!flushAcks()) {
+        return false;
+    }
+
+    ssize_t n = recv(fd_, buf_.data(), buf_.size(), 0);
+    if (n <= 0) {
+        return false;
+    }
+    pos_ = 0;
+    len_ = n;
+    return true;
+}
+
+
+bool DeviceConnection::readExact(uint8_t* dst, size_t len) {
+    while (len > 0) {
+        if (pos_ == len_ && !fill()) {
+            return false;
+        }
+        size_t n = std::min(len, len_ - pos_);
+        memcpy(dst, buf_.data() + pos_, n);
+        pos_ += n;
+        dst  += n;
+        len  -= n;
+    }
+    return true;
+}
+
+
+bool DeviceConnection::skip(uint64_t len) {
+    while (len > 0) {
+        if (pos_ == len_ && !fill()) {
+            return false;
+        }
+        size_t n = std::min<uint64_t>(len, len_ - pos_);
+        pos_ += n;
+        len  -= n;
+    }
+    return true;
+}
+
+
+bool DeviceConnection::flushAcks() {
+    size_t sent = 0;
+    while (sent < acks_.size()) {
+        ssize_t n = send(fd_, acks_.data() + sent, acks_.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    acks_.clear();
+    return true;
+}
+
+
+void DeviceConnection::ack(uint32_t seq, uint8_t status) {
+    uint8_t frame[10];
+    putU32(frame, sizeof(frame) - 4);
+    frame[4] = INGEST_ACK;
+    putU32(frame + 5, seq);
+    frame[9] = status;
+    acks_.insert(acks_.end(), frame, frame + sizeof(frame));
+}
+
+
+/// === unit ids & file names become paths, so only plain characters pass ===
+static bool plainName(const std::string& name) {
+    if (name.empty() || name[0] == '.') {
+        return false;
+    }
+    for (char c : name) {
+        if (!isalnum((unsigned char)c) && c != '_' && c != '-' && c != '.') {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/// === compare without an early exit, so the time taken doesn't tell how much of a token matched ===
+static bool tokenMatches(const uint8_t* token, size_t len, const std::string& expected) {
+    if (expected.empty()) {
+        return false;
+    }
+    uint8_t diff = len != expected.size();
+    for (size_t i = 0; i < len; i++) {
+        diff |= token[i] ^ (uint8_t)expected[i % expected.size()];
+    }
+    return diff == 0;
+}
+
+
+/// === check the HELLO & its token, create the unit's spool directory & welcome the device ===
+bool DeviceConnection::hello() {
+    uint8_t frame[4 + INGEST_HELLO_LEN + INGEST_TOKEN_LEN];
+    if (!readExact(frame, 4)) {
+        return false;
+    }
+    uint32_t length = getU32(frame);
+    if (length < INGEST_HELLO_LEN || length > INGEST_HELLO_LEN + INGEST_TOKEN_LEN ||
+        !readExact(frame + 4, length) ||
+        frame[4] != INGEST_HELLO || memcmp(frame + 5, "GBIG", 4) != 0 || frame[9] != INGEST_VERSION ||
+        frame[16] != length - INGEST_HELLO_LEN) {
+        return false;
+    }
+
+    unit_ = std::string((const char*)frame + 10, INGEST_UNIT_LEN);
+    if (!plainName(unit_)) {
+        return false;
+    }
+    if (!tokenMatches(frame + 17, frame[16], options_.token)) {
+        fprintf(stderr, "%s: wrong token, connection closed\n", unit_.c_str());
+        unit_.clear();
+        return false;
+    }
+    dir_ = options_.spool + "/" + unit_;
+    mkdir(dir_.c_str(), 0755);
+
+    uint8_t welcome[12];
+    putU32(welcome, sizeof(welcome) - 4);
+    welcome[4] = INGEST_WELCOME;
+    welcome[5] = INGEST_VERSION;
+    putU16(welcome + 6, options_.window);
+    putU32(welcome + 8, options_.maxFile);
+    acks_.insert(acks_.end(), welcome, welcome + sizeof(welcome));
+    return flushAcks();
+}
+
+
+/// === stream the data into a temporary file, rename it into place once checked & synced ===
+uint8_t DeviceConnection::store(uint32_t length, const std::string& name) {
+    std::string part  = dir_ + "/." + name + ".part";
+    std::string final = dir_ + "/" + name;
+
+    int  out     = open(part.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool written = out >= 0;
+
+    uint32_t crc = 0;
+    while (length > 0) {
+        if (pos_ == len_ && !fill()) {
+            if (out >= 0) {
+                close(out);
+                unlink(part.c_str());
+            }
+            throw std::runtime_error("connection closed mid-file");
+        }
+        size_t n = std::min<size_t>(length, len_ - pos_);
+        crc = crc32Update(crc, buf_.data() + pos_, n);
+        if (written && write(out, buf_.data() + pos_, n) != (ssize_t)n) {
+            written = false;
+        }
+        pos_   += n;
+        length -= n;
+    }
+
+    uint8_t trailer[4];
+    if (!readExact(trailer, sizeof(trailer))) {
+        if (out >= 0) {
+            close(out);
+            unlink(part.c_str());
+        }
+        throw std::runtime_error("connection closed mid-file");
+    }
+
+    /// --- only a synced file is acknowledged, the device deletes its copy on the ack ---
+    written = written && fsync(out) == 0;
+    if (out >= 0) {
+        written = close(out) == 0 && written;
+    }
+    if (getU32(trailer) != crc) {
+        unlink(part.c_str());
+        return INGEST_BAD_CRC;
+    }
+    if (!written || rename(part.c_str(), final.c_str()) != 0) {
+        unlink(part.c_str());
+        return INGEST_SPOOL_FAILED;
+    }
+
+    int dir = open(dir_.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir >= 0) {
+        fsync(dir);
+        close(dir);
+    }
+    return INGEST_STORED;
+}
+
+
+/// === one FILE frame after its length, false if the stream can't continue ===
+bool DeviceConnection::receiveFile(uint32_t length) {
+    uint8_t head[7];
+    if (length < INGEST_FILE_OVERHEAD || !readExact(head, sizeof(head)) || head[0] != INGEST_FILE) {
+        return false;
+    }
+    uint32_t seq     = getU32(head + 1);
+    uint16_t nameLen = getU16(head + 5);
+    if (nameLen > INGEST_NAME_LEN || length < INGEST_FILE_OVERHEAD + nameLen) {
+        return false;
+    }
+
+    char name[INGEST_NAME_LEN];
+    if (!readExact((uint8_t*)name, nameLen)) {
+        return false;
+    }
+    std::string file(name, nameLen);
+    uint32_t    dataLen = length - INGEST_FILE_OVERHEAD - nameLen;
+
+    /// --- the frame length is trusted, so a rejected file is skipped & the stream goes on ---
+    if (!plainName(file) || dataLen > options_.maxFile) {
+        fprintf(stderr, "%s: rejected %s (%u bytes)\n", unit_.c_str(), file.c_str(), dataLen);
+        ack(seq, INGEST_REJECTED);
+        return skip((uint64_t)dataLen + 4);
+    }
+
+    uint8_t status = store(dataLen, file);
+    ack(seq, status);
+
+    if (status == INGEST_STORED) {
+        files_++;
+        bytes_ += dataLen;
+        spool_.notify();
+    }
+    else {
+        fprintf(stderr, "%s: %s not stored, status %d\n", unit_.c_str(), file.c_str(), status);
+    }
+    return true;
+}
+
+
+void DeviceConnection::serve() {
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+        /// --- a port probe closes without a byte, only garbage is worth a line ---
+        if (!hello()) {
+            if (len_ > 0) {
+                fprintf(stderr, "rejected a connection without a valid HELLO\n");
+            }
+            return;
+        }
+
+        uint8_t length[4];
+        while (running && readExact(length, sizeof(length)) && receiveFile(getU32(length))) {
+        }
+        flushAcks();
+    }
+    catch (const std::exception& e) {
+        fprintf(stderr, "%s: %s\n", unit_.c_str(), e.what());
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%s: %u files, %llu bytes in %.1f s\n", unit_.c_str(), files_, (unsigned long long)bytes_, seconds);
+    fflush(stdout);
+}
+
+
+/// === listen on every interface, the doorbells reach the gateway over WiFi ===
+bool serveDevices(const Options& options, Spool& spool) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    sockaddr_in addr = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(options.port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (listener < 0 || bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 8) != 0) {
+        perror("ingest port");
+        return false;
+    }
+    printf("listening on port %u, spool %s\n", options.port, options.spool.c_str());
+    fflush(stdout);
+
+    while (running) {
+        pollfd ready = { listener, POLLIN, 0 };
+        if (poll(&ready, 1, 500) <= 0) {
+            continue;
+        }
+
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+        timeval timeout = { idleTimeout, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        std::thread([fd, &options, &spool]() {
+            DeviceConnection(fd, options, spool).serve();
+        }).detach();
+    }
+
+    close(listener);
+    return true;
+}
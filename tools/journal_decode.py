@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Decode the GuardianBell event journal into a readable, gap-checked log.
+
+The firmware appends fixed-size records to ``/journal.bin`` on the SD card,
+rotating it to ``/journal.old``, and exports new records over MQTT on
+``doorbell/journal`` before deep sleep. Each record (little-endian, 20 bytes)
+is::
+
+    u32 seq | u32 unix time | u8 event | u8 code | u16 arg | u32 value | u32 crc32
+
+where the CRC-32 (zlib polynomial) covers the first 16 bytes. MQTT messages
+carry records behind a header::
+
+    "GBJR" | u8 version | u8 record size | u16 count | records...
+
+Decode SD card files or saved payloads with ``journal_decode.py journal.old
+journal.bin``, or collect live with ``journal_decode.py --host <broker>``
+(requires paho-mqtt). ``--request FROM[,COUNT]`` asks the doorbell to publish
+a range again, e.g. to fill a gap. Error records hold a hash of the message;
+``--sources firmware/src`` maps them back to the error() call.
+"""
+
+import argparse
+import datetime
+import os
+import re
+import struct
+import sys
+import zlib
+
+# must mirror JournalEvent in firmware/include/journal.h
+EVENTS = ["boot", "ring", "motion", "alert", "upload", "ota", "error", "sleep"]
+
+WAKE_CAUSES = {0: "power on", 2: "PIR", 4: "timer"}
+OTA_RESULTS = ["up to date", "updated", "failed"]
+
+HEADER = struct.Struct("<4sBBH")
+RECORD = struct.Struct("<IIBBHII")
+
+
+def records_of(data):
+    """Yield (seq, time, event, code, arg, value) for every intact record."""
+    if data[:4] == b"GBJR":
+        magic, version, size, count = HEADER.unpack_from(data)
+        if version != 1 or size != RECORD.size:
+            raise ValueError("not a version 1 journal export")
+        body = data[HEADER.size:HEADER.size + count * size]
+    else:
+        body = data
+
+    for offset in range(0, len(body) - RECORD.size + 1, RECORD.size):
+        fields = RECORD.unpack_from(body, offset)
+        if zlib.crc32(body[offset:offset + RECORD.size - 4]) == fields[-1]:
+            yield fields[:-1]
+
+
+def error_hashes(root):
+    """FNV-1a hash of every string literal passed to error() under root."""
+    hashes = {}
+    pattern = re.compile(r'error\(\s*"((?:[^"\\]|\\.)*)"')
+    for directory, _, files in os.walk(root):
+        for name in files:
+            if not name.endswith((".cpp", ".h")):
+                continue
+            with open(os.path.join(directory, name), encoding="utf-8", errors="replace") as source:
+                for message in pattern.findall(source.read()):
+                    h = 2166136261
+                    for byte in message.encode():
+                        h = ((h ^ byte) * 16777619) & 0xFFFFFFFF
+                    hashes[h] = message
+    return hashes
+
+
+def describe(event, code, arg, value, messages):
+    if event == 0:
+        return "%s wake, boot %d ms" % (WAKE_CAUSES.get(code, "cause %d" % code), value)
+    if event == 1:
+        return "%d frame burst" % code
+    if event == 2:
+        person = {0: "nobody", 1: "person", 2: "ungated"}.get(code, str(code))
+        score = "-" if arg == 0xFFFF else str(arg)
+        return "%s, best score %s, %d ms" % (person, score, value)
+    if event == 3:
+        return "x%d, activity level %.2f%s" % (code, value / 100, ", sent by another unit" if arg else "")
+    if event == 4:
+        return "%d files, %d bytes, %s" % (arg, value, "images left" if code else "drained")
+    if event == 5:
+        return OTA_RESULTS[code] if code < len(OTA_RESULTS) else "result %d" % code
+    if event == 6:
+        message = messages.get(value, "message %08x" % value)
+        return ("FATAL " if code else "") + message
+    if event == 7:
+        return "awake %d ms%s" % (value, ", timer wake set" if code else "")
+    return "code %d arg %d value %d" % (code, arg, value)
+
+
+def collect_live(args):
+    import paho.mqtt.client as mqtt
+
+    payloads = []
+    client = mqtt.Client()
+    if args.user:
+        client.username_pw_set(args.user, args.password)
+
+    def on_connect(c, userdata, flags, rc):
+        c.subscribe("doorbell/journal")
+        if args.request:
+            c.publish("doorbell/journal/get", args.request)
+
+    def on_message(c, userdata, msg):
+        payloads.append(msg.payload)
+        print("received %d bytes" % len(msg.payload), file=sys.stderr)
+        if len(payloads) >= args.count:
+            c.disconnect()
+
+    client.on_connect = on_connect
+    client.on_message = on_message
+    client.connect(args.host, args.port)
+    client.loop_forever()
+    return payloads
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("files", nargs="*", help="journal files or raw doorbell/journal payloads")
+    parser.add_argument("--host")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--user")
+    parser.add_argument("--password")
+    parser.add_argument("--count", type=int, default=1, help="exports to collect live")
+    parser.add_argument("--request", metavar="FROM[,COUNT]", help="ask the doorbell to publish a range again")
+    parser.add_argument("--sources", help="firmware source tree to resolve error hashes")
+    args = parser.parse_args()
+
+    payloads = [open(f, "rb").read() for f in args.files]
+    if args.host:
+        payloads += collect_live(args)
+    if not payloads:
+        parser.error("no journal files or payloads given")
+
+    messages = error_hashes(args.sources) if args.sources else {}
+
+    # --- exports overlap when ranges are requested again, keep one copy of each ---
+    records = {}
+    for payload in payloads:
+        for record in records_of(payload):
+            records[record[0]] = record
+
+    previous = None
+    for seq in sorted(records):
+        if previous is not None and seq != previous + 1:
+            print("  -- %d records missing (%d-%d) --" % (seq - previous - 1, previous + 1, seq - 1))
+        previous = seq
+
+        _, time, event, code, arg, value = records[seq]
+        stamp = datetime.datetime.fromtimestamp(time, datetime.timezone.utc).strftime("%Y-%m-%d %H:%M:%S")
+        name = EVENTS[event] if event < len(EVENTS) else "event_%d" % event
+        print("%8d  %s  %-6s  %s" % (seq, stamp, name, describe(event, code, arg, value, messages)))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,393 @@
+#!/usr/bin/env python3
+"""Local stand-ins for every network endpoint GuardianBell talks to.
+
+Serves, on 127.0.0.1:
+
+* HTTPS (self-signed, the firmware skips validation) emulating
+  ``/bot<token>/sendPhoto``, ``/bot<token>/sendMediaGroup``,
+  ``/bot<token>/sendMessage`` (Telegram),
+  ``/v1_1/<cloud>/image/upload`` (Cloudinary) and ``/version.txt``,
+  ``/update_notes.txt``, ``/firmware.bin`` (OTA)
+* a minimal MQTT 3.1.1 broker (QoS 0, no routing) counting publishes per topic
+* with ``--gateway``, the LAN ingest gateway (``ingest_gateway/``) on device
+  port 7070, forwarding its spool to the Cloudinary stand-in unshaped
+
+HTTP latency is measured per connection at the proxy, so it includes the TLS
+handshake and shaping; MQTT rows count publishes & bytes per topic prefix, the
+ingest row one per gateway connection.
+
+Every listener sits behind a shaping proxy adding one-way latency, a bandwidth
+limit and segment loss (each lost segment stalls the stream for one RTO, like
+a TCP retransmit), so runs under the same ``--seed`` are repeatable. Parallel
+connections through a proxy share its bandwidth, like the device's one WiFi
+link.
+
+Run the native benchmarks through it with::
+
+    pio run -e native_net
+    net_harness.py --profile weak --json net.json -- \\
+        .pio/build/native_net/program --iterations 20 --label $(git rev-parse --short HEAD)
+
+The harness appends ``--net-target`` & ``--net-ports`` to the program, waits
+for it and prints per-endpoint request counts, bytes, latency percentiles and
+throughput. Without a program it serves until interrupted.
+"""
+
+import argparse
+import asyncio
+import json
+import os
+import random
+import socket
+import ssl
+import subprocess
+import sys
+import tempfile
+import time
+from collections import defaultdict
+
+SEGMENT = 1460
+
+PROFILES = {
+    "lan":  dict(latency=1,  bandwidth=0,     loss=0.0),
+    "wifi": dict(latency=10, bandwidth=20000, loss=0.0),
+    "weak": dict(latency=60, bandwidth=1000,  loss=0.01),
+}
+
+
+# === statistics ===
+class Stats:
+    def __init__(self):
+        self.requests = defaultdict(list)
+        # backend-side port of a proxied connection -> endpoint it requested
+        self.endpoints = {}
+
+    def add(self, endpoint, received, sent, seconds):
+        self.requests[endpoint].append((received, sent, seconds))
+
+    def rows(self):
+        for endpoint in sorted(self.requests):
+            entries = self.requests[endpoint]
+            latencies = sorted(s for _, _, s in entries)
+            received = sum(r for r, _, _ in entries)
+            sent = sum(s for _, s, _ in entries)
+            total = sum(latencies) or 1e-9
+            yield {
+                "endpoint": endpoint,
+                "count": len(entries),
+                "bytes_in": received,
+                "bytes_out": sent,
+                "p50_ms": percentile(latencies, 50) * 1000,
+                "p99_ms": percentile(latencies, 99) * 1000,
+                "kbit_per_s": (received + sent) * 8 / total / 1000,
+            }
+
+    def report(self, label, json_path):
+        print("\n%-24s %6s %10s %10s %9s %9s %11s" %
+              ("endpoint", "count", "bytes in", "bytes out", "p50 ms", "p99 ms", "kbit/s"))
+        for row in self.rows():
+            print("%-24s %6d %10d %10d %9.1f %9.1f %11.1f" % (
+                row["endpoint"], row["count"], row["bytes_in"], row["bytes_out"],
+                row["p50_ms"], row["p99_ms"], row["kbit_per_s"]))
+        if json_path:
+            with open(json_path, "a") as out:
+                for row in self.rows():
+                    out.write(json.dumps(dict(row, label=label)) + "\n")
+
+
+def percentile(values, p):
+    return values[min(len(values) - 1, int(len(values) * p / 100))] if values else 0
+
+
+# === link shaping ===
+class Link:
+    """One direction of a shaped connection."""
+
+    def __init__(self, args, rng):
+        self.latency = args.latency / 1000
+        self.bytes_per_s = args.bandwidth * 1000 / 8
+        self.loss = args.loss
+        self.rto = args.rto / 1000
+        self.rng = rng
+        self.busy_until = 0.0
+
+    def delivery_time(self, size, now):
+        """Serialize behind earlier segments, then add loss stalls & latency."""
+        start = max(now, self.busy_until)
+        finish = start + (size / self.bytes_per_s if self.bytes_per_s else 0)
+        for _ in range(0, size, SEGMENT):
+            if self.rng.random() < self.loss:
+                finish += self.rto
+        self.busy_until = finish
+        return finish + self.latency
+
+
+async def pump(reader, writer, link):
+    """Forward one direction, the bounded queue pushes back on the sender."""
+    queue = asyncio.Queue(maxsize=32)
+    loop = asyncio.get_running_loop()
+
+    async def deliver():
+        while True:
+            due, data = await queue.get()
+            if data is None:
+                break
+            await asyncio.sleep(max(0, due - loop.time()))
+            writer.write(data)
+            await writer.drain()
+
+    sender = asyncio.ensure_future(deliver())
+    total = 0
+    try:
+        while True:
+            data = await reader.read(SEGMENT)
+            if not data:
+                break
+            total += len(data)
+            await queue.put((link.delivery_time(len(data), loop.time()), data))
+    except ConnectionError:
+        pass
+    await queue.put((0, None))
+    try:
+        await sender
+        writer.close()
+    except ConnectionError:
+        pass
+    return total
+
+
+async def shaping_proxy(listen_port, backend_port, args, rng, stats, endpoint=None):
+    """Shape a listener; HTTP requests are timed here, as the device sees them.
+
+    Connections no stand-in names are counted under endpoint, if given."""
+    uplink, downlink = Link(args, rng), Link(args, rng)
+
+    async def handle(client_reader, client_writer):
+        start = time.monotonic()
+        try:
+            backend_reader, backend_writer = await asyncio.open_connection("127.0.0.1", backend_port)
+        except OSError:
+            client_writer.close()
+            return
+        port = backend_writer.get_extra_info("sockname")[1]
+        upstream = asyncio.ensure_future(pump(client_reader, backend_writer, uplink))
+        try:
+            # a request is done once its response is delivered, even if the device lingers
+            sent = await pump(backend_reader, client_writer, downlink)
+            elapsed = time.monotonic() - start
+            received = await upstream
+        except asyncio.CancelledError:
+            return
+        name = stats.endpoints.pop(port, endpoint)
+        if name:
+            stats.add(name, received, sent, elapsed)
+
+    return await asyncio.start_server(handle, "127.0.0.1", listen_port)
+
+
+# === HTTPS stand-in for Telegram, Cloudinary & OTA ===
+class HttpBackend:
+    def __init__(self, args, stats):
+        self.args = args
+        self.stats = stats
+        self.firmware = random.Random(args.seed).randbytes(args.firmware_size)
+
+    def route(self, method, path, body):
+        if path.startswith("/bot") and path.endswith("/sendMediaGroup"):
+            # every attach://photoN in the media JSON needs its own file part
+            attached = body.count(b"attach://photo")
+            parts = body.count(b'; name="photo')
+            ok = attached >= 2 and attached == parts
+            return "telegram_send_media_group", b'{"ok":%s}' % (b"true" if ok else b"false")
+        if path.startswith("/bot") and path.endswith("/sendPhoto"):
+            return "telegram_send_photo", b'{"ok":true,"result":{"message_id":1}}'
+        if path.startswith("/bot") and "/sendMessage" in path:
+            return "telegram_send_message", b'{"ok":true,"result":{"message_id":1}}'
+        if path.startswith("/v1_1/") and path.endswith("/image/upload"):
+            return "cloudinary_upload", b'{"public_id":"bench","secure_url":"https://localhost/bench.jpg"}'
+        if path == "/version.txt":
+            return "ota_version", self.args.ota_version.encode()
+        if path == "/update_notes.txt":
+            return "ota_notes", b"- local harness build"
+        if path == "/firmware.bin":
+            return "ota_firmware", self.firmware
+        return None, b"not found"
+
+    async def handle(self, reader, writer):
+        try:
+            head = await reader.readuntil(b"\r\n\r\n")
+            lines = head.decode("latin-1").split("\r\n")
+            method, path, _ = lines[0].split(" ", 2)
+            headers = {k.strip().lower(): v.strip()
+                       for k, v in (line.split(":", 1) for line in lines[1:] if ":" in line)}
+            length = int(headers.get("content-length", 0))
+            request = await reader.readexactly(length) if length else b""
+
+            endpoint, body = self.route(method, path, request)
+            status = "200 OK" if endpoint else "404 Not Found"
+            response = ("HTTP/1.1 %s\r\nContent-Type: application/json\r\nContent-Length: %d\r\n"
+                        "Connection: close\r\n\r\n" % (status, len(body))).encode() + body
+            self.stats.endpoints[writer.get_extra_info("peername")[1]] = endpoint or "not_found"
+            writer.write(response)
+            await writer.drain()
+        except (asyncio.IncompleteReadError, ConnectionError, ValueError, asyncio.CancelledError):
+            pass
+        finally:
+            writer.close()
+
+
+# === MQTT stand-in ===
+class MqttBackend:
+    def __init__(self, stats):
+        self.stats = stats
+
+    async def read_packet(self, reader):
+        header = (await reader.readexactly(1))[0]
+        started = time.monotonic()
+        length, shift = 0, 0
+        while True:
+            digit = (await reader.readexactly(1))[0]
+            length |= (digit & 0x7F) << shift
+            shift += 7
+            if not digit & 0x80:
+                break
+        return header, await reader.readexactly(length), started
+
+    async def handle(self, reader, writer):
+        try:
+            while True:
+                header, body, started = await self.read_packet(reader)
+                kind = header >> 4
+                if kind == 1:      # CONNECT
+                    writer.write(b"\x20\x02\x00\x00")
+                elif kind == 3:    # PUBLISH
+                    topic_len = int.from_bytes(body[:2], "big")
+                    topic = body[2:2 + topic_len].decode()
+                    self.stats.add("mqtt " + topic.rsplit("/", 1)[0] + "/#", len(body), 0,
+                                   time.monotonic() - started)
+                elif kind == 8:    # SUBSCRIBE
+                    writer.write(b"\x90\x03" + body[:2] + b"\x00")
+                elif kind == 12:   # PINGREQ
+                    writer.write(b"\xd0\x00")
+                elif kind == 14:   # DISCONNECT
+                    break
+                await writer.drain()
+        except (asyncio.IncompleteReadError, ConnectionError, asyncio.CancelledError):
+            pass
+        finally:
+            writer.close()
+
+
+# === LAN ingest gateway ===
+async def start_gateway(args, workdir, cloud_port):
+    """Run the gateway on a free port, forwarding to the Cloudinary stand-in."""
+    with socket.socket() as probe:
+        probe.bind(("127.0.0.1", 0))
+        port = probe.getsockname()[1]
+
+    process = await asyncio.create_subprocess_exec(
+        args.gateway, "--port", str(port), "--spool", os.path.join(workdir, "spool"),
+        "--token", "native",  # INGEST_TOKEN of native/fakes/secrets_fake.cpp
+        "--cloud-name", "harness", "--preset", "harness",
+        "--cloud-host", "127.0.0.1", "--cloud-port", str(cloud_port), "--insecure")
+
+    for _ in range(50):
+        try:
+            _, writer = await asyncio.open_connection("127.0.0.1", port)
+            writer.close()
+            return process, port
+        except OSError:
+            await asyncio.sleep(0.1)
+    process.terminate()
+    raise RuntimeError("ingest gateway didn't start")
+
+
+# === setup ===
+def make_tls_context(workdir):
+    cert = os.path.join(workdir, "cert.pem")
+    key = os.path.join(workdir, "key.pem")
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "1",
+                    "-subj", "/CN=localhost", "-keyout", key, "-out", cert],
+                   check=True, capture_output=True)
+    context = ssl.create_default_context(ssl.Purpose.CLIENT_AUTH)
+    context.load_cert_chain(cert, key)
+    return context
+
+
+async def run(args):
+    stats = Stats()
+    rng = random.Random(args.seed)
+
+    with tempfile.TemporaryDirectory() as workdir:
+        tls = make_tls_context(workdir)
+        # don't wait long for the close_notify of clients that never stop(), like a real server
+        shutdown = {"ssl_shutdown_timeout": 0.1} if sys.version_info >= (3, 11) else {}
+        http = await asyncio.start_server(HttpBackend(args, stats).handle, "127.0.0.1", 0, ssl=tls, **shutdown)
+        mqtt = await asyncio.start_server(MqttBackend(stats).handle, "127.0.0.1", 0)
+
+        https_proxy = await shaping_proxy(args.https_port, http.sockets[0].getsockname()[1], args, rng, stats)
+        mqtt_proxy = await shaping_proxy(args.mqtt_port, mqtt.sockets[0].getsockname()[1], args, rng, stats)
+
+        ports = "443:%d,1883:%d" % (args.https_port, args.mqtt_port)
+        servers = [https_proxy, mqtt_proxy, http, mqtt]
+
+        gateway = None
+        if args.gateway:
+            gateway, gateway_port = await start_gateway(args, workdir, http.sockets[0].getsockname()[1])
+            servers.append(await shaping_proxy(args.ingest_port, gateway_port, args, rng, stats, "ingest"))
+            ports += ",7070:%d" % args.ingest_port
+        print("latency %d ms, bandwidth %s, loss %.1f%%, seed %d; device ports %s" % (
+            args.latency, "%d kbit/s" % args.bandwidth if args.bandwidth else "unlimited",
+            args.loss * 100, args.seed, ports))
+
+        try:
+            if args.program:
+                command = args.program + ["--net-target", "127.0.0.1", "--net-ports", ports]
+                process = await asyncio.create_subprocess_exec(*command)
+                await process.wait()
+                # let segments still in flight reach the stand-ins
+                await asyncio.sleep(2 * args.latency / 1000 + 0.5)
+            else:
+                await asyncio.Event().wait()
+        finally:
+            if gateway:
+                gateway.terminate()
+                await gateway.wait()
+            for server in servers:
+                server.close()
+            stats.report(args.label, args.json)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--profile", choices=sorted(PROFILES), help="preset latency, bandwidth & loss")
+    parser.add_argument("--latency", type=int, default=0, help="one-way latency in ms")
+    parser.add_argument("--bandwidth", type=int, default=0, help="kbit/s per direction, 0 is unlimited")
+    parser.add_argument("--loss", type=float, default=0.0, help="segment loss probability")
+    parser.add_argument("--rto", type=int, default=200, help="stall per lost segment in ms")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--https-port", type=int, default=8443)
+    parser.add_argument("--mqtt-port", type=int, default=18830)
+    parser.add_argument("--gateway", help="ingest_gateway binary to run behind the proxy")
+    parser.add_argument("--ingest-port", type=int, default=17070)
+    parser.add_argument("--ota-version", default="harness", help="served by /version.txt")
+    parser.add_argument("--firmware-size", type=int, default=1 << 20)
+    parser.add_argument("--label", default="", help="tag for the JSON report, e.g. a commit")
+    parser.add_argument("--json", help="append per-endpoint results to this file")
+    parser.add_argument("program", nargs=argparse.REMAINDER, help="-- program [args...]")
+    args = parser.parse_args()
+
+    if args.profile:
+        for key, value in PROFILES[args.profile].items():
+            setattr(args, key, value)
+    if args.program and args.program[0] == "--":
+        args.program = args.program[1:]
+
+    try:
+        asyncio.run(run(args))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    sys.exit(main())
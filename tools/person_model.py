@@ -0,0 +1,330 @@
+#!/usr/bin/env python3
+"""Train & export the int8 person classifier that gates surveillance bursts.
+
+The dataset is a directory of captures sorted into ``person/`` & ``empty/``
+(cats, cars & sunlight belong in ``empty/``)::
+
+    person_model.py train captures/ -o person_model.bin
+    person_model.py score person_model.bin captures/empty/*.jpg
+
+Copy ``person_model.bin`` to the root of the SD card or the LittleFS hot tier,
+it is loaded on every wake. ``score`` runs the same integer arithmetic as the
+firmware kernel, the native ``person_accuracy`` benchmark scores the dataset
+with the firmware itself::
+
+    program --person-model person_model.bin --labeled captures/ --filter person
+
+The network matches src/util/person_detect.cpp: three 3x3 stride-2
+convolutions (8, 16 & 32 channels) with ReLU on a 32x24 luma thumbnail,
+global average pooling & one logit. Training is float32 numpy; the export
+quantises weights per output channel & calibrates activation ranges on the
+training set.
+"""
+
+import argparse
+import glob
+import os
+import struct
+import sys
+
+import numpy as np
+from PIL import Image
+
+INPUT_W, INPUT_H = 32, 24
+CHANNELS = [8, 16, 32]
+VERSION = 1
+
+
+# === thumbnails, as taken from the JPEG DC coefficients on the device ===
+def thumbnail(path):
+    """32x24 uint8 area average of the 8x8 block means of the luma plane."""
+    img = Image.open(path)
+    img.draft("YCbCr", img.size)
+    luma = np.asarray(img.convert("YCbCr"))[:, :, 0].astype(np.float64)
+
+    rows, cols = -(-luma.shape[0] // 8), -(-luma.shape[1] // 8)
+    luma = np.pad(luma, ((0, rows * 8 - luma.shape[0]), (0, cols * 8 - luma.shape[1])), mode="edge")
+    blocks = np.round(luma.reshape(rows, 8, cols, 8).mean(axis=(1, 3)))
+    if rows < INPUT_H or cols < INPUT_W:
+        raise ValueError("%s is smaller than the classifier input" % path)
+
+    sums = np.zeros((INPUT_H, INPUT_W))
+    counts = np.zeros((INPUT_H, INPUT_W))
+    cell_rows = np.arange(rows) * INPUT_H // rows
+    cell_cols = np.arange(cols) * INPUT_W // cols
+    np.add.at(sums, (cell_rows[:, None], cell_cols[None, :]), blocks)
+    np.add.at(counts, (cell_rows[:, None], cell_cols[None, :]), 1)
+    return ((sums + counts // 2) // counts).astype(np.uint8)
+
+
+def load_dataset(root):
+    images, labels = [], []
+    for label, name in ((1, "person"), (0, "empty")):
+        for path in sorted(glob.glob(os.path.join(root, name, "*"))):
+            if path.lower().endswith((".jpg", ".jpeg")):
+                images.append(thumbnail(path))
+                labels.append(label)
+    if not images:
+        sys.exit("no captures in %s/{person,empty}" % root)
+    return np.stack(images), np.array(labels, dtype=np.float32)
+
+
+# === float model, NHWC with weights as (9 * in, out) matrices in [ky][kx][in] order ===
+def im2col(x, pad_value=0):
+    n, h, w, c = x.shape
+    oh, ow = h // 2, w // 2
+    padded = np.pad(x, ((0, 0), (1, 1), (1, 1), (0, 0)), constant_values=pad_value)
+    cols = np.empty((n, oh, ow, 3, 3, c), dtype=x.dtype)
+    for ky in range(3):
+        for kx in range(3):
+            cols[:, :, :, ky, kx, :] = padded[:, ky:ky + 2 * oh:2, kx:kx + 2 * ow:2, :]
+    return cols.reshape(n * oh * ow, 9 * c)
+
+
+def col2im(dcols, shape):
+    n, h, w, c = shape
+    oh, ow = h // 2, w // 2
+    dcols = dcols.reshape(n, oh, ow, 3, 3, c)
+    dpadded = np.zeros((n, h + 2, w + 2, c), dtype=dcols.dtype)
+    for ky in range(3):
+        for kx in range(3):
+            dpadded[:, ky:ky + 2 * oh:2, kx:kx + 2 * ow:2, :] += dcols[:, :, :, ky, kx, :]
+    return dpadded[:, 1:-1, 1:-1, :]
+
+
+def init_params(rng):
+    params, in_c = [], 1
+    for out_c in CHANNELS:
+        fan_in = 9 * in_c
+        params += [rng.normal(0, np.sqrt(2.0 / fan_in), (fan_in, out_c)).astype(np.float32),
+                   np.zeros(out_c, dtype=np.float32)]
+        in_c = out_c
+    params += [rng.normal(0, np.sqrt(1.0 / in_c), (in_c, 1)).astype(np.float32), np.zeros(1, dtype=np.float32)]
+    return params
+
+
+def normalise(thumbs):
+    return ((thumbs.astype(np.float32) - 128) / 128)[..., None]
+
+
+def forward(params, x):
+    """Logits plus everything the backward pass needs."""
+    cache = []
+    for i in range(len(CHANNELS)):
+        w, b = params[2 * i], params[2 * i + 1]
+        n, h, wd, _ = x.shape
+        cols = im2col(x)
+        out = np.maximum(cols @ w + b, 0).reshape(n, h // 2, wd // 2, -1)
+        cache.append((x.shape, cols, out))
+        x = out
+    pooled = x.mean(axis=(1, 2))
+    logits = (pooled @ params[-2] + params[-1])[:, 0]
+    return logits, (cache, pooled, x.shape)
+
+
+def backward(params, cache, dlogits):
+    layers, pooled, last_shape = cache
+    grads = [None] * len(params)
+    grads[-2] = pooled.T @ dlogits[:, None]
+    grads[-1] = dlogits.sum(keepdims=True)
+
+    n, h, w, c = last_shape
+    dx = np.broadcast_to((dlogits[:, None] @ params[-2].T)[:, None, None, :] / (h * w), last_shape)
+    for i in reversed(range(len(CHANNELS))):
+        in_shape, cols, out = layers[i]
+        dout = (dx * (out > 0)).reshape(-1, out.shape[-1])
+        grads[2 * i] = cols.T @ dout
+        grads[2 * i + 1] = dout.sum(axis=0)
+        if i > 0:
+            dx = col2im(dout @ params[2 * i].T, in_shape)
+    return grads
+
+
+def augment(thumbs, rng):
+    """Mirror, brightness & contrast changes of the porch across the day."""
+    out = thumbs.astype(np.float32)
+    flip = rng.random(len(out)) < 0.5
+    out[flip] = out[flip, :, ::-1]
+    gain = rng.uniform(0.7, 1.3, (len(out), 1, 1))
+    offset = rng.uniform(-30, 30, (len(out), 1, 1))
+    return np.clip((out - 128) * gain + 128 + offset, 0, 255)
+
+
+def train(thumbs, labels, epochs, seed):
+    rng = np.random.default_rng(seed)
+    params = init_params(rng)
+    m = [np.zeros_like(p) for p in params]
+    v = [np.zeros_like(p) for p in params]
+    step, lr, batch = 0, 3e-3, 32
+
+    for epoch in range(epochs):
+        order = rng.permutation(len(thumbs))
+        loss_sum = 0.0
+        for start in range(0, len(order), batch):
+            idx = order[start:start + batch]
+            logits, cache = forward(params, normalise(augment(thumbs[idx], rng)))
+            prob = 1 / (1 + np.exp(-logits))
+            y = labels[idx]
+            loss_sum += -np.sum(y * np.log(prob + 1e-7) + (1 - y) * np.log(1 - prob + 1e-7))
+
+            grads = backward(params, cache, (prob - y) / len(idx))
+            step += 1
+            for p, g, mi, vi in zip(params, grads, m, v):
+                mi[:] = 0.9 * mi + 0.1 * g
+                vi[:] = 0.999 * vi + 0.001 * g * g
+                p -= lr * (mi / (1 - 0.9 ** step)) / (np.sqrt(vi / (1 - 0.999 ** step)) + 1e-8)
+        print("epoch %2d  loss %.4f" % (epoch + 1, loss_sum / len(thumbs)))
+    return params
+
+
+# === int8 export & the firmware's integer arithmetic ===
+def quantize_multiplier(real):
+    """multiplier in [2^30, 2^31) & right shift so that real == multiplier / 2^31 / 2^shift."""
+    shift = 0
+    while real < 0.5 and shift < 31:
+        real *= 2
+        shift += 1
+    multiplier = int(round(real * (1 << 31)))
+    if multiplier == 1 << 31:
+        multiplier, shift = 1 << 30, shift - 1
+    return multiplier, shift
+
+
+def quantize(params, thumbs):
+    """Integer model: per layer (weights [out][9*in], bias, multiplier, shift), logit weights & bias, output scale."""
+    x = normalise(thumbs)
+    in_scale = 1 / 128
+    layers = []
+    for i in range(len(CHANNELS)):
+        w, b = params[2 * i], params[2 * i + 1]
+        n, h, wd, _ = x.shape
+        x = np.maximum(im2col(x) @ w + b, 0).reshape(n, h // 2, wd // 2, -1)
+
+        w_scale = np.maximum(np.abs(w).max(axis=0), 1e-8) / 127
+        out_scale = max(np.percentile(x, 99.9), 1e-3) / 255
+        out_scale = max(out_scale, float((in_scale * w_scale).max()) * 1.0001)
+
+        wq = np.clip(np.round(w / w_scale), -127, 127).astype(np.int8)
+        bias = np.round(b / (in_scale * w_scale)).astype(np.int64)
+        if i == 0:
+            bias -= 128 * wq.astype(np.int64).sum(axis=0)
+        mults, shifts = zip(*(quantize_multiplier(s) for s in in_scale * w_scale / out_scale))
+        layers.append((wq.T.copy(), bias.astype(np.int32), np.array(mults, dtype=np.int32), np.array(shifts, dtype=np.int8)))
+        in_scale = out_scale
+
+    positions = (INPUT_H >> len(CHANNELS)) * (INPUT_W >> len(CHANNELS))
+    fc_w, fc_b = params[-2][:, 0], params[-1][0]
+    fc_scale = max(np.abs(fc_w).max(), 1e-8) / 127
+    output_scale = in_scale * fc_scale / positions
+    logit_w = np.clip(np.round(fc_w / fc_scale), -127, 127).astype(np.int8)
+    logit_b = int(round(fc_b / output_scale))
+    return layers, logit_w, logit_b, np.float32(output_scale)
+
+
+def quantized_scores(model, thumbs):
+    """Scores 0-100, bit-exact with personScore() in the firmware."""
+    layers, logit_w, logit_b, output_scale = model
+    x = thumbs.astype(np.int64)[..., None]
+    for i, (wq, bias, mults, shifts) in enumerate(layers):
+        n, h, w, _ = x.shape
+        # the border is the zero point: 128 for pixels, 0 for activations
+        acc = im2col(x, 128 if i == 0 else 0) @ wq.T.astype(np.int64) + bias
+        shifts = shifts.astype(np.int64)
+        scaled = (acc * mults.astype(np.int64) + (np.int64(1) << (30 + shifts))) >> (31 + shifts)
+        x = np.clip(scaled, 0, 255).reshape(n, h // 2, w // 2, -1)
+
+    logits = x.sum(axis=(1, 2)) @ logit_w.astype(np.int64) + logit_b
+    prob = np.float32(1) / (np.float32(1) + np.exp(-logits.astype(np.float32) * output_scale))
+    return (prob * np.float32(100) + np.float32(0.5)).astype(np.int32)
+
+
+def write_model(path, model):
+    layers, logit_w, logit_b, output_scale = model
+    with open(path, "wb") as out:
+        out.write(b"GBPM" + bytes([VERSION, INPUT_W, INPUT_H, len(CHANNELS)] + CHANNELS + [0]))
+        out.write(struct.pack("<f", output_scale))
+        for wq, bias, mults, shifts in layers:
+            out.write(wq.astype("<i1").tobytes())
+            out.write(bias.astype("<i4").tobytes())
+            out.write(mults.astype("<i4").tobytes())
+            out.write(shifts.astype("<i1").tobytes())
+        out.write(logit_w.astype("<i1").tobytes())
+        out.write(struct.pack("<i", logit_b))
+
+
+def read_model(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"GBPM" or data[4] != VERSION or list(data[5:11]) != [INPUT_W, INPUT_H, len(CHANNELS)] + CHANNELS:
+        sys.exit("%s is not a version %d person model" % (path, VERSION))
+    output_scale, = struct.unpack_from("<f", data, 12)
+    pos, layers, in_c = 16, [], 1
+
+    def take(dtype, count):
+        nonlocal pos
+        arr = np.frombuffer(data, dtype=dtype, count=count, offset=pos)
+        pos += arr.nbytes
+        return arr
+
+    for out_c in CHANNELS:
+        wq = take("<i1", 9 * in_c * out_c).reshape(out_c, 9 * in_c)
+        layers.append((wq, take("<i4", out_c), take("<i4", out_c), take("<i1", out_c)))
+        in_c = out_c
+    logit_w = take("<i1", in_c)
+    logit_b = int(take("<i4", 1)[0])
+    return layers, logit_w, logit_b, np.float32(output_scale)
+
+
+def report(name, scores, labels, threshold):
+    predicted = scores >= threshold
+    truth = labels > 0.5
+    tp, fp = np.sum(predicted & truth), np.sum(predicted & ~truth)
+    tn, fn = np.sum(~predicted & ~truth), np.sum(~predicted & truth)
+    print("%-10s accuracy %.1f%%  precision %.1f%%  recall %.1f%%  empty frames gated %.1f%%" % (
+        name, 100 * (tp + tn) / len(labels), 100 * tp / max(tp + fp, 1),
+        100 * tp / max(tp + fn, 1), 100 * tn / max(tn + fp, 1)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    train_parser = sub.add_parser("train", help="train on <dataset>/{person,empty} & export the int8 model")
+    train_parser.add_argument("dataset")
+    train_parser.add_argument("-o", "--output", default="person_model.bin")
+    train_parser.add_argument("--epochs", type=int, default=40)
+    train_parser.add_argument("--seed", type=int, default=1)
+    train_parser.add_argument("--threshold", type=int, default=60, help="personThreshold the report is made at")
+
+    score_parser = sub.add_parser("score", help="score captures with an exported model")
+    score_parser.add_argument("model")
+    score_parser.add_argument("images", nargs="+")
+
+    args = parser.parse_args()
+
+    if args.command == "score":
+        model = read_model(args.model)
+        thumbs = np.stack([thumbnail(path) for path in args.images])
+        for path, score in zip(args.images, quantized_scores(model, thumbs)):
+            print("%3d  %s" % (score, path))
+        return 0
+
+    thumbs, labels = load_dataset(args.dataset)
+    order = np.random.default_rng(args.seed).permutation(len(thumbs))
+    held_out = order[:max(1, len(order) // 5)]
+    train_idx = order[len(held_out):]
+    print("%d captures, %d person, %d held out" % (len(thumbs), int(labels.sum()), len(held_out)))
+
+    params = train(thumbs[train_idx], labels[train_idx], args.epochs, args.seed)
+    model = quantize(params, thumbs[train_idx])
+    write_model(args.output, model)
+
+    float_scores = 100 / (1 + np.exp(-forward(params, normalise(thumbs[held_out]))[0]))
+    report("float", float_scores, labels[held_out], args.threshold)
+    report("int8", quantized_scores(model, thumbs[held_out]), labels[held_out], args.threshold)
+    print("wrote %s (%d bytes)" % (args.output, os.path.getsize(args.output)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
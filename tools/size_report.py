@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Compare flash & static RAM usage of the GuardianBell build profiles.
+
+Builds every profile with PlatformIO (skip with ``--no-build``) and reads the
+section sizes straight from each ``firmware.elf``, so no toolchain ``size``
+binary is needed::
+
+    size_report.py                                  # esp32cam, _standard & _minimal
+    size_report.py --envs esp32cam_minimal --no-build
+    size_report.py --json sizes.json --label $(git rev-parse --short HEAD)
+
+Flash is the code & read-only data mapped from flash plus initialised data
+copied at boot; DRAM & IRAM are what the image reserves before the heap starts.
+Boot time & free heap of a running unit are published on ``doorbell/build``.
+"""
+
+import argparse
+import json
+import os
+import struct
+import subprocess
+import sys
+
+FIRMWARE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "firmware")
+PROFILES = ["esp32cam", "esp32cam_standard", "esp32cam_minimal"]
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+
+def elf_sections(path):
+    """(name, type, flags, size) of every section of a 32-bit little-endian ELF."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1:
+        raise ValueError("%s is not a 32-bit ELF" % path)
+
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+
+    headers = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize) for i in range(shnum)]
+    strtab = headers[shstrndx][4]
+
+    def name(offset):
+        end = data.index(b"\0", strtab + offset)
+        return data[strtab + offset:end].decode()
+
+    return [(name(h[0]), h[1], h[2], h[5]) for h in headers]
+
+
+def classify(sections):
+    sizes = {"flash_code": 0, "flash_rodata": 0, "iram": 0, "dram_data": 0, "dram_bss": 0}
+    for name, kind, flags, size in sections:
+        if not flags & SHF_ALLOC:
+            continue
+        if name.startswith(".flash.text"):
+            sizes["flash_code"] += size
+        elif name.startswith(".flash."):
+            sizes["flash_rodata"] += size
+        elif name.startswith(".iram0"):
+            sizes["iram"] += size
+        elif name.startswith(".dram0"):
+            sizes["dram_bss" if kind == SHT_NOBITS else "dram_data"] += size
+
+    sizes["flash_total"] = sizes["flash_code"] + sizes["flash_rodata"] + sizes["iram"] + sizes["dram_data"]
+    sizes["dram_total"] = sizes["dram_data"] + sizes["dram_bss"]
+    return sizes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--envs", nargs="+", default=PROFILES, help="PlatformIO environments to compare")
+    parser.add_argument("--no-build", action="store_true", help="use existing .pio/build output")
+    parser.add_argument("--json", help="append one JSON line per environment")
+    parser.add_argument("--label", default="", help="e.g. the commit the sizes belong to")
+    args = parser.parse_args()
+
+    rows = []
+    for env in args.envs:
+        if not args.no_build:
+            subprocess.run(["pio", "run", "-e", env], cwd=FIRMWARE_DIR, check=True,
+                           stdout=subprocess.DEVNULL)
+        elf = os.path.join(FIRMWARE_DIR, ".pio", "build", env, "firmware.elf")
+        if not os.path.exists(elf):
+            print("%s: no firmware.elf, build it first" % env, file=sys.stderr)
+            continue
+        rows.append((env, classify(elf_sections(elf))))
+
+    if not rows:
+        return 1
+
+    base = rows[0][1]
+    print("%-20s %10s %10s %10s %10s %10s %12s" % (
+        "profile", "flash", "code", "rodata", "iram", "dram", "vs " + rows[0][0]))
+    for env, sizes in rows:
+        print("%-20s %10d %10d %10d %10d %10d %+12d" % (
+            env, sizes["flash_total"], sizes["flash_code"], sizes["flash_rodata"],
+            sizes["iram"], sizes["dram_total"], sizes["flash_total"] - base["flash_total"]))
+
+    if args.json:
+        with open(args.json, "a") as out:
+            for env, sizes in rows:
+                out.write(json.dumps(dict(label=args.label, env=env, **sizes)) + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Reassemble chunked GuardianBell snapshots published on the local MQTT broker.
+
+The firmware publishes each JPEG on ``doorbell/snapshot/<kind>`` as numbered
+chunks, each prefixed with an 8 byte little-endian header::
+
+    u32 snapshot id | u16 chunk index | u16 chunk count | JPEG bytes...
+
+``listen`` reassembles snapshots, writes them to disk and republishes each
+complete JPEG (retained) on ``doorbell/snapshot/<kind>/image`` so a Home
+Assistant MQTT camera entity can display it.
+
+``selftest`` chunks a JPEG exactly like the firmware, publishes it to the
+broker and checks the reassembled bytes match the original.
+
+Requires paho-mqtt (``pip install paho-mqtt``).
+"""
+
+import argparse
+import os
+import struct
+import sys
+import threading
+import time
+
+import paho.mqtt.client as mqtt
+
+HEADER = struct.Struct("<IHH")
+TOPIC_PREFIX = "doorbell/snapshot/"
+
+# matches MQTT_BUFFER_SIZE in firmware/include/mqtt.h
+MQTT_BUFFER_SIZE = 4096
+
+
+class Reassembler:
+    """Collects chunks per (kind, snapshot id) and yields complete JPEGs."""
+
+    def __init__(self, stale_after=10.0):
+        self.pending = {}
+        self.stale_after = stale_after
+
+    def feed(self, kind, payload):
+        if len(payload) < HEADER.size:
+            return None
+        snap_id, index, count = HEADER.unpack_from(payload)
+        if count == 0 or index >= count:
+            return None
+
+        key = (kind, snap_id)
+        entry = self.pending.setdefault(key, {"chunks": {}, "count": count, "t": time.time()})
+        entry["chunks"][index] = payload[HEADER.size:]
+        self._expire()
+
+        if len(entry["chunks"]) < entry["count"]:
+            return None
+
+        del self.pending[key]
+        return snap_id, b"".join(entry["chunks"][i] for i in range(entry["count"]))
+
+    def _expire(self):
+        now = time.time()
+        for key in [k for k, v in self.pending.items() if now - v["t"] > self.stale_after]:
+            del self.pending[key]
+
+
+def chunk(jpeg, snap_id, topic):
+    """Split a JPEG the same way publishSnapshotToMQTT() does."""
+    size = MQTT_BUFFER_SIZE - 5 - 2 - len(topic) - HEADER.size
+    count = (len(jpeg) + size - 1) // size
+    for index in range(count):
+        data = jpeg[index * size:(index + 1) * size]
+        yield HEADER.pack(snap_id, index, count) + data
+
+
+def make_client(args):
+    client = mqtt.Client()
+    if args.user:
+        client.username_pw_set(args.user, args.password)
+    client.connect(args.host, args.port)
+    return client
+
+
+def listen(args):
+    reassembler = Reassembler()
+    os.makedirs(args.out, exist_ok=True)
+
+    def on_message(client, userdata, msg):
+        kind = msg.topic[len(TOPIC_PREFIX):]
+        if "/" in kind:
+            return
+        done = reassembler.feed(kind, msg.payload)
+        if done is None:
+            return
+        snap_id, jpeg = done
+        path = os.path.join(args.out, "%s_%08d.jpg" % (kind, snap_id))
+        with open(path, "wb") as f:
+            f.write(jpeg)
+        client.publish(TOPIC_PREFIX + kind + "/image", jpeg, retain=True)
+        print("%s: %d bytes -> %s" % (kind, len(jpeg), path))
+
+    client = make_client(args)
+    client.on_message = on_message
+    client.subscribe(TOPIC_PREFIX + "+")
+    client.loop_forever()
+
+
+def selftest(args):
+    with open(args.jpeg, "rb") as f:
+        original = f.read()
+
+    topic = TOPIC_PREFIX + "selftest"
+    reassembler = Reassembler()
+    received = threading.Event()
+    result = {}
+
+    def on_message(client, userdata, msg):
+        done = reassembler.feed("selftest", msg.payload)
+        if done is not None:
+            result["jpeg"] = done[1]
+            received.set()
+
+    client = make_client(args)
+    client.on_message = on_message
+    client.subscribe(topic)
+    client.loop_start()
+    time.sleep(0.5)
+
+    start = time.time()
+    chunks = list(chunk(original, 1, topic))
+    for payload in chunks:
+        client.publish(topic, payload)
+
+    ok = received.wait(args.timeout) and result["jpeg"] == original
+    client.loop_stop()
+
+    print("%d bytes in %d chunks, %.1f ms: %s"
+          % (len(original), len(chunks), (time.time() - start) * 1000, "OK" if ok else "MISMATCH"))
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--user")
+    parser.add_argument("--password")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("listen", help="reassemble snapshots from the firmware")
+    p.add_argument("--out", default="snapshots")
+
+    p = sub.add_parser("selftest", help="round-trip a JPEG through the broker")
+    p.add_argument("jpeg")
+    p.add_argument("--timeout", type=float, default=5.0)
+
+    args = parser.parse_args()
+    if args.cmd == "listen":
+        listen(args)
+        return 0
+    return selftest(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Decode GuardianBell trace buffers into per-phase latency histograms.
+
+The firmware flushes its RTC-memory trace ring on ``doorbell/trace`` before
+deep sleep. Each message is::
+
+    "GBTR" | u8 version | u8 record size | u16 count | records...
+
+and each record (little-endian, 12 bytes) is::
+
+    u8 phase | u8 wake | u16 reserved | u32 begin us | u32 end us
+
+Decode saved payloads with ``trace_decode.py file1.bin file2.bin`` or collect
+live from the broker with ``trace_decode.py --host <broker> --count N``
+(requires paho-mqtt).
+"""
+
+import argparse
+import struct
+import sys
+from collections import defaultdict
+
+# must mirror TracePhase in firmware/include/trace.h
+PHASES = [
+    "boot",
+    "init_mcp",
+    "init_camera",
+    "init_sd",
+    "init_wifi",
+    "camera_fb_get",
+    "sd_open",
+    "sd_write",
+    "sd_close",
+    "tls_connect",
+    "upload",
+    "telegram_send",
+    "sharpness",
+    "flash_open",
+    "flash_write",
+    "flash_close",
+    "person",
+    "camera_switch",
+    "ingest_open",
+]
+
+HEADER = struct.Struct("<4sBBH")
+RECORD = struct.Struct("<BBHII")
+
+
+def decode(payload):
+    """Yield (phase, wake, duration_us) for each record in one flush."""
+    magic, version, size, count = HEADER.unpack_from(payload)
+    if magic != b"GBTR" or version != 1 or size != RECORD.size:
+        raise ValueError("not a version 1 trace buffer")
+    for i in range(count):
+        phase, wake, _, begin, end = RECORD.unpack_from(payload, HEADER.size + i * size)
+        yield phase, wake, (end - begin) & 0xFFFFFFFF
+
+
+def percentile(values, p):
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def report(durations):
+    for phase in sorted(durations):
+        values = sorted(durations[phase])
+        name = PHASES[phase] if phase < len(PHASES) else "phase_%d" % phase
+        print("%s  n=%d  min=%.2f  p50=%.2f  p90=%.2f  p99=%.2f  max=%.2f ms" % (
+            name, len(values), values[0] / 1000, percentile(values, 50) / 1000,
+            percentile(values, 90) / 1000, percentile(values, 99) / 1000, values[-1] / 1000))
+
+        # --- power-of-two microsecond buckets ---
+        buckets = defaultdict(int)
+        for v in values:
+            buckets[max(v, 1).bit_length() - 1] += 1
+        peak = max(buckets.values())
+        for b in range(min(buckets), max(buckets) + 1):
+            bar = "#" * (buckets[b] * 40 // peak)
+            print("  %10d us | %-40s %d" % (1 << b, bar, buckets[b]))
+        print()
+
+
+def collect_live(args):
+    import paho.mqtt.client as mqtt
+
+    payloads = []
+    client = mqtt.Client()
+    if args.user:
+        client.username_pw_set(args.user, args.password)
+
+    def on_message(c, userdata, msg):
+        payloads.append(msg.payload)
+        print("received %d bytes" % len(msg.payload), file=sys.stderr)
+        if len(payloads) >= args.count:
+            c.disconnect()
+
+    client.on_message = on_message
+    client.connect(args.host, args.port)
+    client.subscribe("doorbell/trace")
+    client.loop_forever()
+    return payloads
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("files", nargs="*", help="raw doorbell/trace payloads")
+    parser.add_argument("--host")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--user")
+    parser.add_argument("--password")
+    parser.add_argument("--count", type=int, default=1, help="flushes to collect live")
+    args = parser.parse_args()
+
+    payloads = [open(f, "rb").read() for f in args.files]
+    if args.host:
+        payloads += collect_live(args)
+    if not payloads:
+        parser.error("no trace payloads given")
+
+    durations = defaultdict(list)
+    for payload in payloads:
+        for phase, _, duration in decode(payload):
+            durations[phase].append(duration)
+    report(durations)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())